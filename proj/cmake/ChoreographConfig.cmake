@@ -2,8 +2,14 @@ if(NOT TARGET Choreograph)
     # Define ${Choreograph_PROJECT_ROOT}. ${CMAKE_CURRENT_LIST_DIR} is just the current directory.
     get_filename_component(Choreograph_PROJECT_ROOT "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
 
-    # Define ${CINDER_PATH} as usual.
-    get_filename_component(CINDER_PATH "C:/Users/tomok/Downloads/cinder_0.9.2_vc2015/cinder_0.9.2_vc2015/blocks/Choreograph/../.." ABSOLUTE)
+    # Define ${CINDER_PATH} as usual: from the caller, the environment, or the Cinder that contains blocks/Choreograph.
+    if(NOT CINDER_PATH)
+        if(DEFINED ENV{CINDER_PATH})
+            set(CINDER_PATH "$ENV{CINDER_PATH}")
+        else()
+            get_filename_component(CINDER_PATH "${Choreograph_PROJECT_ROOT}/../.." ABSOLUTE)
+        endif()
+    endif()
 
     # Make a list of source files and define that to be ${SOURCE_LIST}.
     file(GLOB SOURCE_LIST CONFIGURE_DEPENDS
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BatchEvaluation.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+template<typename Functor>
+bool holdsEase( const function<float (float)> &fn, float (*ease)( float ) )
+{
+  auto pointer = fn.target<float (*)( float )>();
+  return (pointer && *pointer == ease) || fn.target<Functor>() != nullptr;
+}
+
+/// Eases \a count times, then interpolates each of N components for all of them:
+/// out[c][i] = a[c][i] + (b[c][i] - a[c][i]) * t[i], the same arithmetic as InterpolationTraits<T>::lerp,
+/// so batched results match unbatched evaluation exactly.
+template<size_t N, typename Ease>
+void easeAndLerp( const float *t, const float * const *a, const float * const *b, float (*out)[4], size_t count )
+{
+  const Ease ease = Ease();
+  float eased[4];
+  for( size_t i = 0; i < count; ++i ) {
+    eased[i] = ease( t[i] );
+  }
+
+#if defined( CHOREOGRAPH_USE_SSE )
+  if( count == 4 )
+  {
+    const __m128 vt = _mm_loadu_ps( eased );
+    for( size_t c = 0; c < N; ++c )
+    {
+      const __m128 va = _mm_loadu_ps( a[c] );
+      const __m128 vb = _mm_loadu_ps( b[c] );
+      _mm_storeu_ps( out[c], _mm_add_ps( va, _mm_mul_ps( _mm_sub_ps( vb, va ), vt ) ) );
+    }
+    return;
+  }
+#endif
+  for( size_t c = 0; c < N; ++c ) {
+    for( size_t i = 0; i < count; ++i ) {
+      out[c][i] = a[c][i] + (b[c][i] - a[c][i]) * eased[i];
+    }
+  }
+}
+
+} // namespace
+
+EaseKind choreograph::easeKindOf( const function<float (float)> &fn )
+{
+  if( ! fn ) return EaseKind::Custom;
+  if( holdsEase<EaseNone>( fn, &easeNone ) ) return EaseKind::None;
+  if( holdsEase<EaseInQuad>( fn, &easeInQuad ) ) return EaseKind::InQuad;
+  if( holdsEase<EaseOutQuad>( fn, &easeOutQuad ) ) return EaseKind::OutQuad;
+  if( holdsEase<EaseInOutQuad>( fn, &easeInOutQuad ) ) return EaseKind::InOutQuad;
+  if( holdsEase<EaseInCubic>( fn, &easeInCubic ) ) return EaseKind::InCubic;
+  if( holdsEase<EaseOutCubic>( fn, &easeOutCubic ) ) return EaseKind::OutCubic;
+  if( holdsEase<EaseInOutCubic>( fn, &easeInOutCubic ) ) return EaseKind::InOutCubic;
+  if( holdsEase<EaseInQuart>( fn, &easeInQuart ) ) return EaseKind::InQuart;
+  if( holdsEase<EaseOutQuart>( fn, &easeOutQuart ) ) return EaseKind::OutQuart;
+  if( holdsEase<EaseInOutQuart>( fn, &easeInOutQuart ) ) return EaseKind::InOutQuart;
+  if( holdsEase<EaseInQuint>( fn, &easeInQuint ) ) return EaseKind::InQuint;
+  if( holdsEase<EaseOutQuint>( fn, &easeOutQuint ) ) return EaseKind::OutQuint;
+  if( holdsEase<EaseInOutQuint>( fn, &easeInOutQuint ) ) return EaseKind::InOutQuint;
+  if( holdsEase<EaseInSine>( fn, &easeInSine ) ) return EaseKind::InSine;
+  if( holdsEase<EaseOutSine>( fn, &easeOutSine ) ) return EaseKind::OutSine;
+  if( holdsEase<EaseInOutSine>( fn, &easeInOutSine ) ) return EaseKind::InOutSine;
+  return EaseKind::Custom;
+}
+
+detail::BatchEvaluator::~BatchEvaluator()
+{
+  for( auto &by_ease : _buckets ) {
+    for( auto &bucket : by_ease ) {
+      for( auto *owner : bucket.owners ) {
+        owner->_evaluator = nullptr;
+      }
+    }
+  }
+}
+
+void detail::BatchEvaluator::release( BatchSlot &slot )
+{
+  assert( slot._evaluator == this );
+  removeAt( _buckets[slot._floats - 1][slot._ease], slot._floats, slot._index );
+  slot._evaluator = nullptr;
+}
+
+void detail::BatchEvaluator::removeAt( Bucket &bucket, size_t floats, size_t index )
+{
+  // Swap-remove, moving the last slot into the gap.
+  const size_t last = bucket.t.size() - 1;
+  if( index != last )
+  {
+    bucket.t[index] = bucket.t[last];
+    for( size_t c = 0; c < floats; ++c ) {
+      bucket.a[c][index] = bucket.a[c][last];
+      bucket.b[c][index] = bucket.b[c][last];
+    }
+    bucket.targets[index] = bucket.targets[last];
+    bucket.owners[index] = bucket.owners[last];
+    bucket.stamps[index] = bucket.stamps[last];
+    bucket.owners[index]->_index = (uint32_t)index;
+  }
+
+  bucket.t.pop_back();
+  for( size_t c = 0; c < floats; ++c ) {
+    bucket.a[c].pop_back();
+    bucket.b[c].pop_back();
+  }
+  bucket.targets.pop_back();
+  bucket.owners.pop_back();
+  bucket.stamps.pop_back();
+}
+
+void detail::BatchEvaluator::prune( Bucket &bucket, size_t floats )
+{
+  for( size_t i = bucket.t.size(); i > 0; --i )
+  {
+    if( bucket.stamps[i - 1] != _update )
+    {
+      bucket.owners[i - 1]->_evaluator = nullptr;
+      removeAt( bucket, floats, i - 1 );
+    }
+  }
+}
+
+template<size_t N, typename Ease>
+void detail::BatchEvaluator::evaluate( Bucket &bucket )
+{
+  // Release slots whose Motions weren't updated through the batch this time.
+  if( bucket.touched != bucket.t.size() ) {
+    prune( bucket, N );
+  }
+  bucket.touched = 0;
+
+  // Four Motions at a time: ease their times, interpolate each component, then write the targets.
+  const size_t count = bucket.t.size();
+  float out[N][4];
+  for( size_t i = 0; i < count; i += 4 )
+  {
+    const size_t n = std::min<size_t>( 4, count - i );
+    const float *a[N], *b[N];
+    for( size_t c = 0; c < N; ++c ) {
+      a[c] = bucket.a[c].data() + i;
+      b[c] = bucket.b[c].data() + i;
+    }
+    easeAndLerp<N, Ease>( bucket.t.data() + i, a, b, out, n );
+
+    for( size_t j = 0; j < n; ++j )
+    {
+      float value[N];
+      for( size_t c = 0; c < N; ++c ) {
+        value[c] = out[c][j];
+      }
+      memcpy( bucket.targets[i + j], value, sizeof( value ) );
+    }
+  }
+  if( count > 0 ) {
+    _stats.buckets += 1;
+  }
+}
+
+template<size_t N>
+void detail::BatchEvaluator::evaluate( Bucket &bucket, EaseKind ease )
+{
+  switch( ease )
+  {
+    case EaseKind::None: evaluate<N, EaseNone>( bucket ); break;
+    case EaseKind::InQuad: evaluate<N, EaseInQuad>( bucket ); break;
+    case EaseKind::OutQuad: evaluate<N, EaseOutQuad>( bucket ); break;
+    case EaseKind::InOutQuad: evaluate<N, EaseInOutQuad>( bucket ); break;
+    case EaseKind::InCubic: evaluate<N, EaseInCubic>( bucket ); break;
+    case EaseKind::OutCubic: evaluate<N, EaseOutCubic>( bucket ); break;
+    case EaseKind::InOutCubic: evaluate<N, EaseInOutCubic>( bucket ); break;
+    case EaseKind::InQuart: evaluate<N, EaseInQuart>( bucket ); break;
+    case EaseKind::OutQuart: evaluate<N, EaseOutQuart>( bucket ); break;
+    case EaseKind::InOutQuart: evaluate<N, EaseInOutQuart>( bucket ); break;
+    case EaseKind::InQuint: evaluate<N, EaseInQuint>( bucket ); break;
+    case EaseKind::OutQuint: evaluate<N, EaseOutQuint>( bucket ); break;
+    case EaseKind::InOutQuint: evaluate<N, EaseInOutQuint>( bucket ); break;
+    case EaseKind::InSine: evaluate<N, EaseInSine>( bucket ); break;
+    case EaseKind::OutSine: evaluate<N, EaseOutSine>( bucket ); break;
+    case EaseKind::InOutSine: evaluate<N, EaseInOutSine>( bucket ); break;
+    case EaseKind::Custom:
+    case EaseKind::Count:
+      assert( false && "Custom eases can't be batched." );
+    break;
+  }
+}
+
+void detail::BatchEvaluator::evaluate()
+{
+  for( size_t f = 0; f < MaxFloats; ++f )
+  {
+    for( size_t e = 0; e < (size_t)EaseKind::Count; ++e )
+    {
+      auto &bucket = _buckets[f][e];
+      if( bucket.t.empty() ) {
+        continue;
+      }
+      switch( f + 1 )
+      {
+        case 1: evaluate<1>( bucket, (EaseKind)e ); break;
+        case 2: evaluate<2>( bucket, (EaseKind)e ); break;
+        case 3: evaluate<3>( bucket, (EaseKind)e ); break;
+        case 4: evaluate<4>( bucket, (EaseKind)e ); break;
+      }
+    }
+  }
+  _update += 1;
+  _last_stats = _stats;
+  _stats = BatchStats();
+}
+
+size_t detail::BatchEvaluator::getStorageSize() const
+{
+  size_t bytes = 0;
+  for( const auto &by_ease : _buckets )
+  {
+    for( const auto &bucket : by_ease )
+    {
+      bytes += bucket.t.capacity() * sizeof( float );
+      for( size_t c = 0; c < MaxFloats; ++c ) {
+        bytes += (bucket.a[c].capacity() + bucket.b[c].capacity()) * sizeof( float );
+      }
+      bytes += bucket.targets.capacity() * sizeof( void* ) + bucket.owners.capacity() * sizeof( BatchSlot* ) + bucket.stamps.capacity() * sizeof( uint32_t );
+    }
+  }
+  return bytes;
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Easing.h"
+#include "Interpolation.hpp"
+#include "TimeType.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+///
+/// \file
+/// Batched evaluation of plain ramps across many Motions.
+/// Timelines with batch evaluation enabled keep Motions whose current Phrase is a ramp with a
+/// known ease in buckets by float count and ease, then ease and interpolate each bucket in one pass.
+///
+
+namespace choreograph
+{
+
+/// Eases Timelines can evaluate in batches. Any other ease function is Custom and evaluated per Motion.
+enum class EaseKind : uint8_t
+{
+  Custom,
+  None,
+  InQuad, OutQuad, InOutQuad,
+  InCubic, OutCubic, InOutCubic,
+  InQuart, OutQuart, InOutQuart,
+  InQuint, OutQuint, InOutQuint,
+  InSine, OutSine, InOutSine,
+  Count
+};
+
+/// Identifies the ease wrapped in \a fn, whether it holds an Easing.h function or functor.
+EaseKind easeKindOf( const std::function<float (float)> &fn );
+
+/// Counts from the last batched Timeline update.
+struct BatchStats
+{
+  /// Motions evaluated in batches.
+  size_t  batched = 0;
+  /// Items updated individually.
+  size_t  fallback = 0;
+  /// Non-empty buckets, i.e. distinct (float count, ease) pairs.
+  size_t  buckets = 0;
+};
+
+namespace detail
+{
+
+/// Returns a process-wide unique revision number. Sequences take a new one whenever their Phrases change.
+inline uint64_t nextRevision()
+{
+  static std::atomic<uint64_t> counter( 1 );
+  return counter.fetch_add( 1, std::memory_order_relaxed );
+}
+
+/// Counter bumped when a batchable Phrase's values change, so batch slots copied from it are refreshed.
+inline std::atomic<uint64_t>& batchEpoch()
+{
+  static std::atomic<uint64_t> epoch( 0 );
+  return epoch;
+}
+
+inline void invalidateBatches() { batchEpoch().fetch_add( 1, std::memory_order_relaxed ); }
+
+/// A Phrase's description of itself as a ramp from *start to *end with a known ease.
+template<typename T>
+struct RampShape
+{
+  const T   *start = nullptr;
+  const T   *end = nullptr;
+  EaseKind  ease = EaseKind::Custom;
+};
+
+class BatchEvaluator;
+
+///
+/// A Motion's place in a BatchEvaluator, along with the span of its Sequence the place is good for.
+/// Releases its place on destruction.
+///
+class BatchSlot
+{
+public:
+  BatchSlot() = default;
+  ~BatchSlot() { release(); }
+
+  BatchSlot( const BatchSlot &rhs ) = delete;
+  BatchSlot& operator= ( const BatchSlot &rhs ) = delete;
+
+  /// Returns true if this slot in \a evaluator still describes Sequence \a revision at \a time.
+  bool covers( const BatchEvaluator *evaluator, uint64_t revision, Time time ) const
+  {
+    return _evaluator == evaluator && _revision == revision && _epoch == batchEpoch().load( std::memory_order_relaxed )
+      && (_first ? time >= _begin : time > _begin) && time <= _end;
+  }
+
+  /// Returns the normalized time within the slot's Phrase at Sequence \a time.
+  float normalize( Time time ) const { return _duration > 0 ? (float)((time - _begin) / _duration) : 0.0f; }
+
+  /// Gives up this slot's place, if it has one.
+  void release();
+
+private:
+  friend class BatchEvaluator;
+
+  BatchEvaluator  *_evaluator = nullptr;
+  uint32_t        _index = 0;
+  uint8_t         _floats = 0;
+  uint8_t         _ease = 0;
+  bool            _first = false;
+  uint64_t        _revision = 0;
+  uint64_t        _epoch = 0;
+  Time            _begin = 0;
+  Time            _end = 0;
+  Time            _duration = 0;
+};
+
+///
+/// Holds ramps from many Motions in structure-of-arrays buckets by float count and ease, and evaluates
+/// each bucket in one pass: ease all times, interpolate each component four Motions at a time, then
+/// write the results to their targets.
+///
+/// Motions claim a slot when they enter a ramp, copying its endpoints, and afterwards only write
+/// their normalized time each update. Slots not touched during an update are released by evaluate(),
+/// so cancelled and removed Motions drop out. Buckets keep their storage, so steady state doesn't allocate.
+///
+class BatchEvaluator
+{
+public:
+  BatchEvaluator() = default;
+  ~BatchEvaluator();
+
+  BatchEvaluator( const BatchEvaluator &rhs ) = delete;
+  BatchEvaluator& operator= ( const BatchEvaluator &rhs ) = delete;
+
+  /// Claims \a slot for the ramp from \a a to \a b, written to \a target at normalized time \a t this update.
+  /// The slot covers Sequence \a revision from \a begin (exclusive unless \a first) for \a duration.
+  /// Returns false, claiming nothing, if T or \a ease can't be batched.
+  template<typename T>
+  bool claim( BatchSlot &slot, EaseKind ease, const T &a, const T &b, T *target, float t, Time begin, Time duration, bool first, uint64_t revision )
+  {
+    return claim( slot, ease, a, b, target, t, begin, duration, first, revision, std::integral_constant<size_t, BatchFloats<T>::value>() );
+  }
+
+  /// Sets \a slot's normalized time for this update.
+  void touch( const BatchSlot &slot, float t )
+  {
+    auto &bucket = _buckets[slot._floats - 1][slot._ease];
+    bucket.t[slot._index] = t;
+    bucket.stamps[slot._index] = _update;
+    bucket.touched += 1;
+    _stats.batched += 1;
+  }
+
+  /// Releases \a slot, which must belong to this evaluator.
+  void release( BatchSlot &slot );
+
+  /// Records an item updated outside the batch.
+  void addFallback() { _stats.fallback += 1; }
+
+  /// Evaluates every slot touched since the last call and releases the rest.
+  void evaluate();
+
+  /// Returns counts from the last evaluate().
+  const BatchStats& getStats() const { return _last_stats; }
+
+  /// Returns the bytes of storage held by the buckets.
+  size_t getStorageSize() const;
+
+private:
+  static const size_t MaxFloats = 4;
+
+  struct Bucket
+  {
+    std::vector<float>                          t;
+    std::array<std::vector<float>, MaxFloats>   a;
+    std::array<std::vector<float>, MaxFloats>   b;
+    std::vector<void*>                          targets;
+    std::vector<BatchSlot*>                     owners;
+    std::vector<uint32_t>                       stamps;
+    /// Slots touched this update. When every slot was, none need releasing.
+    size_t                                      touched = 0;
+  };
+
+  /// Buckets indexed by [float count - 1][ease].
+  std::array<std::array<Bucket, (size_t)EaseKind::Count>, MaxFloats> _buckets;
+  uint32_t    _update = 1;
+  BatchStats  _stats;
+  BatchStats  _last_stats;
+
+  template<typename T>
+  bool claim( BatchSlot &/*slot*/, EaseKind /*ease*/, const T &/*a*/, const T &/*b*/, T * /*target*/, float /*t*/, Time /*begin*/, Time /*duration*/, bool /*first*/, uint64_t /*revision*/, std::integral_constant<size_t, 0> ) { return false; }
+
+  template<typename T, size_t N>
+  bool claim( BatchSlot &slot, EaseKind ease, const T &a, const T &b, T *target, float t, Time begin, Time duration, bool first, uint64_t revision, std::integral_constant<size_t, N> )
+  {
+    if( ease == EaseKind::Custom ) {
+      return false;
+    }
+    slot.release();
+
+    float fa[N], fb[N];
+    std::memcpy( fa, &a, sizeof( T ) );
+    std::memcpy( fb, &b, sizeof( T ) );
+
+    auto &bucket = _buckets[N - 1][(size_t)ease];
+    slot._evaluator = this;
+    slot._index = (uint32_t)bucket.t.size();
+    slot._floats = (uint8_t)N;
+    slot._ease = (uint8_t)ease;
+    slot._first = first;
+    slot._revision = revision;
+    slot._epoch = batchEpoch().load( std::memory_order_relaxed );
+    slot._begin = begin;
+    slot._end = begin + duration;
+    slot._duration = duration;
+
+    bucket.t.push_back( t );
+    for( size_t c = 0; c < N; ++c ) {
+      bucket.a[c].push_back( fa[c] );
+      bucket.b[c].push_back( fb[c] );
+    }
+    bucket.targets.push_back( target );
+    bucket.owners.push_back( &slot );
+    bucket.stamps.push_back( _update );
+    bucket.touched += 1;
+    _stats.batched += 1;
+    return true;
+  }
+
+  void removeAt( Bucket &bucket, size_t floats, size_t index );
+  void prune( Bucket &bucket, size_t floats );
+  template<size_t N>
+  void evaluate( Bucket &bucket, EaseKind ease );
+  template<size_t N, typename Ease>
+  void evaluate( Bucket &bucket );
+};
+
+inline void BatchSlot::release()
+{
+  if( _evaluator ) {
+    _evaluator->release( *this );
+  }
+}
+
+} // namespace detail
+} // namespace choreograph
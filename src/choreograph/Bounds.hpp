@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimeType.h"
+#include "Interpolation.hpp"
+#include "BatchEvaluation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+///
+/// \file
+/// Bounds describe the range of values a Phrase or Sequence takes over a span of time.
+///
+
+namespace choreograph
+{
+
+namespace detail
+{
+
+template<typename T, bool HasComponents = (Components<T>::size > 0)>
+struct BoundsValue { using type = char; };
+template<typename T>
+struct BoundsValue<T, true> { using type = typename Components<T>::ValueT; };
+
+} // namespace detail
+
+///
+/// Componentwise range of values: empty, a box from getMin() to getMax(), or unbounded.
+/// Unbounded means nothing is known, e.g. for procedural Phrases, custom lerp functions
+/// or types without components; treat it as "could be anything".
+///
+template<typename T>
+class Bounds
+{
+public:
+  using Components = detail::Components<T>;
+  static const bool has_components = (Components::size > 0);
+
+  /// Constructs empty bounds.
+  Bounds() = default;
+
+  /// Constructs bounds containing only \a value.
+  explicit Bounds( const T &value ):
+    _min( value ),
+    _max( value ),
+    _state( has_components ? State::Finite : State::Unbounded )
+  {}
+
+  /// Constructs the smallest bounds containing \a a and \a b.
+  Bounds( const T &a, const T &b ):
+    Bounds( a )
+  {
+    include( b );
+  }
+
+  /// Returns bounds that contain everything.
+  static Bounds unbounded() { Bounds b; b._state = State::Unbounded; return b; }
+
+  bool isEmpty() const { return _state == State::Empty; }
+  bool isBounded() const { return _state == State::Finite; }
+  bool isUnbounded() const { return _state == State::Unbounded; }
+
+  /// Returns the componentwise minimum. Only meaningful if isBounded().
+  const T& getMin() const { return _min; }
+  /// Returns the componentwise maximum. Only meaningful if isBounded().
+  const T& getMax() const { return _max; }
+
+  /// Grows to contain \a value.
+  void include( const T &value ) { include( Bounds( value ) ); }
+
+  /// Grows to contain \a other.
+  void include( const Bounds &other )
+  {
+    if( other.isEmpty() || isUnbounded() ) {
+      return;
+    }
+    if( isEmpty() || other.isUnbounded() ) {
+      *this = other;
+      return;
+    }
+    combine( other, std::integral_constant<bool, has_components>(), [] ( ValueT &lo, ValueT &hi, ValueT other_lo, ValueT other_hi ) {
+      lo = std::min( lo, other_lo );
+      hi = std::max( hi, other_hi );
+    } );
+  }
+
+  /// Grows to contain every sum of a value in these bounds and one in \a other.
+  void add( const Bounds &other )
+  {
+    if( isEmpty() || isUnbounded() ) {
+      return;
+    }
+    if( ! other.isBounded() ) {
+      *this = other;
+      return;
+    }
+    combine( other, std::integral_constant<bool, has_components>(), [] ( ValueT &lo, ValueT &hi, ValueT other_lo, ValueT other_hi ) {
+      lo = lo + other_lo;
+      hi = hi + other_hi;
+    } );
+  }
+
+  /// Returns true if \a value may be in the bounds.
+  bool contains( const T &value ) const { return intersects( Bounds( value ) ); }
+
+  /// Returns true if these bounds and \a other may overlap.
+  bool intersects( const Bounds &other ) const
+  {
+    if( isEmpty() || other.isEmpty() ) {
+      return false;
+    }
+    if( isUnbounded() || other.isUnbounded() ) {
+      return true;
+    }
+    return overlaps( other, std::integral_constant<bool, has_components>() );
+  }
+
+private:
+  enum class State : uint8_t { Empty, Finite, Unbounded };
+  using ValueT = typename detail::BoundsValue<T>::type;
+
+  T     _min = T();
+  T     _max = T();
+  State _state = State::Empty;
+
+  template<typename Fn>
+  void combine( const Bounds &other, std::true_type, const Fn &fn )
+  {
+    for( size_t i = 0; i < Components::size; ++i )
+    {
+      ValueT lo = Components::get( _min, i );
+      ValueT hi = Components::get( _max, i );
+      fn( lo, hi, Components::get( other._min, i ), Components::get( other._max, i ) );
+      Components::set( _min, i, lo );
+      Components::set( _max, i, hi );
+    }
+  }
+
+  template<typename Fn>
+  void combine( const Bounds &/*other*/, std::false_type, const Fn &/*fn*/ ) { _state = State::Unbounded; }
+
+  bool overlaps( const Bounds &other, std::true_type ) const
+  {
+    for( size_t i = 0; i < Components::size; ++i ) {
+      if( Components::get( other._max, i ) < Components::get( _min, i ) || Components::get( _max, i ) < Components::get( other._min, i ) ) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool overlaps( const Bounds &/*other*/, std::false_type ) const { return true; }
+};
+
+namespace detail
+{
+
+/// True if InterpolationTraits<T>::lerp is a + (b - a) * t, so lerped values stay between their ends componentwise.
+template<typename T>
+struct has_linear_bounds : std::integral_constant<bool, (has_linear_floats<T>::value || std::is_arithmetic<T>::value) && (Components<T>::size > 0)> {};
+
+/// Finds the range of \a ease over normalized times [\a u0, \a u1].
+/// Eases Timelines recognize are monotone, so their ends bound them. Custom eases, which may
+/// overshoot (back, elastic), are sampled and the range widened by the largest change between samples.
+inline void easeRange( const std::function<float (float)> &ease, EaseKind kind, Time u0, Time u1, float *low, float *high )
+{
+  const float a = ease( (float)u0 );
+  const float b = ease( (float)u1 );
+  *low = std::min( a, b );
+  *high = std::max( a, b );
+  if( kind != EaseKind::Custom ) {
+    return;
+  }
+
+  const int samples = 64;
+  float previous = a;
+  float widest = 0;
+  for( int i = 1; i <= samples; ++i )
+  {
+    const float v = (i == samples) ? b : ease( (float)(u0 + (u1 - u0) * i / samples) );
+    *low = std::min( *low, v );
+    *high = std::max( *high, v );
+    widest = std::max( widest, std::abs( v - previous ) );
+    previous = v;
+  }
+  *low -= widest;
+  *high += widest;
+}
+
+/// Bounds of lerp( a, b, t ) for t in [\a low, \a high], for types with linear bounds.
+template<typename T>
+Bounds<T> lerpBounds( const T &a, const T &b, float low, float high )
+{
+  return Bounds<T>( traitLerp( a, b, low ), traitLerp( a, b, high ) );
+}
+
+///
+/// Segment tree answering the union of Bounds over a range of indices in O(log n).
+/// Immutable once built, so it can be shared between copies of its owner.
+///
+template<typename T>
+class BoundsTree
+{
+public:
+  explicit BoundsTree( const std::vector<Bounds<T>> &leaves ):
+    _size( leaves.size() ),
+    _nodes( 2 * leaves.size() )
+  {
+    std::copy( leaves.begin(), leaves.end(), _nodes.begin() + _size );
+    for( size_t i = _size; i-- > 1; ) {
+      _nodes[i] = _nodes[2 * i];
+      _nodes[i].include( _nodes[2 * i + 1] );
+    }
+  }
+
+  /// Returns the union of leaves in [\a first, \a last).
+  Bounds<T> query( size_t first, size_t last ) const
+  {
+    Bounds<T> out;
+    for( first += _size, last += _size; first < last; first /= 2, last /= 2 )
+    {
+      if( first & 1 ) {
+        out.include( _nodes[first++] );
+      }
+      if( last & 1 ) {
+        out.include( _nodes[--last] );
+      }
+    }
+    return out;
+  }
+
+  size_t size() const { return _size; }
+
+private:
+  size_t                  _size;
+  std::vector<Bounds<T>>  _nodes;
+};
+
+} // namespace detail
+
+///
+/// Visibility tests a Timeline uses to cull items, one per value type.
+/// A test receives bounds on a Motion's values over a span of time and returns false
+/// if no value in them can be seen, e.g. because a position's bounds miss the viewport.
+///
+class CullTest
+{
+public:
+  template<typename T>
+  using Fn = std::function<bool (const Bounds<T> &bounds)>;
+
+  /// Sets the test for values of type T, replacing any previous one.
+  template<typename T>
+  void set( const Fn<T> &visible );
+
+  /// Returns the test for values of type T, or nullptr if there is none.
+  template<typename T>
+  const Fn<T>* find() const;
+
+  bool empty() const { return _tests.empty(); }
+  void clear() { _tests.clear(); _revision = detail::nextRevision(); }
+
+  /// Returns a number that changes whenever tests are set or cleared.
+  uint64_t getRevision() const { return _revision; }
+
+private:
+  struct Entry
+  {
+    const std::type_info    *type;
+    std::shared_ptr<void>   fn;
+  };
+
+  std::vector<Entry>  _tests;
+  uint64_t            _revision = detail::nextRevision();
+};
+
+template<typename T>
+void CullTest::set( const Fn<T> &visible )
+{
+  auto fn = std::make_shared<Fn<T>>( visible );
+  _revision = detail::nextRevision();
+  for( auto &entry : _tests ) {
+    if( *entry.type == typeid( T ) ) {
+      entry.fn = fn;
+      return;
+    }
+  }
+  _tests.push_back( Entry{ &typeid( T ), fn } );
+}
+
+template<typename T>
+const CullTest::Fn<T>* CullTest::find() const
+{
+  for( const auto &entry : _tests ) {
+    if( *entry.type == typeid( T ) ) {
+      return static_cast<const Fn<T>*>( entry.fn.get() );
+    }
+  }
+  return nullptr;
+}
+
+} // namespace choreograph
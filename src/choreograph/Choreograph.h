@@ -29,16 +29,34 @@
 
 // Timeline.h includes most of Choreograph.
 #include "Timeline.h"
+#include "CueTrack.h"
+#include "TimelineExecutor.h"
+#include "SharedMemory.h"
+#include "Follow.hpp"
 
 #include "phrase/Ramp.hpp"
 #include "phrase/Hold.hpp"
 #include "phrase/Retime.hpp"
 #include "phrase/Combine.hpp"
 #include "phrase/Procedural.hpp"
+#include "phrase/Keyframes.hpp"
+#include "phrase/Cached.hpp"
 #include "phrase/Sugar.hpp"
 
+#include "FastEasing.h"
+
+#include "Recording.h"
+#include "Simplify.hpp"
+#include "Show.h"
+#include "Import.h"
+#include "Clock.h"
+
+// Built-in vectors and quaternions; optional adapters for Cinder and GLM types.
+#include "math/Math.hpp"
 #if defined( CINDER_CINDER )
   #include "specialization/CinderSpecialization.hpp"
+#elif defined( CHOREOGRAPH_USE_GLM )
+  #include "specialization/GlmSpecialization.hpp"
 #endif
 
 ///
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace choreograph;
+using namespace std;
+
+ClockDriver::ClockDriver( TimelineItem &item, const ClockSourceRef &clock ):
+  _item( item ),
+  _clock( clock )
+{}
+
+void ClockDriver::reset()
+{
+  _locked = false;
+}
+
+void ClockDriver::lock( Time clock_now )
+{
+  _locked = true;
+  _clock_origin = clock_now;
+  _item_origin = _item.time();
+  _speed = _item.getPlaybackSpeed();
+  _last_clock = clock_now;
+  _smoothed_dt = -1;
+}
+
+void ClockDriver::measure( Time clock_now )
+{
+  const Time error = (_speed != 0) ? (expectedTime( clock_now ) - _item.time()) / _speed : 0;
+  _stats.error = error;
+  _stats.max_error = max( _stats.max_error, abs( error ) );
+  _stats.updates += 1;
+}
+
+void ClockDriver::update()
+{
+  const Time now = _clock->now();
+  if( ! _locked )
+  {
+    lock( now );
+    _stats.slew = 1;
+    measure( now );
+    return;
+  }
+
+  // Someone changed the playback speed; keep the time reached and run at the new rate from here.
+  if( _item.getPlaybackSpeed() != _speed )
+  {
+    _item_origin = expectedTime( _last_clock );
+    _clock_origin = _last_clock;
+    _speed = _item.getPlaybackSpeed();
+  }
+
+  const Time raw_dt = now - _last_clock;
+  _last_clock = now;
+
+  if( (raw_dt < 0 || raw_dt > _jump_threshold) && _jump_policy != ClockJump::Slew )
+  {
+    _stats.jumps += 1;
+    // Expected time is relative to the item's start; setTime() and jumpTo() take absolute time.
+    const Time target = _item.getStartTime() + expectedTime( now );
+    if( _jump_policy == ClockJump::Seek ) {
+      _item.setTime( target );
+    }
+    else {
+      _item.jumpTo( target );
+    }
+    lock( now );
+    _stats.slew = 1;
+    measure( now );
+    return;
+  }
+
+  // Smooth clock increments, starting from the first one after locking.
+  const Time dt = max<Time>( raw_dt, 0 );
+  _smoothed_dt = (_smoothed_dt < 0) ? dt : _smoothing * _smoothed_dt + (1 - _smoothing) * dt;
+
+  // Error left if we stepped by the smoothed increment, removed over the correction time.
+  Time slew = 1;
+  if( _speed != 0 && _smoothed_dt > 0 )
+  {
+    const Time residual = (expectedTime( now ) - _item.time()) / _speed - _smoothed_dt;
+    const Time correction = (_correction_time > 0) ? residual / _correction_time : residual / _smoothed_dt;
+    slew = 1 + max( -_max_slew, min( _max_slew, correction ) );
+  }
+
+  _stats.slew = slew;
+  _item.step( _smoothed_dt * slew );
+  measure( now );
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+#include "detail/Latency.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+///
+/// \file
+/// Clock sources and a driver that locks a Timeline to one.
+///
+
+namespace choreograph
+{
+
+///
+/// A source of time in seconds, e.g. the system clock, an audio device or house timecode.
+/// Time should move forward steadily; anything else is treated as a jump by ClockDriver.
+///
+class ClockSource
+{
+public:
+  virtual ~ClockSource() = default;
+  /// Returns the current time in seconds.
+  virtual Time now() const = 0;
+};
+
+using ClockSourceRef = std::shared_ptr<ClockSource>;
+
+///
+/// The monotonic system clock, counted from construction.
+///
+class SystemClock : public ClockSource
+{
+public:
+  SystemClock(): _origin( detail::monotonicNanoseconds() ) {}
+  Time now() const override { return (detail::monotonicNanoseconds() - _origin) * 1.0e-9; }
+
+private:
+  int64_t _origin;
+};
+
+///
+/// A clock counting samples, e.g. frames rendered by an audio device.
+/// Call addSamples() from the audio callback; now() is safe to call from any thread.
+///
+class SampleClock : public ClockSource
+{
+public:
+  explicit SampleClock( double sample_rate ): _sample_rate( sample_rate ) {}
+
+  void      addSamples( uint64_t count ) { _samples.fetch_add( count, std::memory_order_relaxed ); }
+  void      setSampleCount( uint64_t count ) { _samples.store( count, std::memory_order_relaxed ); }
+  uint64_t  getSampleCount() const { return _samples.load( std::memory_order_relaxed ); }
+  double    getSampleRate() const { return _sample_rate; }
+
+  Time now() const override { return getSampleCount() / _sample_rate; }
+
+private:
+  double                  _sample_rate;
+  std::atomic<uint64_t>   _samples { 0 };
+};
+
+///
+/// A clock that only moves when told to. Use to test and replay clock behavior.
+///
+class SimulatedClock : public ClockSource
+{
+public:
+  explicit SimulatedClock( Time start = 0 ): _now( start ) {}
+
+  void advance( Time dt ) { _now += dt; }
+  void set( Time now ) { _now = now; }
+
+  Time now() const override { return _now; }
+
+private:
+  Time  _now;
+};
+
+/// What ClockDriver does when its clock jumps by more than the jump threshold, or runs backward.
+enum class ClockJump
+{
+  /// Set the Timeline's time without firing cues or callbacks.
+  Seek,
+  /// Jump the Timeline to the new time, firing cues and callbacks crossed on the way.
+  Scrub,
+  /// Treat the jump as drift and correct it gradually, at the maximum slew.
+  Slew
+};
+
+/// Measurements from a ClockDriver.
+struct ClockDriverStats
+{
+  /// Clock time minus Timeline time after the last update, in seconds of clock time.
+  Time      error = 0;
+  /// Largest absolute error since the last reset.
+  Time      max_error = 0;
+  /// Speed multiplier applied by drift correction in the last update.
+  Time      slew = 1;
+  uint64_t  updates = 0;
+  uint64_t  jumps = 0;
+};
+
+///
+/// Steps a Timeline (or any TimelineItem) from a ClockSource so it stays locked to the clock.
+///
+/// Call update() once per frame instead of step(). Each update:
+///  - reads the clock and smooths its increments, so clocks that advance in blocks
+///    (audio buffers) or with jitter still produce even animation steps;
+///  - measures how far the Timeline is from where the clock says it should be and
+///    slews playback by up to the maximum slew to remove that error over the correction time;
+///  - handles jumps, and clocks running backward, as configured.
+///
+/// The Timeline's own playback speed still applies: at speed 2 it runs at twice clock rate.
+///
+class ClockDriver
+{
+public:
+  ClockDriver( TimelineItem &item, const ClockSourceRef &clock );
+
+  /// Reads the clock and steps the item.
+  void update();
+
+  /// Relocks to the clock at the item's current time, discarding error and smoothing history.
+  void reset();
+
+  /// Weight of the previous increment when smoothing clock increments, in [0, 1). Zero disables smoothing.
+  void setJitterSmoothing( float smoothing ) { _smoothing = smoothing; }
+  /// Largest fractional speed change used to correct drift, e.g. 0.05 for ±5%.
+  void setMaxSlew( Time max_slew ) { _max_slew = max_slew; }
+  /// Time over which drift is corrected, before limiting to the maximum slew.
+  void setCorrectionTime( Time seconds ) { _correction_time = seconds; }
+  /// Clock increments larger than \a seconds, or negative ones, are jumps.
+  void setJumpThreshold( Time seconds ) { _jump_threshold = seconds; }
+  void setJumpPolicy( ClockJump policy ) { _jump_policy = policy; }
+
+  const ClockDriverStats& getStats() const { return _stats; }
+  void resetStats() { _stats = ClockDriverStats(); }
+
+  const ClockSourceRef& getClock() const { return _clock; }
+
+private:
+  TimelineItem    &_item;
+  ClockSourceRef  _clock;
+
+  float       _smoothing = 0.8f;
+  Time        _max_slew = 0.05;
+  Time        _correction_time = 0.25;
+  Time        _jump_threshold = 0.5;
+  ClockJump   _jump_policy = ClockJump::Seek;
+
+  bool        _locked = false;
+  Time        _clock_origin = 0;
+  Time        _item_origin = 0;
+  Time        _speed = 1;
+  Time        _last_clock = 0;
+  Time        _smoothed_dt = 0;
+
+  ClockDriverStats  _stats;
+
+  void lock( Time clock_now );
+  Time expectedTime( Time clock_now ) const { return _item_origin + (clock_now - _clock_origin) * _speed; }
+  void measure( Time clock_now );
+};
+
+} // namespace choreograph
@@ -31,6 +31,125 @@
 using namespace choreograph;
 using namespace std;
 
+//=================================================
+// CueWorker
+//=================================================
+
+CueWorker::CueWorker():
+  _thread( [this] { run(); } )
+{}
+
+CueWorker::~CueWorker()
+{
+  {
+    lock_guard<mutex> lock( _mutex );
+    _stopping = true;
+  }
+  _wake.notify_one();
+  _thread.join();
+}
+
+void CueWorker::submit( const function<void ()> &task )
+{
+  {
+    lock_guard<mutex> lock( _mutex );
+    _tasks.push_back( task );
+  }
+  _wake.notify_one();
+}
+
+void CueWorker::run()
+{
+  while( true )
+  {
+    function<void ()> task;
+    {
+      unique_lock<mutex> lock( _mutex );
+      _wake.wait( lock, [this] { return _stopping || ! _tasks.empty(); } );
+      if( _tasks.empty() ) {
+        return;
+      }
+      task = std::move( _tasks.front() );
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
+
+//=================================================
+// CueCompletion
+//=================================================
+
+size_t CueCompletion::getFireCount() const
+{
+  lock_guard<mutex> lock( _mutex );
+  return _fired;
+}
+
+size_t CueCompletion::getCompletedCount() const
+{
+  lock_guard<mutex> lock( _mutex );
+  return _completed;
+}
+
+bool CueCompletion::isDone() const
+{
+  lock_guard<mutex> lock( _mutex );
+  return _fired > 0 && _completed == _fired;
+}
+
+void CueCompletion::wait() const
+{
+  unique_lock<mutex> lock( _mutex );
+  _finished.wait( lock, [this] { return _completed == _fired; } );
+}
+
+LatencyStats CueCompletion::getQueueLatency() const
+{
+  lock_guard<mutex> lock( _mutex );
+  return _queue_latency;
+}
+
+void CueCompletion::fired()
+{
+  lock_guard<mutex> lock( _mutex );
+  _fired += 1;
+}
+
+void CueCompletion::started( int64_t queued_ns )
+{
+  lock_guard<mutex> lock( _mutex );
+  _queue_latency.add( queued_ns );
+}
+
+void CueCompletion::completed()
+{
+  {
+    lock_guard<mutex> lock( _mutex );
+    _completed += 1;
+  }
+  _finished.notify_all();
+}
+
+//=================================================
+// CueResumeQueue
+//=================================================
+
+void detail::CueResumeQueue::resume()
+{
+  while( ! _tickets.empty() && _tickets.front()->done.load( memory_order_acquire ) )
+  {
+    auto ticket = std::move( _tickets.front() );
+    _tickets.pop_front();
+    if( ticket->error ) {
+      rethrow_exception( ticket->error );
+    }
+    if( ticket->continuation ) {
+      detail::invokeCallback( ticket->continuation );
+    }
+  }
+}
+
 //=================================================
 // Cue
 //=================================================
@@ -48,20 +167,57 @@ _cue( fn )
   }
 }
 
+const CueCompletionRef& Cue::setExecutor( const CueExecutor &executor, const shared_ptr<detail::CueResumeQueue> &resume_queue )
+{
+  _executor = executor;
+  _resume_queue = resume_queue;
+  if( ! _completion ) {
+    _completion = make_shared<CueCompletion>();
+  }
+  return _completion;
+}
+
 void Cue::update()
 {
   if( forward() )
   {
     if( time() >= 0.0f && previousTime() < 0.0f )
     {
-      _cue();
+      fire();
     }
   }
   else if ( backward() )
   {
     if( time() <= 0.0f && previousTime() > 0.0f )
     {
-      _cue();
+      fire();
     }
   }
 }
+
+void Cue::fire()
+{
+  if( ! _executor )
+  {
+    detail::invokeCallback( _cue );
+    return;
+  }
+
+  auto ticket = make_shared<detail::CueTicket>( _completion, _continuation );
+  _completion->fired();
+  _resume_queue->push( ticket );
+
+  const auto fn = _cue;
+  const auto queued = detail::monotonicNanoseconds();
+  _executor( [ticket, fn, queued] {
+    ticket->completion->started( detail::monotonicNanoseconds() - queued );
+    try {
+      fn();
+    }
+    catch( ... ) {
+      ticket->error = current_exception();
+    }
+    ticket->done.store( true, memory_order_release );
+    ticket->completion->completed();
+  } );
+}
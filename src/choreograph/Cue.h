@@ -28,13 +28,134 @@
 #pragma once
 
 #include "TimelineItem.h"
+#include "detail/Latency.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace choreograph
 {
 
+/// Runs a task on some other thread. Executors must run every task they are given, and may run
+/// them concurrently. Called from whichever thread steps the Timeline.
+using CueExecutor = std::function<void (const std::function<void ()> &task)>;
+
+///
+/// A background thread that runs tasks in the order they were submitted.
+/// The destructor finishes any queued tasks before returning.
+///
+class CueWorker
+{
+public:
+  CueWorker();
+  ~CueWorker();
+
+  CueWorker( const CueWorker &rhs ) = delete;
+  CueWorker& operator= ( const CueWorker &rhs ) = delete;
+
+  /// Queues \a task to run on the worker thread. Safe to call from any thread.
+  void submit( const std::function<void ()> &task );
+
+  /// Returns an executor that submits tasks to this worker. The worker must outlive it.
+  CueExecutor getExecutor() { return [this] ( const std::function<void ()> &task ) { submit( task ); }; }
+
+private:
+  std::mutex                          _mutex;
+  std::condition_variable             _wake;
+  std::deque<std::function<void ()>>  _tasks;
+  bool                                _stopping = false;
+  std::thread                         _thread;
+
+  void run();
+};
+
+///
+/// Completion handle for a Cue whose function runs on a CueExecutor.
+/// Counts firings and finished calls, and measures how long calls wait in the executor's queue.
+/// Safe to query from any thread.
+///
+class CueCompletion
+{
+public:
+  /// Returns the number of times the Cue has fired.
+  size_t getFireCount() const;
+  /// Returns the number of calls that have finished on the executor, including ones that threw.
+  size_t getCompletedCount() const;
+  /// Returns true if the Cue has fired and every call has finished.
+  bool isDone() const;
+  /// Blocks until every call fired so far has finished.
+  void wait() const;
+
+  /// Returns time from the Cue firing to its function starting on the executor.
+  LatencyStats getQueueLatency() const;
+
+private:
+  friend class Cue;
+
+  mutable std::mutex              _mutex;
+  mutable std::condition_variable _finished;
+  size_t                          _fired = 0;
+  size_t                          _completed = 0;
+  LatencyStats                    _queue_latency;
+
+  void fired();
+  void started( int64_t queued_ns );
+  void completed();
+};
+
+using CueCompletionRef = std::shared_ptr<CueCompletion>;
+
+namespace detail
+{
+
+/// One firing of an asynchronous Cue.
+struct CueTicket
+{
+  CueTicket( const CueCompletionRef &completion, const std::function<void ()> &continuation ):
+    completion( completion ),
+    continuation( continuation )
+  {}
+
+  CueCompletionRef        completion;
+  std::function<void ()>  continuation;
+  /// Error thrown by the Cue's function. Written before done is set.
+  std::exception_ptr      error;
+  std::atomic<bool>       done { false };
+};
+
+///
+/// Firings of asynchronous Cues on a Timeline, in the order they fired.
+/// The Timeline resumes them at the start of each step: in firing order, it runs the continuation
+/// of each finished firing and stops at the first unfinished one, so continuations never run out of order.
+///
+class CueResumeQueue
+{
+public:
+  void push( const std::shared_ptr<CueTicket> &ticket ) { _tickets.push_back( ticket ); }
+
+  /// Runs continuations of finished firings. Rethrows the first error from a Cue function.
+  void resume();
+
+  size_t size() const { return _tickets.size(); }
+
+private:
+  std::deque<std::shared_ptr<CueTicket>> _tickets;
+};
+
+} // namespace detail
+
 ///
 /// Calls a function after time has elapsed.
 ///
+/// By default the function is called inline during the Timeline step. Expensive functions
+/// can instead run on a CueExecutor (see CueOptions::async()). The Cue then hands the function to the
+/// executor when it fires and the step continues. A continuation can be set to run on the
+/// Timeline's thread during the first step after the function finishes.
+///
 class Cue : public TimelineItem
 {
 public:
@@ -49,8 +170,29 @@ public:
   /// Cues are instantaneous.
   Time getDuration() const final override { return 0.0f; }
 
+  /// Returns the function called by this cue.
+  const std::function<void ()>& getFunction() const { return _cue; }
+
+  /// Runs the function on \a executor when the Cue fires. Finished firings are resumed through \a resume_queue.
+  /// Returns the completion handle.
+  const CueCompletionRef& setExecutor( const CueExecutor &executor, const std::shared_ptr<detail::CueResumeQueue> &resume_queue );
+  /// Sets a function to run on the Timeline's thread after each asynchronous call finishes.
+  void setContinuation( const std::function<void ()> &fn ) { _continuation = fn; }
+
+  /// Returns the completion handle, or nullptr if the Cue runs synchronously.
+  const CueCompletionRef& getCompletion() const { return _completion; }
+
+  void accountMemory( MemoryCounter &counter ) const override { accountItem( counter, sizeof( *this ), sizeof( _cue ) + sizeof( _executor ) + sizeof( _continuation ) ); }
+
 private:
   std::function<void ()>    _cue;
+
+  CueExecutor                               _executor;
+  std::function<void ()>                    _continuation;
+  CueCompletionRef                          _completion;
+  std::shared_ptr<detail::CueResumeQueue>   _resume_queue;
+
+  void fire();
 };
 
 } // namespace choreograph
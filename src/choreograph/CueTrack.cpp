@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CueTrack.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+using namespace choreograph;
+using namespace std;
+
+void CueTrack::add( Time time, const function<void ()> &fn )
+{
+  if( _firing ) {
+    // Growing _functions could move the callback that is running; add it after the step.
+    _pending.emplace_back( Entry{ time, 0, 0 }, fn );
+    return;
+  }
+  _functions.push_back( fn );
+  insert( Entry{ time, 0, (uint32_t)_functions.size() } );
+}
+
+void CueTrack::add( Time time, uint32_t event_id )
+{
+  insert( Entry{ time, event_id, 0 } );
+}
+
+void CueTrack::insert( const Entry &entry )
+{
+  // Like Cue, nudge cues at time zero forward so they fire on the first step.
+  Entry e = entry;
+  e.time = max( e.time, numeric_limits<Time>::epsilon() );
+  _duration = max( _duration, e.time );
+
+  if( _firing ) {
+    _pending.emplace_back( e, nullptr );
+  }
+  else {
+    _dirty = _dirty || (! _entries.empty() && e.time < _entries.back().time);
+    _entries.push_back( e );
+  }
+}
+
+void CueTrack::clear()
+{
+  _entries.clear();
+  _pending.clear();
+  if( _firing ) {
+    // Keep the running callback alive until the step finishes.
+    _retired.swap( _functions );
+  }
+  _functions.clear();
+  _duration = 0;
+  _dirty = false;
+}
+
+void CueTrack::sort()
+{
+  stable_sort( _entries.begin(), _entries.end(), [] ( const Entry &a, const Entry &b ) {
+    return a.time < b.time;
+  } );
+  _dirty = false;
+}
+
+void CueTrack::fire( const Entry &entry )
+{
+  if( entry.function ) {
+    detail::invokeCallback( _functions[entry.function - 1] );
+  }
+  else if( _event_fn ) {
+    detail::invokeCallback( _event_fn, entry.event_id );
+  }
+}
+
+void CueTrack::update()
+{
+  if( _dirty ) {
+    sort();
+  }
+
+  const Time now = time();
+  const Time previous = previousTime();
+  const auto before = [] ( const Entry &e, Time t ) { return e.time < t; };
+  const auto after = [] ( Time t, const Entry &e ) { return t < e.time; };
+
+  _firing = true;
+  if( now > previous )
+  {
+    // Fire cues in (previous, now].
+    const size_t begin = upper_bound( _entries.begin(), _entries.end(), previous, after ) - _entries.begin();
+    const size_t end = upper_bound( _entries.begin() + begin, _entries.end(), now, after ) - _entries.begin();
+    // Bounds are rechecked in case a cue clears the track.
+    for( size_t i = begin; i < end && i < _entries.size(); ++i ) {
+      fire( _entries[i] );
+    }
+  }
+  else if( now < previous )
+  {
+    // Fire cues in [now, previous), latest first.
+    const size_t begin = lower_bound( _entries.begin(), _entries.end(), now, before ) - _entries.begin();
+    const size_t end = lower_bound( _entries.begin() + begin, _entries.end(), previous, before ) - _entries.begin();
+    for( size_t i = end; i > begin && i <= _entries.size(); --i ) {
+      fire( _entries[i - 1] );
+    }
+  }
+  _firing = false;
+  _retired.clear();
+
+  if( ! _pending.empty() ) {
+    auto pending = std::move( _pending );
+    _pending.clear();
+    for( auto &p : pending ) {
+      if( p.second ) {
+        add( p.first.time, p.second );
+      }
+      else {
+        insert( p.first );
+      }
+    }
+  }
+}
+
+void CueTrack::forEachCue( const function<void (Time, const function<void ()>&)> &fn ) const
+{
+  // Id cues share one copy of the event function.
+  const auto event_fn = _event_fn ? make_shared<EventFn>( _event_fn ) : nullptr;
+  const auto visit = [&] ( const Entry &entry, const function<void ()> &cue ) {
+    if( cue ) {
+      fn( entry.time, cue );
+    }
+    else if( event_fn ) {
+      const uint32_t id = entry.event_id;
+      fn( entry.time, [event_fn, id] { (*event_fn)( id ); } );
+    }
+  };
+
+  for( const auto &entry : _entries ) {
+    visit( entry, entry.function ? _functions[entry.function - 1] : nullptr );
+  }
+  for( const auto &pending : _pending ) {
+    visit( pending.first, pending.second );
+  }
+}
+
+void CueTrack::accountMemory( MemoryCounter &counter ) const
+{
+  accountItem( counter, sizeof( *this ), sizeof( _event_fn ) );
+  counter.addIndex( _entries.capacity() * sizeof( Entry ) + _pending.capacity() * sizeof( PendingCue ) );
+  counter.addCallbacks( _functions.capacity() * sizeof( function<void ()> ) );
+}
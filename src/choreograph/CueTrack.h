@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace choreograph
+{
+
+///
+/// CueTrack holds many cues in one time-sorted table.
+/// It is a compact alternative to adding thousands of individual Cues to a Timeline.
+///
+/// Each step fires exactly the cues crossed since the previous step, in time order.
+/// Going forward that is (previous, now]; going backward it is [now, previous), latest first.
+/// Finding them is a binary search, so a step costs O(log n + fired).
+/// Cues are never consumed, so scrubbing back and forth or looping a parent
+/// Timeline fires them again. setTime() never fires cues.
+///
+/// Cues either call their own function or pass an event id to the track's event function.
+/// Id cues take 16 bytes each and no allocation.
+///
+/// A Timeline removes finished items by default; add the track with
+/// removeOnFinish( false ) to keep it around for scrubbing.
+///
+class CueTrack : public TimelineItem
+{
+public:
+  using EventFn = std::function<void (uint32_t event_id)>;
+
+  CueTrack() = default;
+  /// Creates a track that sends the ids of id cues to \a event_fn.
+  explicit CueTrack( const EventFn &event_fn ):
+    _event_fn( event_fn )
+  {}
+
+  /// Adds a cue that calls \a fn at \a time.
+  void add( Time time, const std::function<void ()> &fn );
+  /// Adds a cue that passes \a event_id to the event function at \a time.
+  void add( Time time, uint32_t event_id );
+
+  /// Sets the function that receives the ids of id cues.
+  void setEventFn( const EventFn &event_fn ) { _event_fn = event_fn; }
+  /// Reserves storage for \a cues cues.
+  void reserve( size_t cues ) { _entries.reserve( cues ); }
+  /// Removes all cues.
+  void clear();
+
+  /// Returns the number of cues on the track.
+  size_t size() const { return _entries.size() + _pending.size(); }
+
+  /// Calls \a fn with the time and function of each cue on the track, in no particular order.
+  /// Id cues get a function passing their id to the current event function, or are skipped if there is none.
+  void forEachCue( const std::function<void (Time time, const std::function<void ()> &cue)> &fn ) const;
+
+  /// Fires the cues crossed since the previous step.
+  void update() override;
+  /// Returns the time of the last cue.
+  Time getDuration() const override { return _duration; }
+
+  void accountMemory( MemoryCounter &counter ) const override;
+
+private:
+  struct Entry
+  {
+    Time      time;
+    uint32_t  event_id;
+    /// One plus the index of the cue's function, or zero for id cues.
+    uint32_t  function;
+  };
+
+  std::vector<Entry>                  _entries;
+  std::vector<std::function<void ()>> _functions;
+  EventFn                             _event_fn;
+  Time                                _duration = 0;
+  /// True when entries were added since the table was last sorted.
+  bool                                _dirty = false;
+  /// Cues added from within a cue callback, with their functions, merged after the step.
+  using PendingCue = std::pair<Entry, std::function<void ()>>;
+  std::vector<PendingCue>             _pending;
+  /// Functions cleared from within a cue callback, released after the step.
+  std::vector<std::function<void ()>> _retired;
+  bool                                _firing = false;
+
+  void insert( const Entry &entry );
+  void sort();
+  void fire( const Entry &entry );
+};
+
+} // namespace choreograph
@@ -66,12 +66,33 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #pragma once
 #include <cmath>
+#include "detail/FastMath.hpp"
 
 namespace choreograph
 {
 
 const double PI = 3.14159265358979323846;
 
+//! \cond
+// Transcendental functions used per sample by the eases below.
+// Define CHOREOGRAPH_FAST_EASING to use the approximations from detail/FastMath.hpp in every ease.
+// To pick fast eases individually, use the functions in the choreograph::fast namespace (FastEasing.h).
+namespace detail
+{
+#if defined( CHOREOGRAPH_FAST_EASING )
+  inline float easeSin( float x ) { return fastSin( x ); }
+  inline float easeCos( float x ) { return fastCos( x ); }
+  inline float easeExp2( float x ) { return fastExp2( x ); }
+  inline float easeAtan( float x ) { return fastAtan( x ); }
+#else
+  inline float easeSin( float x ) { return std::sin( x ); }
+  inline float easeCos( float x ) { return std::cos( x ); }
+  inline float easeExp2( float x ) { return std::pow( 2.0f, x ); }
+  inline float easeAtan( float x ) { return std::atan( x ); }
+#endif
+} // namespace detail
+//! \endcond
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // None
 
@@ -272,7 +293,7 @@ struct EaseOutInQuint{ float operator()( float t ) const { return easeOutInQuint
 //! Easing equation for a sinusoidal (sin(t)) ease-in, accelerating from zero velocity.
 inline float easeInSine( float t )
 {
-  return -std::cos( t * (float)PI / 2 ) + 1;
+  return -detail::easeCos( t * (float)PI / 2 ) + 1;
 }
 
 //! Easing equation for a sinusoidal (sin(t)) ease-in, accelerating from zero velocity. Functor edition.
@@ -281,7 +302,7 @@ struct EaseInSine{ float operator()( float t ) const { return easeInSine( t ); }
 //! Easing equation for a sinusoidal (sin(t)) ease-out, decelerating from zero velocity.
 inline float easeOutSine( float t )
 {
-  return std::sin( t * (float)PI / 2 );
+  return detail::easeSin( t * (float)PI / 2 );
 }
 
 //! Easing equation for a sinusoidal (sin(t)) easing out, decelerating from zero velocity. Functor edition.
@@ -290,7 +311,7 @@ struct EaseOutSine{ float operator()( float t ) const { return easeOutSine( t );
 //! Easing equation for a sinusoidal (sin(t)) ease-in/out, accelerating until halfway, then decelerating.
 inline float easeInOutSine( float t )
 {
-  return -0.5f * ( std::cos( (float)PI * t ) - 1 );
+  return -0.5f * ( detail::easeCos( (float)PI * t ) - 1 );
 }
 
 //! Easing equation for a sinusoidal (sin(t)) ease-in/out, accelerating until halfway, then decelerating. Functor edition.
@@ -312,7 +333,7 @@ struct EaseOutInSine{ float operator()( float t ) const { return easeOutInSine(
 //! Easing equation for an exponential (2^t) ease-in, accelerating from zero velocity.
 inline float easeInExpo( float t )
 {
-  return t == 0 ? 0.0f : std::pow( 2.0f, 10 * (t - 1) );
+  return t == 0 ? 0.0f : detail::easeExp2( 10 * (t - 1) );
 }
 
 //! Easing equation for an exponential (2^t) ease-in, accelerating from zero velocity. Functor edition.
@@ -321,7 +342,7 @@ struct EaseInExpo{ float operator()( float t ) const { return easeInExpo( t ); }
 //! Easing equation for an exponential (2^t) ease-out, decelerating from zero velocity.
 inline float easeOutExpo( float t )
 {
-  return t == 1 ? 1 : -std::pow( 2.0f, -10 * t ) + 1;
+  return t == 1 ? 1 : -detail::easeExp2( -10 * t ) + 1;
 }
 
 //! Easing equation for an exponential (2^t) ease-out, decelerating from zero velocity. Functor edition.
@@ -333,8 +354,8 @@ inline float easeInOutExpo( float t )
   if( t == 0 ) return 0;
   if( t == 1 ) return 1;
   t *= 2;
-  if( t < 1 ) return 0.5f * std::pow( 2.0f, 10 * (t - 1) );
-  return 0.5f * ( - std::pow( 2.0f, -10 * (t - 1)) + 2);
+  if( t < 1 ) return 0.5f * detail::easeExp2( 10 * (t - 1) );
+  return 0.5f * ( - detail::easeExp2( -10 * (t - 1)) + 2);
 }
 
 //! Easing equation for an exponential (2^t) ease-in/out, accelerating until halfway, then decelerating. Functor edition.
@@ -565,7 +586,7 @@ inline float easeInElasticHelper_( float t, float b, float c, float d, float a,
     }
 
     t_adj -= 1;
-    return -( a * std::pow( 2.0f, 10 * t_adj ) * std::sin( (t_adj * d-s) * (2 * (float)PI) / p )) + b;
+    return -( a * detail::easeExp2( 10 * t_adj ) * detail::easeSin( (t_adj * d-s) * (2 * (float)PI) / p )) + b;
 }
 
 inline float easeOutElasticHelper_( float t, float /*b*/, float c, float /*d*/, float a, float p )
@@ -582,7 +603,7 @@ inline float easeOutElasticHelper_( float t, float /*b*/, float c, float /*d*/,
         s = p / ( 2 * (float)PI ) * std::asin( c / a );
     }
 
-    return a * std::pow( 2.0f, -10*t ) * std::sin( (t-s)*(2*(float)PI)/p ) + c;
+    return a * detail::easeExp2( -10*t ) * detail::easeSin( (t-s)*(2*(float)PI)/p ) + c;
 }
 //! \endcond
 
@@ -628,8 +649,8 @@ inline float easeInOutElastic( float t, float amplitude, float period )
         s = period / (2 * (float)PI) * std::asin( 1 / amplitude );
     }
 
-    if( t < 1 ) return -0.5f * ( amplitude * std::pow( 2.0f, 10*(t-1) ) * std::sin( (t-1-s)*(2*(float)PI)/period ));
-    return amplitude * std::pow( 2.0f, -10*(t-1) ) * std::sin( (t-1-s)*(2*(float)PI)/period ) * 0.5f + 1;
+    if( t < 1 ) return -0.5f * ( amplitude * detail::easeExp2( 10*(t-1) ) * detail::easeSin( (t-1-s)*(2*(float)PI)/period ));
+    return amplitude * detail::easeExp2( -10*(t-1) ) * detail::easeSin( (t-1-s)*(2*(float)PI)/period ) * 0.5f + 1;
 }
 
 //! Easing equation for an elastic (exponentially decaying sine wave) ease-in/out, accelerating until halfway, then decelerating. Functor edition.
@@ -659,42 +680,42 @@ struct EaseOutInElastic {
 //! Easing equation for an atan ease-in, accelerating from zero velocity. Used by permssion from Chris McKenzie.
 inline float easeInAtan( float t, float a = 15 )
 {
-  float m = std::atan( a );
-  return ( std::atan( (t - 1)*a ) / m ) + 1;
+  float m = detail::easeAtan( a );
+  return ( detail::easeAtan( (t - 1)*a ) / m ) + 1;
 }
 
 //! Easing equation for an atan ease-in, accelerating from zero velocity. Functor edition. Used by permssion from Chris McKenzie.
 struct EaseInAtan {
   EaseInAtan( float a = 15 ) : mInvM( 1.0f / std::atan( a ) ), mA( a ) {}
-  float operator()( float t ) const { return ( std::atan( (t - 1) * mA ) * mInvM ) + 1; }
+  float operator()( float t ) const { return ( detail::easeAtan( (t - 1) * mA ) * mInvM ) + 1; }
   float mA, mInvM;
 };
 
 //! Easing equation for an atan ease-out, decelerating from zero velocity. Used by permssion from Chris McKenzie.
 inline float easeOutAtan( float t, float a = 15 )
 {
-  float m = std::atan( a );
-  return std::atan( t*a ) / m;
+  float m = detail::easeAtan( a );
+  return detail::easeAtan( t*a ) / m;
 }
 
 //! Easing equation for an atan ease-out, decelerating from zero velocity. Functor edition. Used by permssion from Chris McKenzie.
 struct EaseOutAtan {
   EaseOutAtan( float a = 15 ) : mInvM( 1.0f / std::atan( a ) ), mA( a ) {}
-  float operator()( float t ) const { return std::atan( t * mA ) * mInvM; }
+  float operator()( float t ) const { return detail::easeAtan( t * mA ) * mInvM; }
   float mA, mInvM;
 };
 
 //! Easing equation for an atan ease-in/out, accelerating until halfway, then decelerating. Used by permssion from Chris McKenzie.
 inline float easeInOutAtan( float t, float a = 15 )
 {
-  float m = std::atan( 0.5f * a );
-  return ( std::atan((t - 0.5f)*a) / (2*m) ) + 0.5f;
+  float m = detail::easeAtan( 0.5f * a );
+  return ( detail::easeAtan((t - 0.5f)*a) / (2*m) ) + 0.5f;
 }
 
 //! Easing equation for an atan ease-in/out, accelerating until halfway, then decelerating. Functor edition. Used by permssion from Chris McKenzie.
 struct EaseInOutAtan {
   EaseInOutAtan( float a = 15 ) : mInv2M( 1.0f / ( 2 * std::atan( 0.5f * a ) ) ), mA( a ) {}
-  float operator()( float t ) const { return ( std::atan((t - 0.5f)*mA) * mInv2M ) + 0.5f; }
+  float operator()( float t ) const { return ( detail::easeAtan((t - 0.5f)*mA) * mInv2M ) + 0.5f; }
   float mA, mInv2M;
 };
 
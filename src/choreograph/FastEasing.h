@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Easing.h"
+
+///
+/// \file
+/// Fast approximations of the eases in Easing.h that evaluate transcendental functions per sample.
+/// Use them per RampTo, e.g. then<RampTo>( value, duration, fast::EaseInOutSine() ),
+/// or define CHOREOGRAPH_FAST_EASING to make every ease in Easing.h use the same approximations.
+/// Maximum absolute errors against the exact eases are checked in tests/Ease_test.cpp.
+///
+
+namespace choreograph
+{
+namespace fast
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sine
+
+inline float easeInSine( float t )
+{
+  return -detail::fastCos( t * (float)PI / 2 ) + 1;
+}
+
+struct EaseInSine{ float operator()( float t ) const { return easeInSine( t ); } };
+
+inline float easeOutSine( float t )
+{
+  return detail::fastSin( t * (float)PI / 2 );
+}
+
+struct EaseOutSine{ float operator()( float t ) const { return easeOutSine( t ); } };
+
+inline float easeInOutSine( float t )
+{
+  return -0.5f * ( detail::fastCos( (float)PI * t ) - 1 );
+}
+
+struct EaseInOutSine{ float operator()( float t ) const { return easeInOutSine( t ); } };
+
+inline float easeOutInSine( float t )
+{
+  // Both halves reduce to sin(pi t); blend arithmetically so loops over t stay branch-free.
+  const float s = detail::fastSin( (float)PI * t ) / 2;
+  const float second_half = (float)(t >= 0.5f);
+  return second_half + (1 - 2 * second_half) * s;
+}
+
+struct EaseOutInSine{ float operator()( float t ) const { return easeOutInSine( t ); } };
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Exponential
+
+inline float easeInExpo( float t )
+{
+  return t == 0 ? 0.0f : detail::fastExp2( 10 * (t - 1) );
+}
+
+struct EaseInExpo{ float operator()( float t ) const { return easeInExpo( t ); } };
+
+inline float easeOutExpo( float t )
+{
+  return t == 1 ? 1 : -detail::fastExp2( -10 * t ) + 1;
+}
+
+struct EaseOutExpo{ float operator()( float t ) const { return easeOutExpo( t ); } };
+
+inline float easeInOutExpo( float t )
+{
+  if( t == 0 ) return 0;
+  if( t == 1 ) return 1;
+  t *= 2;
+  if( t < 1 ) return 0.5f * detail::fastExp2( 10 * (t - 1) );
+  return 0.5f * ( - detail::fastExp2( -10 * (t - 1)) + 2);
+}
+
+struct EaseInOutExpo{ float operator()( float t ) const { return easeInOutExpo( t ); } };
+
+inline float easeOutInExpo( float t )
+{
+  if( t < 0.5f ) return easeOutExpo( 2 * t ) / 2;
+  return easeInExpo( 2 * t - 1 ) / 2 + 0.5f;
+}
+
+struct EaseOutInExpo{ float operator()( float t ) const { return easeOutInExpo( t ); } };
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Circular
+// Circular eases only need a square root, which compiles to a single instruction, so the exact versions are already fast.
+
+using choreograph::easeInCirc;
+using choreograph::easeOutCirc;
+using choreograph::easeInOutCirc;
+using choreograph::easeOutInCirc;
+using choreograph::EaseInCirc;
+using choreograph::EaseOutCirc;
+using choreograph::EaseInOutCirc;
+using choreograph::EaseOutInCirc;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Elastic
+// The functors resolve amplitude and phase once on construction, leaving only fastExp2 and fastSin per sample.
+
+//! \cond
+/// Phase offset and effective amplitude of an elastic ease with change \a c.
+struct ElasticShape
+{
+  ElasticShape( float c, float amplitude, float period ):
+    a( amplitude ),
+    p( period )
+  {
+    if( a < std::abs( c ) ) {
+      a = c;
+      s = p / 4;
+    }
+    else {
+      s = p / (2 * (float)PI) * std::asin( c / a );
+    }
+  }
+
+  float a, p, s;
+};
+
+inline float easeInElasticHelper_( float t, float b, float c, const ElasticShape &shape )
+{
+  if( t == 0 ) return b;
+  if( t == 1 ) return b + c;
+  t -= 1;
+  return -( shape.a * detail::fastExp2( 10 * t ) * detail::fastSin( (t - shape.s) * (2 * (float)PI) / shape.p ) ) + b;
+}
+
+inline float easeOutElasticHelper_( float t, float c, const ElasticShape &shape )
+{
+  if( t == 0 ) return 0;
+  if( t == 1 ) return c;
+  return shape.a * detail::fastExp2( -10 * t ) * detail::fastSin( (t - shape.s) * (2 * (float)PI) / shape.p ) + c;
+}
+
+inline float easeInOutElasticHelper_( float t, const ElasticShape &shape )
+{
+  if( t == 0 ) return 0;
+  t *= 2;
+  if( t == 2 ) return 1;
+  if( t < 1 ) return -0.5f * ( shape.a * detail::fastExp2( 10*(t-1) ) * detail::fastSin( (t-1-shape.s)*(2*(float)PI)/shape.p ) );
+  return shape.a * detail::fastExp2( -10*(t-1) ) * detail::fastSin( (t-1-shape.s)*(2*(float)PI)/shape.p ) * 0.5f + 1;
+}
+//! \endcond
+
+inline float easeInElastic( float t, float amplitude, float period )
+{
+  return easeInElasticHelper_( t, 0, 1, ElasticShape( 1, amplitude, period ) );
+}
+
+struct EaseInElastic {
+  EaseInElastic( float amplitude, float period ) : mShape( 1, amplitude, period ) {}
+  float operator()( float t ) const { return easeInElasticHelper_( t, 0, 1, mShape ); }
+  ElasticShape mShape;
+};
+
+inline float easeOutElastic( float t, float amplitude, float period )
+{
+  return easeOutElasticHelper_( t, 1, ElasticShape( 1, amplitude, period ) );
+}
+
+struct EaseOutElastic {
+  EaseOutElastic( float amplitude, float period ) : mShape( 1, amplitude, period ) {}
+  float operator()( float t ) const { return easeOutElasticHelper_( t, 1, mShape ); }
+  ElasticShape mShape;
+};
+
+inline float easeInOutElastic( float t, float amplitude, float period )
+{
+  return easeInOutElasticHelper_( t, ElasticShape( 1, amplitude, period ) );
+}
+
+struct EaseInOutElastic {
+  EaseInOutElastic( float amplitude, float period ) : mShape( 1, amplitude, period ) {}
+  float operator()( float t ) const { return easeInOutElasticHelper_( t, mShape ); }
+  ElasticShape mShape;
+};
+
+inline float easeOutInElastic( float t, float amplitude, float period )
+{
+  if( t < 0.5f ) return easeOutElasticHelper_( t*2, 0.5f, ElasticShape( 0.5f, amplitude, period ) );
+  return easeInElasticHelper_( 2*t - 1, 0.5f, 0.5f, ElasticShape( 0.5f, amplitude, period ) );
+}
+
+struct EaseOutInElastic {
+  EaseOutInElastic( float amplitude, float period ) : mShape( 0.5f, amplitude, period ) {}
+  float operator()( float t ) const {
+    if( t < 0.5f ) return easeOutElasticHelper_( t*2, 0.5f, mShape );
+    return easeInElasticHelper_( 2*t - 1, 0.5f, 0.5f, mShape );
+  }
+  ElasticShape mShape;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Atan
+
+inline float easeInAtan( float t, float a = 15 )
+{
+  return ( detail::fastAtan( (t - 1)*a ) / std::atan( a ) ) + 1;
+}
+
+struct EaseInAtan {
+  EaseInAtan( float a = 15 ) : mA( a ), mInvM( 1.0f / std::atan( a ) ) {}
+  float operator()( float t ) const { return ( detail::fastAtan( (t - 1) * mA ) * mInvM ) + 1; }
+  float mA, mInvM;
+};
+
+inline float easeOutAtan( float t, float a = 15 )
+{
+  return detail::fastAtan( t*a ) / std::atan( a );
+}
+
+struct EaseOutAtan {
+  EaseOutAtan( float a = 15 ) : mA( a ), mInvM( 1.0f / std::atan( a ) ) {}
+  float operator()( float t ) const { return detail::fastAtan( t * mA ) * mInvM; }
+  float mA, mInvM;
+};
+
+inline float easeInOutAtan( float t, float a = 15 )
+{
+  return ( detail::fastAtan( (t - 0.5f)*a ) / (2 * std::atan( 0.5f * a )) ) + 0.5f;
+}
+
+struct EaseInOutAtan {
+  EaseInOutAtan( float a = 15 ) : mA( a ), mInv2M( 1.0f / ( 2 * std::atan( 0.5f * a ) ) ) {}
+  float operator()( float t ) const { return ( detail::fastAtan( (t - 0.5f)*mA ) * mInv2M ) + 0.5f; }
+  float mA, mInv2M;
+};
+
+} // namespace fast
+} // namespace choreograph
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+#include "Output.hpp"
+#include "Interpolation.hpp"
+#include "detail/VectorManipulation.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+///
+/// \file
+/// Follow items make one value chase another, integrating a little every step.
+///
+
+namespace choreograph
+{
+
+/// How a Follow approaches its source.
+enum class FollowMode
+{
+  /// Closes a fixed fraction of the distance per second: rate is the decay rate, in 1/seconds.
+  Exponential,
+  /// Spring that arrives as fast as possible without overshooting: rate is the angular frequency, in radians/second.
+  CriticallyDamped,
+  /// Moves straight toward the source: rate is the maximum speed, in units/second.
+  MaxSpeed
+};
+
+namespace detail
+{
+
+template<typename T, typename = void>
+struct has_follow_arithmetic : std::false_type {};
+template<typename T>
+struct has_follow_arithmetic<T, void_t<decltype( T( std::declval<const T&>() + (std::declval<const T&>() - std::declval<const T&>()) * 1.0f ) )>> : std::true_type {};
+
+/// Per-step coefficients shared by every follower with the same mode, rate and time step.
+struct FollowStep
+{
+  FollowStep( FollowMode mode, float rate, Time dt )
+  {
+    const float t = (float)dt;
+    switch( mode )
+    {
+      case FollowMode::Exponential:
+        blend = 1.0f - std::exp( -rate * t );
+      break;
+      case FollowMode::CriticallyDamped:
+      {
+        // Pade approximation of exp( -rate * dt ), stable for any step size.
+        const float x = rate * t;
+        decay = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+      }
+      break;
+      case FollowMode::MaxSpeed:
+        distance = rate * t;
+      break;
+    }
+    omega = rate;
+    dt_f = t;
+  }
+
+  float blend = 0;
+  float decay = 0;
+  float distance = 0;
+  float omega = 0;
+  float dt_f = 0;
+};
+
+template<typename T>
+typename std::enable_if<has_follow_arithmetic<T>::value, T>::type zeroOf( const T &value ) { return value - value; }
+template<typename T>
+typename std::enable_if<! has_follow_arithmetic<T>::value, T>::type zeroOf( const T &value ) { return value; }
+
+template<typename T>
+typename std::enable_if<has_follow_arithmetic<T>::value>::type followDamped( T &value, const T &source, T &velocity, const FollowStep &s )
+{
+  const T change = value - source;
+  const T temp = (velocity + change * s.omega) * s.dt_f;
+  velocity = (velocity - temp * s.omega) * s.decay;
+  value = source + (change + temp) * s.decay;
+}
+
+template<typename T>
+typename std::enable_if<! has_follow_arithmetic<T>::value>::type followDamped( T &/*value*/, const T &/*source*/, T &/*velocity*/, const FollowStep &/*s*/ )
+{
+  throw std::logic_error( "FollowMode::CriticallyDamped needs +, - and * float for the followed type." );
+}
+
+template<typename T>
+typename std::enable_if<has_follow_arithmetic<T>::value && (Components<T>::size > 0)>::type followMaxSpeed( T &value, const T &source, const FollowStep &s )
+{
+  const T delta = source - value;
+  float length_squared = 0;
+  for( size_t i = 0; i < Components<T>::size; ++i ) {
+    const float c = (float)Components<T>::get( delta, i );
+    length_squared += c * c;
+  }
+  if( length_squared <= s.distance * s.distance ) {
+    value = source;
+  }
+  else {
+    value = value + delta * (s.distance / std::sqrt( length_squared ));
+  }
+}
+
+template<typename T>
+typename std::enable_if<! (has_follow_arithmetic<T>::value && (Components<T>::size > 0))>::type followMaxSpeed( T &/*value*/, const T &/*source*/, const FollowStep &/*s*/ )
+{
+  throw std::logic_error( "FollowMode::MaxSpeed needs arithmetic operators and components for the followed type." );
+}
+
+/// Returns true if T has what following in \a mode needs.
+template<typename T>
+bool canFollow( FollowMode mode )
+{
+  switch( mode )
+  {
+    case FollowMode::Exponential:
+      return has_trait_lerp<T>::value;
+    case FollowMode::CriticallyDamped:
+      return has_follow_arithmetic<T>::value;
+    case FollowMode::MaxSpeed:
+      return has_follow_arithmetic<T>::value && (Components<T>::size > 0);
+  }
+  return false;
+}
+
+/// Returns \a mode, throwing std::invalid_argument if T lacks what following in it needs.
+template<typename T>
+FollowMode requireFollowMode( FollowMode mode )
+{
+  if( ! canFollow<T>( mode ) ) {
+    throw std::invalid_argument( "The followed type lacks the interpolation or arithmetic this FollowMode needs." );
+  }
+  return mode;
+}
+
+/// Advances \a value toward \a source by one step.
+template<typename T>
+void follow( FollowMode mode, T &value, const T &source, T &velocity, const FollowStep &s )
+{
+  switch( mode )
+  {
+    case FollowMode::Exponential:
+      value = traitLerp( value, source, s.blend );
+    break;
+    case FollowMode::CriticallyDamped:
+      followDamped( value, source, velocity, s );
+    break;
+    case FollowMode::MaxSpeed:
+      followMaxSpeed( value, source, s );
+    break;
+  }
+}
+
+} // namespace detail
+
+///
+/// Follow writes a value that chases another value, e.g. a camera following a player or a cursor trail.
+///
+/// State is the current value and, for critically damped following, a velocity. Each step
+/// integrates from where the value is, so the source can move freely and nothing is allocated.
+/// Follows never finish; cancel them or remove them from their Timeline when done.
+/// Time steps must be positive; jumping backward leaves the value where it is.
+///
+/// Exponential following works for any type with InterpolationTraits. Critically damped and
+/// max speed following need +, - and * float; max speed also needs components to measure distance.
+/// Constructing or setting a mode the type can't follow in throws std::invalid_argument.
+///
+/// Followers can follow each other. Timelines update items in the order they were added,
+/// so add the head of a chain first, or use a FollowGroup, which orders chains itself.
+///
+template<typename T>
+class Follow : public TimelineItem
+{
+public:
+  /// Writes to \a target, chasing \a source. Both must outlive the Follow.
+  Follow( T *target, const T *source, FollowMode mode = FollowMode::Exponential, float rate = 8.0f ):
+    _target( target ),
+    _source( source ),
+    _velocity( detail::zeroOf( *target ) ),
+    _mode( detail::requireFollowMode<T>( mode ) ),
+    _rate( rate )
+  {}
+
+  /// Writes to \a target, chasing \a source. Both Outputs must stay in place while the Follow runs.
+  Follow( Output<T> *target, const Output<T> *source, FollowMode mode = FollowMode::Exponential, float rate = 8.0f ):
+    Follow( target->valuePtr(), source->valuePtr(), mode, rate )
+  {}
+
+  void update() override
+  {
+    const Time dt = deltaTime();
+    if( dt > 0 ) {
+      detail::follow( _mode, *_target, *_source, _velocity, detail::FollowStep( _mode, _rate, dt ) );
+    }
+  }
+
+  /// Follows never finish.
+  Time getDuration() const override { return std::numeric_limits<Time>::infinity(); }
+
+  const void* getTarget() const override { return _target; }
+
+  void accountMemory( MemoryCounter &counter ) const override { accountItem( counter, sizeof( *this ) ); }
+
+  void        setMode( FollowMode mode ) { _mode = detail::requireFollowMode<T>( mode ); }
+  FollowMode  getMode() const { return _mode; }
+  void        setRate( float rate ) { _rate = rate; }
+  float       getRate() const { return _rate; }
+
+  /// Changes the followed value.
+  void        setSource( const T *source ) { _source = source; }
+  void        setSource( const Output<T> *source ) { _source = source->valuePtr(); }
+
+  /// Returns the current velocity of critically damped following.
+  const T&    getVelocity() const { return _velocity; }
+  /// Stops the target where it is.
+  void        resetVelocity() { _velocity = detail::zeroOf( *_target ); }
+
+private:
+  T           *_target;
+  const T     *_source;
+  T           _velocity;
+  FollowMode  _mode;
+  float       _rate;
+};
+
+///
+/// FollowGroup steps many followers sharing a mode and rate in one TimelineItem.
+///
+/// The step coefficients (an exp() per step) are computed once for the whole group and
+/// followers sit in one contiguous array. Followers whose source is another follower's target
+/// are updated after it, so chains (A follows B follows C) see this step's values regardless
+/// of the order they were added.
+///
+template<typename T>
+class FollowGroup : public TimelineItem
+{
+public:
+  FollowGroup( FollowMode mode = FollowMode::Exponential, float rate = 8.0f ):
+    _mode( detail::requireFollowMode<T>( mode ) ),
+    _rate( rate )
+  {}
+
+  /// Adds a follower writing to \a target and chasing \a source. Both must outlive their membership.
+  void add( T *target, const T *source ) { _followers.push_back( Follower{ target, source, detail::zeroOf( *target ) } ); _dirty = true; }
+  /// Adds a follower writing to \a target and chasing \a source. Both Outputs must stay in place while in the group.
+  void add( Output<T> *target, const Output<T> *source ) { add( target->valuePtr(), source->valuePtr() ); }
+
+  /// Removes the follower writing to \a target.
+  void remove( const T *target )
+  {
+    detail::erase_if( &_followers, [target] (const Follower &f) { return f.target == target; } );
+    _dirty = true;
+  }
+  void remove( const Output<T> *target ) { remove( target->valuePtr() ); }
+
+  void clear() { _followers.clear(); }
+  size_t size() const { return _followers.size(); }
+
+  void update() override
+  {
+    const Time dt = deltaTime();
+    if( dt <= 0 ) {
+      return;
+    }
+    if( _dirty ) {
+      sortChains();
+    }
+
+    const detail::FollowStep step( _mode, _rate, dt );
+    for( auto &f : _followers ) {
+      detail::follow( _mode, *f.target, *f.source, f.velocity, step );
+    }
+  }
+
+  /// Follow groups never finish.
+  Time getDuration() const override { return std::numeric_limits<Time>::infinity(); }
+
+  void accountMemory( MemoryCounter &counter ) const override
+  {
+    accountItem( counter, sizeof( *this ) );
+    counter.addItemStorage( _followers.capacity() * sizeof( Follower ) );
+  }
+
+  void        setMode( FollowMode mode ) { _mode = detail::requireFollowMode<T>( mode ); }
+  FollowMode  getMode() const { return _mode; }
+  void        setRate( float rate ) { _rate = rate; }
+  float       getRate() const { return _rate; }
+
+private:
+  struct Follower
+  {
+    T       *target;
+    const T *source;
+    T       velocity;
+  };
+
+  std::vector<Follower> _followers;
+  FollowMode            _mode;
+  float                 _rate;
+  bool                  _dirty = false;
+
+  /// Orders followers so each comes after the follower writing its source. Cycles keep their order.
+  void sortChains()
+  {
+    _dirty = false;
+    std::unordered_map<const T*, size_t> writer;
+    for( size_t i = 0; i < _followers.size(); ++i ) {
+      writer[_followers[i].target] = i;
+    }
+
+    std::vector<Follower> sorted;
+    sorted.reserve( _followers.size() );
+    std::vector<char> state( _followers.size(), 0 ); // 0: pending, 1: visiting, 2: placed.
+    std::vector<size_t> chain;
+    for( size_t i = 0; i < _followers.size(); ++i )
+    {
+      // Walk up to the head of the chain, then place it and everything behind it.
+      size_t current = i;
+      while( state[current] == 0 )
+      {
+        state[current] = 1;
+        chain.push_back( current );
+        auto w = writer.find( _followers[current].source );
+        if( w == writer.end() ) {
+          break;
+        }
+        current = w->second;
+      }
+      while( ! chain.empty() ) {
+        sorted.push_back( _followers[chain.back()] );
+        state[chain.back()] = 2;
+        chain.pop_back();
+      }
+    }
+    _followers.swap( sorted );
+  }
+};
+
+template<typename T>
+using FollowRef = std::shared_ptr<Follow<T>>;
+
+template<typename T>
+using FollowGroupRef = std::shared_ptr<FollowGroup<T>>;
+
+} // namespace choreograph
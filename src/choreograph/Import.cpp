@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Import.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Prefer std::from_chars when the standard library provides it for floating point.
+#if defined( __has_include )
+  #if __has_include( <charconv> ) && __cplusplus >= 201703L
+    #include <charconv>
+  #endif
+#endif
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+bool isSpace( char c )
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const char* skipSpace( const char *first, const char *last )
+{
+  while( first < last && isSpace( *first ) ) {
+    ++first;
+  }
+  return first;
+}
+
+/// Parses a number at \a first, advancing it past the number. Returns false if there is no number.
+/// The buffer must be terminated after \a last so the strtod fallback can't run off its end.
+bool parseNumber( const char *&first, const char *last, double *value )
+{
+  first = skipSpace( first, last );
+  if( first < last && *first == '+' ) {
+    ++first;
+  }
+#if defined( __cpp_lib_to_chars )
+  auto result = from_chars( first, last, *value );
+  if( result.ec != errc() ) {
+    return false;
+  }
+  first = result.ptr;
+#else
+  char *end = nullptr;
+  *value = strtod( first, &end );
+  if( end == first || end > last ) {
+    return false;
+  }
+  first = end;
+#endif
+  return true;
+}
+
+///
+/// Reads \a stream through a fixed buffer, passing each complete record to \a handle.
+/// \a find_end returns the delimiter ending the record starting at its first argument, or nullptr if the record is incomplete.
+/// Returns the number of bytes read.
+///
+template<typename FindEnd, typename Handle>
+size_t streamRecords( istream &stream, size_t buffer_size, const FindEnd &find_end, const Handle &handle )
+{
+  vector<char> buffer( buffer_size + 1 );
+  size_t filled = 0;
+  size_t bytes = 0;
+  bool   eof = false;
+
+  while( ! eof )
+  {
+    stream.read( buffer.data() + filled, buffer_size - filled );
+    const size_t count = (size_t)stream.gcount();
+    eof = ! stream;
+    bytes += count;
+    filled += count;
+    buffer[filled] = '\0';
+
+    const char *end = buffer.data() + filled;
+    const char *pos = buffer.data();
+    while( pos < end )
+    {
+      const char *record_end = find_end( pos, end );
+      if( ! record_end )
+      {
+        if( ! eof ) {
+          break;
+        }
+        record_end = end;
+      }
+      handle( pos, record_end );
+      pos = (record_end < end) ? record_end + 1 : end;
+    }
+
+    const size_t remaining = end - pos;
+    if( remaining == buffer_size ) {
+      throw runtime_error( "Import record is larger than the import buffer." );
+    }
+    memmove( buffer.data(), pos, remaining );
+    filled = remaining;
+  }
+
+  return bytes;
+}
+
+///
+/// Accumulates rows of samples into per-channel keyframes.
+/// Row storage is reused, so only new channels and keyframe storage allocate.
+///
+class TrackBuilder
+{
+public:
+  static const size_t npos = (size_t)-1;
+
+  explicit TrackBuilder( const ImportOptions &options ):
+    _tolerance( options.tolerance )
+  {}
+
+  size_t addChannel( const char *first, const char *last )
+  {
+    _channels.emplace_back( string( first, last ), _tolerance );
+    _row.push_back( 0 );
+    _present.push_back( false );
+    return _channels.size() - 1;
+  }
+
+  /// Returns the channel named [first, last), checking \a hint first since rows usually repeat their key order.
+  size_t findChannel( const char *first, const char *last, size_t hint ) const
+  {
+    const size_t length = last - first;
+    auto matches = [=] ( const Channel &c ) {
+      return c.name.size() == length && memcmp( c.name.data(), first, length ) == 0;
+    };
+    if( hint < _channels.size() && matches( _channels[hint] ) ) {
+      return hint;
+    }
+    for( size_t i = 0; i < _channels.size(); ++i ) {
+      if( matches( _channels[i] ) ) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  size_t channelCount() const { return _channels.size(); }
+
+  void beginRow()
+  {
+    _has_time = false;
+    fill( _present.begin(), _present.end(), false );
+  }
+
+  void setTime( double time ) { _time = time; _has_time = true; }
+  void setValue( size_t channel, double value ) { _row[channel] = value; _present[channel] = true; }
+
+  void endRow( size_t row )
+  {
+    if( ! _has_time ) {
+      throw runtime_error( "Import row " + to_string( row ) + " has no time value." );
+    }
+
+    for( size_t i = 0; i < _channels.size(); ++i )
+    {
+      if( ! _present[i] ) {
+        continue;
+      }
+      auto &c = _channels[i];
+      if( c.times.empty() && c.fitter.getSampleCount() == 0 ) {
+        c.start_time = _time;
+      }
+      if( _tolerance > 0 ) {
+        c.fitter.addSample( _time, (float)_row[i] );
+      }
+      else if( c.times.empty() || _time > c.times.back() ) {
+        c.times.push_back( _time );
+        c.values.push_back( (float)_row[i] );
+      }
+    }
+  }
+
+  vector<KeyframeImport::Channel> finish()
+  {
+    vector<KeyframeImport::Channel> channels;
+    for( auto &c : _channels )
+    {
+      KeyframeImport::Channel channel;
+      channel.name = c.name;
+      channel.start_time = c.start_time;
+      if( _tolerance > 0 ) {
+        channel.track = c.fitter.finish();
+      }
+      else if( ! c.times.empty() ) {
+        channel.track = make_shared<KeyframeTrack<float>>( std::move( c.times ), std::move( c.values ) );
+      }
+      channels.push_back( std::move( channel ) );
+    }
+    return channels;
+  }
+
+private:
+  struct Channel
+  {
+    Channel( const string &name, double tolerance ):
+      name( name ),
+      fitter( tolerance )
+    {}
+
+    string                name;
+    Time                  start_time = 0;
+    vector<Time>          times;
+    vector<float>         values;
+    KeyframeFitter<float> fitter;
+  };
+
+  double          _tolerance;
+  vector<Channel> _channels;
+  vector<double>  _row;
+  vector<char>    _present;
+  double          _time = 0;
+  bool            _has_time = false;
+};
+
+} // namespace
+
+//=================================================
+// KeyframeImport
+//=================================================
+
+KeyframeTrackRef<float> KeyframeImport::getTrack( const std::string &name ) const
+{
+  for( auto &c : channels ) {
+    if( c.name == name ) {
+      return c.track;
+    }
+  }
+  return nullptr;
+}
+
+//=================================================
+// CSV
+//=================================================
+
+KeyframeImport choreograph::importKeyframesCsv( std::istream &stream, const ImportOptions &options )
+{
+  const size_t time_column = TrackBuilder::npos - 1;
+
+  TrackBuilder    builder( options );
+  vector<size_t>  columns;
+  size_t          line = 0;
+  size_t          rows = 0;
+  bool            header = true;
+
+  auto find_end = [] ( const char *first, const char *last ) -> const char* {
+    return static_cast<const char*>( memchr( first, '\n', last - first ) );
+  };
+
+  auto handle = [&] ( const char *first, const char *last ) {
+    line += 1;
+    if( skipSpace( first, last ) == last ) {
+      return;
+    }
+
+    if( header )
+    {
+      header = false;
+      for( const char *p = first; p <= last; )
+      {
+        const char *field_end = find( p, last, ',' );
+        const char *name_begin = skipSpace( p, field_end );
+        const char *name_end = field_end;
+        while( name_end > name_begin && isSpace( *(name_end - 1) ) ) {
+          --name_end;
+        }
+        if( name_end - name_begin >= 2 && *name_begin == '"' && *(name_end - 1) == '"' ) {
+          ++name_begin;
+          --name_end;
+        }
+
+        if( options.time_column.compare( 0, string::npos, name_begin, name_end - name_begin ) == 0 ) {
+          columns.push_back( time_column );
+        }
+        else {
+          columns.push_back( builder.addChannel( name_begin, name_end ) );
+        }
+        p = field_end + 1;
+      }
+      // Without a named time column, the first column holds time.
+      if( find( columns.begin(), columns.end(), time_column ) == columns.end() ) {
+        columns.front() = time_column;
+      }
+      return;
+    }
+
+    rows += 1;
+    builder.beginRow();
+    size_t column = 0;
+    for( const char *p = first; p <= last; ++column )
+    {
+      const char *field_end = find( p, last, ',' );
+      if( column >= columns.size() ) {
+        throw runtime_error( "CSV line " + to_string( line ) + " has more fields than the header." );
+      }
+      if( skipSpace( p, field_end ) != field_end )
+      {
+        double value;
+        if( ! parseNumber( p, field_end, &value ) || skipSpace( p, field_end ) != field_end ) {
+          throw runtime_error( "CSV line " + to_string( line ) + " has an invalid number in column " + to_string( column + 1 ) + "." );
+        }
+        if( columns[column] == time_column ) {
+          builder.setTime( value );
+        }
+        else {
+          builder.setValue( columns[column], value );
+        }
+      }
+      p = field_end + 1;
+    }
+    builder.endRow( rows );
+  };
+
+  KeyframeImport result;
+  result.bytes = streamRecords( stream, options.buffer_size, find_end, handle );
+  result.rows = rows;
+  result.channels = builder.finish();
+  return result;
+}
+
+//=================================================
+// JSON
+//=================================================
+
+KeyframeImport choreograph::importKeyframesJson( std::istream &stream, const ImportOptions &options )
+{
+  TrackBuilder  builder( options );
+  size_t        rows = 0;
+
+  // Records end at the closing brace of each flat row object.
+  auto find_end = [] ( const char *first, const char *last ) -> const char* {
+    bool in_string = false;
+    for( const char *p = first; p < last; ++p )
+    {
+      if( in_string ) {
+        if( *p == '\\' ) {
+          ++p;
+        }
+        else if( *p == '"' ) {
+          in_string = false;
+        }
+      }
+      else if( *p == '"' ) {
+        in_string = true;
+      }
+      else if( *p == '}' ) {
+        return p;
+      }
+    }
+    return nullptr;
+  };
+
+  auto fail = [&] ( const string &message ) {
+    throw runtime_error( "JSON row " + to_string( rows ) + ": " + message );
+  };
+
+  auto handle = [&] ( const char *first, const char *last ) {
+    // Skip the array punctuation between row objects.
+    const char *p = first;
+    while( p < last && (isSpace( *p ) || *p == '[' || *p == ',' || *p == ']') ) {
+      ++p;
+    }
+    if( p == last ) {
+      return;
+    }
+    rows += 1;
+    if( *p != '{' ) {
+      fail( "expected an object." );
+    }
+    ++p;
+
+    builder.beginRow();
+    size_t hint = 0;
+    while( true )
+    {
+      while( p < last && (isSpace( *p ) || *p == ',') ) {
+        ++p;
+      }
+      if( p == last ) {
+        break;
+      }
+      if( *p != '"' ) {
+        fail( "expected a key." );
+      }
+      const char *key_begin = ++p;
+      while( p < last && *p != '"' ) {
+        p += (*p == '\\') ? 2 : 1;
+      }
+      if( p >= last ) {
+        fail( "unterminated key." );
+      }
+      const char *key_end = p++;
+      p = skipSpace( p, last );
+      if( p == last || *p != ':' ) {
+        fail( "expected ':' after key." );
+      }
+      p = skipSpace( p + 1, last );
+
+      if( last - p >= 4 && memcmp( p, "null", 4 ) == 0 ) {
+        p += 4;
+        continue;
+      }
+      double value;
+      if( ! parseNumber( p, last, &value ) ) {
+        fail( "expected a number." );
+      }
+
+      if( options.time_column.compare( 0, string::npos, key_begin, key_end - key_begin ) == 0 ) {
+        builder.setTime( value );
+      }
+      else {
+        size_t channel = builder.findChannel( key_begin, key_end, hint );
+        if( channel == TrackBuilder::npos ) {
+          channel = builder.addChannel( key_begin, key_end );
+        }
+        builder.setValue( channel, value );
+        hint = channel + 1;
+      }
+    }
+    builder.endRow( rows );
+  };
+
+  KeyframeImport result;
+  result.bytes = streamRecords( stream, options.buffer_size, find_end, handle );
+  result.rows = rows;
+  result.channels = builder.finish();
+  return result;
+}
+
+//=================================================
+// Files
+//=================================================
+
+KeyframeImport choreograph::importKeyframes( const std::string &path, const ImportOptions &options )
+{
+  ifstream file( path, ios::binary );
+  if( ! file ) {
+    throw runtime_error( "Unable to open keyframe file: " + path );
+  }
+
+  auto extension = path.substr( path.find_last_of( '.' ) + 1 );
+  for( auto &c : extension ) {
+    c = (char)tolower( c );
+  }
+  if( extension == "json" ) {
+    return importKeyframesJson( file, options );
+  }
+  else if( extension == "csv" ) {
+    return importKeyframesCsv( file, options );
+  }
+  throw runtime_error( "Unknown keyframe file format: " + path );
+}
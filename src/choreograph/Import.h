@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "phrase/Keyframes.hpp"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+///
+/// \file
+/// Streaming import of columnar keyframe data exported from other tools.
+/// Parses CSV and JSON in one pass through a fixed-size buffer and builds KeyframeTracks directly.
+///
+
+namespace choreograph
+{
+
+struct ImportOptions
+{
+  /// Name of the column (CSV) or key (JSON) holding the sample time.
+  /// CSV files without a matching column use their first column.
+  std::string time_column = "time";
+  /// Size of the read buffer in bytes. Each CSV line or JSON row object must fit within it.
+  size_t      buffer_size = 64 * 1024;
+  /// When positive, channels are fit with a KeyframeFitter of this tolerance as they stream in.
+  /// Otherwise every sample becomes a keyframe.
+  double      tolerance = 0;
+};
+
+///
+/// Tracks imported from a columnar file, one per channel.
+///
+struct KeyframeImport
+{
+  struct Channel
+  {
+    std::string             name;
+    /// Time of the channel's first sample. Each track starts at time zero.
+    Time                    start_time = 0;
+    /// Imported track, or nullptr if the channel had no samples.
+    KeyframeTrackRef<float> track;
+  };
+
+  std::vector<Channel>  channels;
+  /// Number of rows parsed.
+  size_t                rows = 0;
+  /// Number of bytes read from the stream.
+  size_t                bytes = 0;
+
+  /// Returns the track for channel \a name, or nullptr if there is none.
+  KeyframeTrackRef<float> getTrack( const std::string &name ) const;
+};
+
+///
+/// Imports CSV with a header row of channel names, e.g.
+///   time,x,y
+///   0.0,1.5,2
+/// Empty fields are treated as missing samples for that channel.
+/// Throws std::runtime_error on malformed input.
+///
+KeyframeImport importKeyframesCsv( std::istream &stream, const ImportOptions &options = ImportOptions() );
+
+///
+/// Imports a JSON array of flat row objects, e.g.
+///   [ { "time": 0.0, "x": 1.5, "y": 2 }, ... ]
+/// Keys may appear in any order; null values are treated as missing samples.
+/// Throws std::runtime_error on malformed input.
+///
+KeyframeImport importKeyframesJson( std::istream &stream, const ImportOptions &options = ImportOptions() );
+
+/// Imports a .csv or .json file, choosing the format by extension.
+/// Throws std::runtime_error if the file can't be opened or parsed.
+KeyframeImport importKeyframes( const std::string &path, const ImportOptions &options = ImportOptions() );
+
+} // namespace choreograph
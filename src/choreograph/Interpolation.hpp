@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "detail/Components.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if ! defined( CHOREOGRAPH_NO_SIMD ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+  #define CHOREOGRAPH_USE_SSE 1
+  #include <emmintrin.h>
+#endif
+
+///
+/// \file
+/// InterpolationTraits describe how Phrases blend and decompose values.
+///
+
+namespace choreograph
+{
+namespace detail
+{
+
+/// Number of floats in T if T is nothing but a packed run of 2, 3 or 4 float components (e.g. glm::vec3), otherwise 0.
+template<typename T, typename Enable = void>
+struct PackedFloats : std::integral_constant<size_t, 0> {};
+
+template<typename T>
+struct PackedFloats<T, typename std::enable_if<(Components<T>::size >= 2)>::type>
+  : std::integral_constant<size_t,
+      (std::is_same<typename Components<T>::ValueT, float>::value && std::is_trivially_copyable<T>::value && sizeof( T ) == Components<T>::size * sizeof( float ))
+      ? Components<T>::size : 0>
+{};
+
+/// Linear interpolation of N floats: out = a + (b - a) * t.
+template<size_t N>
+struct LerpFloats
+{
+  static void apply( const float *a, const float *b, float t, float *out )
+  {
+    for( size_t i = 0; i < N; ++i ) {
+      out[i] = a[i] + (b[i] - a[i]) * t;
+    }
+  }
+};
+
+#if defined( CHOREOGRAPH_USE_SSE )
+
+inline __m128 lerpSSE( __m128 a, __m128 b, float t )
+{
+  return _mm_add_ps( a, _mm_mul_ps( _mm_sub_ps( b, a ), _mm_set1_ps( t ) ) );
+}
+
+inline __m128 load2( const float *p ) { return _mm_castsi128_ps( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( p ) ) ); }
+inline void    store2( float *p, __m128 v ) { _mm_storel_epi64( reinterpret_cast<__m128i*>( p ), _mm_castps_si128( v ) ); }
+
+template<>
+struct LerpFloats<2>
+{
+  static void apply( const float *a, const float *b, float t, float *out )
+  {
+    store2( out, lerpSSE( load2( a ), load2( b ), t ) );
+  }
+};
+
+template<>
+struct LerpFloats<3>
+{
+  static void apply( const float *a, const float *b, float t, float *out )
+  {
+    const __m128 va = _mm_movelh_ps( load2( a ), _mm_load_ss( a + 2 ) );
+    const __m128 vb = _mm_movelh_ps( load2( b ), _mm_load_ss( b + 2 ) );
+    const __m128 r = lerpSSE( va, vb, t );
+    store2( out, r );
+    _mm_store_ss( out + 2, _mm_movehl_ps( r, r ) );
+  }
+};
+
+template<>
+struct LerpFloats<4>
+{
+  static void apply( const float *a, const float *b, float t, float *out )
+  {
+    _mm_storeu_ps( out, lerpSSE( _mm_loadu_ps( a ), _mm_loadu_ps( b ), t ) );
+  }
+};
+
+#endif
+
+/// Component access for types with components; nothing for types without.
+template<typename T, bool HasComponents = (Components<T>::size > 0)>
+struct ComponentTraits
+{
+  static const size_t components = 0;
+};
+
+template<typename T>
+struct ComponentTraits<T, true>
+{
+  using ComponentT = typename Components<T>::ValueT;
+  static const size_t components = Components<T>::size;
+
+  static ComponentT component( const T &value, size_t i ) { return Components<T>::get( value, i ); }
+  static void       setComponent( T &value, size_t i, ComponentT c ) { Components<T>::set( value, i, c ); }
+};
+
+} // namespace detail
+
+///
+/// InterpolationTraits is the customization point for how Phrases interpolate a type.
+/// Provides lerp(), the component count, component access and, for rotations, slerp().
+/// Everything interpolates through lerpT(), which forwards to InterpolationTraits<T>::lerp.
+/// Optionally provides lerpInto( a, b, t, out ), which Phrase::getValueInto() uses to write
+/// straight into existing storage; without it, out is assigned the result of lerpT().
+///
+/// The primary template uses a + (b - a) * t.
+/// Types made of 2, 3 or 4 packed floats (glm, Cinder and most vector libraries) are
+/// interpolated with SSE when available. Define CHOREOGRAPH_NO_SIMD to disable it.
+/// std::vector and std::array of interpolable types interpolate element-wise.
+/// Specialize for your own types, e.g. to slerp quaternions (see CinderSpecialization.hpp)
+/// or to blend a matrix in place.
+///
+template<typename T, typename Enable = void>
+struct InterpolationTraits : detail::ComponentTraits<T>
+{
+  static const bool has_slerp = false;
+  /// True if lerp() is a + (b - a) * t on packed floats, so Timelines may batch it (see BatchEvaluation.h).
+  static const bool linear_floats = std::is_same<T, float>::value;
+
+  /// Only available for types with the required arithmetic operators.
+  template<typename U = T>
+  static auto lerp( const U &a, const U &b, float t ) -> decltype( U( a + (b - a) * t ) ) { return a + (b - a) * t; }
+};
+
+template<typename T>
+struct InterpolationTraits<T, typename std::enable_if<(detail::PackedFloats<T>::value > 0)>::type> : detail::ComponentTraits<T>
+{
+  static const bool has_slerp = false;
+  static const bool linear_floats = true;
+
+  static T lerp( const T &a, const T &b, float t )
+  {
+    const size_t N = detail::PackedFloats<T>::value;
+    float fa[N], fb[N], fo[N];
+    std::memcpy( fa, &a, sizeof( T ) );
+    std::memcpy( fb, &b, sizeof( T ) );
+    detail::LerpFloats<N>::apply( fa, fb, t, fo );
+    T out( a );
+    std::memcpy( &out, fo, sizeof( T ) );
+    return out;
+  }
+};
+
+/// The default templated linear interpolation function.
+/// Forwards to InterpolationTraits<T>::lerp. Phrases, Bounds, Follows, simplify() and Shows all
+/// interpolate through lerpT, so a specialization of lerpT<T> applies to every one of them.
+/// Batch evaluation still assumes a + (b - a) * t for types whose InterpolationTraits set linear_floats.
+template<typename T>
+T lerpT( const T &a, const T &b, float t )
+{
+  return InterpolationTraits<T>::lerp( a, b, t );
+}
+
+namespace detail
+{
+
+template<typename T, typename = void>
+struct has_trait_lerp : std::false_type {};
+template<typename T>
+struct has_trait_lerp<T, void_t<decltype( InterpolationTraits<T>::lerp( std::declval<const T&>(), std::declval<const T&>(), 0.0f ) )>> : std::true_type {};
+
+/// Interpolates with lerpT().
+/// Phrases call this when no lerp function is given, so types without a trait lerp still compile
+/// as long as they always provide one (see traitLerpFn() and requireLerpFn()).
+template<typename T>
+typename std::enable_if<has_trait_lerp<T>::value, T>::type traitLerp( const T &a, const T &b, float t )
+{
+  return lerpT<T>( a, b, t );
+}
+
+template<typename T>
+typename std::enable_if<! has_trait_lerp<T>::value, T>::type traitLerp( const T &/*a*/, const T &/*b*/, float /*t*/ )
+{
+  throw std::logic_error( "Type has no InterpolationTraits<T>::lerp; provide a lerp function." );
+}
+
+/// Default value of Phrases' lerp function arguments: none, so they interpolate with traitLerp().
+/// Default arguments are only instantiated when used, so leaving out the lerp function
+/// for a type without InterpolationTraits<T>::lerp fails to compile.
+template<typename T>
+std::nullptr_t traitLerpFn()
+{
+  static_assert( has_trait_lerp<T>::value, "Type has no InterpolationTraits<T>::lerp; specialize InterpolationTraits or provide a lerp function." );
+  return nullptr;
+}
+
+/// Returns \a fn, throwing std::invalid_argument if it is empty and T has no trait lerp to fall back on.
+template<typename T, typename Fn>
+const Fn& requireLerpFn( const Fn &fn )
+{
+  if( ! fn && ! has_trait_lerp<T>::value ) {
+    throw std::invalid_argument( "Type has no InterpolationTraits<T>::lerp; provide a lerp function." );
+  }
+  return fn;
+}
+
+template<typename T, typename = void>
+struct has_trait_lerp_into : std::false_type {};
+template<typename T>
+struct has_trait_lerp_into<T, void_t<decltype( InterpolationTraits<T>::lerpInto( std::declval<const T&>(), std::declval<const T&>(), 0.0f, std::declval<T&>() ) )>> : std::true_type {};
+
+/// Interpolates into \a out with InterpolationTraits<T>::lerpInto, or assigns traitLerp() if there is none.
+template<typename T>
+typename std::enable_if<has_trait_lerp_into<T>::value>::type traitLerpInto( const T &a, const T &b, float t, T &out )
+{
+  InterpolationTraits<T>::lerpInto( a, b, t, out );
+}
+
+template<typename T>
+typename std::enable_if<! has_trait_lerp_into<T>::value>::type traitLerpInto( const T &a, const T &b, float t, T &out )
+{
+  out = traitLerp( a, b, t );
+}
+
+template<typename T, typename = void>
+struct has_linear_floats : std::false_type {};
+template<typename T>
+struct has_linear_floats<T, void_t<decltype( InterpolationTraits<T>::linear_floats )>> : std::integral_constant<bool, InterpolationTraits<T>::linear_floats> {};
+
+/// Number of floats a Timeline can interpolate in batches for T: 1 for float, 2-4 for packed float vectors,
+/// and 0 for everything else, including packed types whose InterpolationTraits are specialized (e.g. slerped quaternions).
+template<typename T>
+struct BatchFloats : std::integral_constant<size_t, has_linear_floats<T>::value ? (std::is_same<T, float>::value ? 1 : PackedFloats<T>::value) : 0> {};
+
+/// Element-wise interpolation for containers. Containers have no components of their own.
+template<typename C>
+struct ElementwiseLerp
+{
+  static const bool has_slerp = false;
+  static const size_t components = 0;
+
+  static C lerp( const C &a, const C &b, float t )
+  {
+    C out( a );
+    lerpInto( a, b, t, out );
+    return out;
+  }
+
+  /// Blends the elements both containers have in common; \a out must already hold that many.
+  static void lerpInto( const C &a, const C &b, float t, C &out )
+  {
+    const size_t n = std::min( a.size(), b.size() );
+    for( size_t i = 0; i < n; ++i ) {
+      traitLerpInto( a[i], b[i], t, out[i] );
+    }
+  }
+};
+
+} // namespace detail
+
+/// Interpolates std::arrays element-wise.
+template<typename U, size_t N>
+struct InterpolationTraits<std::array<U, N>, typename std::enable_if<detail::has_trait_lerp<U>::value>::type> : detail::ElementwiseLerp<std::array<U, N>>
+{};
+
+/// Interpolates std::vectors element-wise, e.g. blend shape weights.
+/// Vectors of different lengths blend their common prefix and keep the rest of the first vector.
+/// lerpInto() only allocates when \a out is smaller than the first vector.
+template<typename U>
+struct InterpolationTraits<std::vector<U>, typename std::enable_if<detail::has_trait_lerp<U>::value>::type> : detail::ElementwiseLerp<std::vector<U>>
+{
+  static void lerpInto( const std::vector<U> &a, const std::vector<U> &b, float t, std::vector<U> &out )
+  {
+    if( out.size() != a.size() ) {
+      out = a;
+    }
+    detail::ElementwiseLerp<std::vector<U>>::lerpInto( a, b, t, out );
+  }
+};
+
+} // namespace choreograph
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+
+///
+/// \file
+/// Memory accounting for Timelines, Sequences and Phrases.
+///
+
+namespace choreograph
+{
+
+template<typename T>
+class Phrase;
+
+///
+/// Breakdown of the memory held by a Timeline or Sequence, in bytes.
+/// Phrases reachable through several Sequences or meta-Phrases are counted once.
+///
+/// Figures cover objects and the containers they own. Allocator overhead,
+/// shared_ptr control blocks and state captured by callbacks beyond a
+/// std::function's own footprint can't be seen and are not included.
+///
+struct MemoryUsage
+{
+  /// TimelineItem objects (Motions, Cues, nested Timelines), excluding their callbacks.
+  size_t items = 0;
+  /// std::function callbacks held by items, including callback lists.
+  size_t callbacks = 0;
+  /// Control objects created to cancel items.
+  size_t controls = 0;
+  /// Containers of pointers that organize everything else: item lists, Sequence phrase lists, track tables.
+  size_t index = 0;
+  /// Phrases and the storage they own, each Phrase counted once.
+  size_t phrases = 0;
+
+  /// The part of \a phrases also owned from outside what was measured; it stays alive if this is freed.
+  size_t shared_phrases = 0;
+  /// The part of \a phrases referenced only by what was measured.
+  size_t exclusive_phrases = 0;
+  /// Phrase bytes by dynamic type (implementation-defined type names).
+  std::map<std::string, size_t> phrases_by_type;
+
+  size_t item_count = 0;
+  size_t phrase_count = 0;
+
+  /// Returns the sum of all categories.
+  size_t total() const { return items + callbacks + controls + index + phrases; }
+};
+
+///
+/// Walks a graph of TimelineItems, Sequences and Phrases, accumulating MemoryUsage.
+/// Remembers what it has seen so shared objects are counted once.
+/// Used by the accountMemory() overrides of Phrases and TimelineItems.
+///
+class MemoryCounter
+{
+public:
+  /// Counts a TimelineItem of \a object_bytes, \a callback_bytes of which are std::function members.
+  void addItem( size_t object_bytes, size_t callback_bytes = 0 )
+  {
+    _usage.items += object_bytes - callback_bytes;
+    _usage.callbacks += callback_bytes;
+    _usage.item_count += 1;
+  }
+
+  /// Counts data owned by an item that isn't part of the object, such as baked samples.
+  void addItemStorage( size_t bytes ) { _usage.items += bytes; }
+  /// Counts additional callback storage, such as a vector of callbacks.
+  void addCallbacks( size_t bytes ) { _usage.callbacks += bytes; }
+  /// Counts index structures.
+  void addIndex( size_t bytes ) { _usage.index += bytes; }
+
+  /// Counts a control object once, however many items share it.
+  template<typename C>
+  void addControl( const std::shared_ptr<C> &control )
+  {
+    if( control && _seen.insert( control.get() ).second ) {
+      _usage.controls += sizeof( C );
+    }
+  }
+
+  /// Counts \a phrase and, through its accountMemory(), any Phrases it is built from.
+  /// Phrases already counted only have the extra reference noted.
+  template<typename T>
+  void addPhrase( const std::shared_ptr<Phrase<T>> &phrase )
+  {
+    if( ! phrase ) {
+      return;
+    }
+    auto inserted = _phrases.emplace( phrase.get(), PhraseRecord{ phrase.use_count(), 1, 0 } );
+    if( ! inserted.second ) {
+      inserted.first->second.references += 1;
+      return;
+    }
+
+    const size_t bytes = phrase->accountMemory( *this );
+    // Visiting sources may rehash the table, so look the record up again.
+    _phrases[phrase.get()].bytes = bytes;
+
+    _usage.phrases += bytes;
+    _usage.phrases_by_type[typeid( *phrase ).name()] += bytes;
+    _usage.phrase_count += 1;
+  }
+
+  /// Returns the usage counted so far.
+  /// A Phrase is shared if it has owners beyond the references found while counting.
+  MemoryUsage getUsage() const
+  {
+    auto usage = _usage;
+    for( const auto &entry : _phrases ) {
+      const auto &record = entry.second;
+      (record.use_count > record.references ? usage.shared_phrases : usage.exclusive_phrases) += record.bytes;
+    }
+    return usage;
+  }
+
+private:
+  struct PhraseRecord
+  {
+    long   use_count;
+    long   references;
+    size_t bytes;
+  };
+
+  MemoryUsage                                     _usage;
+  std::unordered_set<const void*>                 _seen;
+  std::unordered_map<const void*, PhraseRecord>   _phrases;
+};
+
+} // namespace choreograph
@@ -30,8 +30,11 @@
 #include "TimelineItem.h"
 #include "Sequence.hpp"
 #include "Output.hpp"
+#include "Presentation.h"
 #include "detail/VectorManipulation.hpp"
 
+#include <atomic>
+
 namespace choreograph
 {
 
@@ -42,6 +45,17 @@ namespace choreograph
 template<typename T> class Motion;
 template<typename T> using MotionRef = std::shared_ptr<Motion<T>>;
 
+/// How a looping Motion wraps its playhead at the end of its Sequence.
+enum class LoopMode
+{
+  /// Play once and finish.
+  None,
+  /// Jump back to the loop start and play again.
+  Repeat,
+  /// Reverse playback direction at each end of the loop.
+  PingPong
+};
+
 ///
 /// Motion: Moves a playhead along a Sequence and sends its value to a user-defined output.
 /// Connects a Sequence and an Output.
@@ -53,6 +67,8 @@ public:
   using MotionT       = Motion<T>;
   using SequenceT     = Sequence<T>;
   using Callback      = std::function<void ()>;
+  /// Maps the playhead onto a newly published Sequence. Receives the current time and both Sequences.
+  using RemapFn       = std::function<Time (Time time, const SequenceT &from, const SequenceT &to)>;
 
   Motion() = delete;
 
@@ -82,6 +98,8 @@ public:
   ~Motion()
   {
     disconnect();
+    delete _pending.exchange( nullptr );
+    reclaim();
   }
 
   /// Returns duration of the underlying sequence.
@@ -92,24 +110,52 @@ public:
 
   /// Returns the underlying Sequence sampled for this motion.
   SequenceT&  getSequence() { return _source; }
+  const SequenceT&  getSequence() const { return _source; }
 
   const void* getTarget() const final override { return _target; }
 
   /// Returns the current value of the target.
   T getCurrentValue() const { return *_target; }
 
+  /// Returns the value the target would have after stepping \a dt, without changing time or calling callbacks.
+  T peek( Time dt ) const { return _source.getValue( loopedTime( time() + dt * getPlaybackSpeed(), time() ) ); }
+  /// Writes the value the target would have after stepping \a dt into \a buffer.
+  void peek( Time dt, PresentationBuffer &buffer ) const override;
+
+  /// Writes the interpolation between the Sequence values one step of \a dt ago and now to the target.
+  /// Types without InterpolationTraits<T>::lerp present the current value.
+  void interpolateStep( Time dt, float alpha ) override;
+
+  /// Tests the Sequence's bounds between \a from and \a to, or over the whole loop when looping.
+  /// Motions with callbacks or a pending Sequence are always visible.
+  bool mayBeVisible( const CullTest &cull, Time from, Time to ) const override;
+
   /// Set a function to be called when we reach the end of the sequence. Receives *this as an argument.
-  void setFinishFn( const Callback &c ) { _finish_fn = c; }
+  void setFinishFn( const Callback &c ) { _finish_fn = c; _batch_slot.release(); }
 
   /// Set a function to be called when we start the sequence. Receives *this as an argument.
-  void setStartFn( const Callback &c ) { _start_fn = c; }
+  void setStartFn( const Callback &c ) { _start_fn = c; _batch_slot.release(); }
 
   /// Set a function to be called when we cross the given inflection point. Receives *this as an argument.
   void addInflectionCallback( size_t inflection_point, const Callback &callback );
 
+  /// Loops the Motion forever over its Sequence from the inflection point \a from_inflection to the end.
+  /// The playhead itself wraps at the loop boundary, so evaluation cost and time precision stay
+  /// constant however long the Motion runs. A looping Motion never finishes, so its finish function
+  /// is not called; PingPong reverses the Motion's playback speed at each end.
+  void setLoop( LoopMode mode, size_t from_inflection = 0 ) { _loop_mode = mode; _loop_inflection = from_inflection; _batch_slot.release(); }
+  LoopMode getLoopMode() const { return _loop_mode; }
+
+  /// Set a function to be called each time the playhead wraps around the loop.
+  /// Steps spanning several cycles call it once; getLoopCount() counts every cycle.
+  void setLoopFn( const Callback &c ) { _loop_fn = c; _batch_slot.release(); }
+
+  /// Returns the number of loop cycles completed.
+  uint64_t getLoopCount() const { return _loop_count; }
+
   /// Set a function to be called at each update step of the sequence.
   /// Function will be called immediately after setting the target value.
-  void setUpdateFn( const Callback &c ) { _update_fn = c; }
+  void setUpdateFn( const Callback &c ) { _update_fn = c; _batch_slot.release(); }
 
   /// Update the connected target with the current sequence value.
   /// Calls start/update/finish functions as appropriate if assigned.
@@ -123,6 +169,30 @@ public:
   /// Slices up our underlying Sequence.
   void sliceSequence( Time from, Time to );
 
+  //=================================================
+  // Publishing Sequences from other threads.
+  //=================================================
+
+  /// Hands \a sequence to the Motion from any thread. Never blocks the thread stepping the Motion.
+  /// The Motion installs it at its next update, keeping the current time unless given \a remap.
+  /// A sequence published before the previous one was installed replaces it.
+  /// The Motion must outlive the call; the published Sequence must not be modified after publishing.
+  void publish( SequenceT sequence, const RemapFn &remap = nullptr );
+
+  /// Frees Sequences replaced by published ones. Call from any thread but the one stepping the Motion;
+  /// publish() also calls it, so a steady publisher needs nothing more.
+  void reclaim();
+
+  /// Remap rule that keeps the same fraction of the Sequence played.
+  static Time keepProgress( Time time, const SequenceT &from, const SequenceT &to ) { return from.getDuration() > 0 ? time / from.getDuration() * to.getDuration() : 0; }
+
+  void accountMemory( MemoryCounter &counter ) const override
+  {
+    accountItem( counter, sizeof( *this ), 4 * sizeof( Callback ) );
+    counter.addCallbacks( _inflection_callbacks.capacity() * sizeof( std::pair<int, Callback> ) );
+    _source.accountMemory( counter );
+  }
+
 private:
   SequenceT       _source;
   Output<T>       *_output = nullptr;
@@ -131,8 +201,53 @@ private:
   Callback        _finish_fn;
   Callback        _start_fn;
   Callback        _update_fn;
+  Callback        _loop_fn;
   std::vector<std::pair<int, Callback>>  _inflection_callbacks;
 
+  LoopMode        _loop_mode = LoopMode::None;
+  size_t          _loop_inflection = 0;
+  uint64_t        _loop_count = 0;
+
+  /// A published Sequence and how to map time onto it. After installation, holds the retired Sequence
+  /// and keeps the remap function until reclaim() frees both.
+  struct Pending
+  {
+    Pending( SequenceT &&sequence, const RemapFn &remap ):
+      sequence( std::move( sequence ) ),
+      remap( remap )
+    {}
+
+    SequenceT   sequence;
+    RemapFn     remap;
+    Pending     *next = nullptr;
+  };
+  /// Latest published Sequence not yet installed. Exchanged by publishers and the stepping thread.
+  std::atomic<Pending*>   _pending { nullptr };
+  /// Lock-free stack of retired Sequences, pushed by the stepping thread and drained by reclaim().
+  std::atomic<Pending*>   _retired { nullptr };
+  /// Place in a Timeline's batch evaluation, if any. Released whenever callbacks are added.
+  detail::BatchSlot       _batch_slot;
+
+  /// Installs a published Sequence, if any. Called from update().
+  void installPending();
+
+  /// Calls inflection callbacks for points crossed between \a from and \a to.
+  void callInflections( Time from, Time to );
+  /// Returns where \a t lands on the loop for a playhead coming from \a from.
+  /// Counts the boundaries crossed in \a cycles and sets \a reversed if PingPong ends up turned around.
+  Time loopedTime( Time t, Time from, uint64_t *cycles = nullptr, bool *reversed = nullptr ) const;
+  /// Wraps the playhead around the loop, calling callbacks for the part of the step before the wrap.
+  /// Returns true if it wrapped.
+  bool wrapLoop();
+
+  void interpolateInto( const T &a, const T &b, float t, std::true_type ) { detail::traitLerpInto( a, b, t, *_target ); }
+  void interpolateInto( const T &/*a*/, const T &b, float /*t*/, std::false_type ) { *_target = b; }
+
+protected:
+  /// Queues plain ramps of batchable types for Motions without callbacks.
+  bool gatherBatch( detail::BatchEvaluator &batch ) override;
+
+private:
   /// Sets the output to a different output.
   /// Used by Output<T>'s move assignment and move constructor.
   void setOutput( Output<T> *output );
@@ -151,56 +266,234 @@ private:
 template<typename T>
 void Motion<T>::update()
 {
-  if( _start_fn )
+  installPending();
+
+  const bool wrapped = (_loop_mode != LoopMode::None) && wrapLoop();
+
+  if( _start_fn && ! wrapped )
   {
     if( forward() && time() > 0.0f && previousTime() <= 0.0f ) {
-      _start_fn();
+      detail::invokeCallback( _start_fn );
     }
     else if( backward() && time() < getDuration() && previousTime() >= getDuration() ) {
-      _start_fn();
+      detail::invokeCallback( _start_fn );
     }
   }
 
-  *_target = _source.getValue( time() );
+  _source.getValueInto( time(), *_target );
 
-  if( ! _inflection_callbacks.empty() )
-  {
-    auto points = _source.getInflectionPoints( previousTime(), time() );
-    if( points.first != points.second )
-    {
-      // We just crossed into the second inflection point
-      auto top = std::max( points.first, points.second );
-      auto bottom = std::min( points.first, points.second );
-      for( const auto &fn : _inflection_callbacks )
-      {
-        auto inflection = fn.first;
-        if( inflection > bottom && inflection <= top ) {
-          fn.second();
-        }
-      }
-    }
-  }
+  callInflections( previousTime(), time() );
 
   if( _update_fn )
   {
-    _update_fn();
+    detail::invokeCallback( _update_fn );
   }
 
-  if( _finish_fn )
+  if( _finish_fn && _loop_mode == LoopMode::None )
   {
     if( forward() && time() >= getDuration() && previousTime() < getDuration() ) {
-      _finish_fn();
+      detail::invokeCallback( _finish_fn );
     }
     else if( backward() && time() <= 0.0f && previousTime() > 0.0f ) {
-      _finish_fn();
+      detail::invokeCallback( _finish_fn );
+    }
+  }
+}
+
+template<typename T>
+void Motion<T>::callInflections( Time from, Time to )
+{
+  if( _inflection_callbacks.empty() ) {
+    return;
+  }
+
+  auto points = _source.getInflectionPoints( from, to );
+  if( points.first != points.second )
+  {
+    // We just crossed into the second inflection point
+    // Callbacks store inflection points as int (see sliceSequence()).
+    const int top = (int)std::max( points.first, points.second );
+    const int bottom = (int)std::min( points.first, points.second );
+    for( const auto &fn : _inflection_callbacks )
+    {
+      auto inflection = fn.first;
+      if( inflection > bottom && inflection <= top ) {
+        detail::invokeCallback( fn.second );
+      }
     }
   }
 }
 
+template<typename T>
+Time Motion<T>::loopedTime( Time t, Time from, uint64_t *cycles, bool *reversed ) const
+{
+  if( _loop_mode == LoopMode::None ) {
+    return t;
+  }
+
+  const Time end = _source.getDuration();
+  const Time begin = std::min( _source.getTimeAtInflection( std::min( _loop_inflection, _source.getPhraseCount() ) ), end );
+  const Time length = end - begin;
+  // Past the end going forward, or past the loop start going backward from inside the loop.
+  const bool over = t > end || (t == end && forward());
+  const bool under = from >= begin && (t < begin || (t == begin && backward()));
+  if( length <= 0 || ! (over || under) ) {
+    return t;
+  }
+
+  // Only the overshoot is wrapped, so the cost doesn't grow with the time played.
+  const Time overshoot = over ? t - end : begin - t;
+  const Time turns = std::floor( overshoot / length );
+  const Time remainder = overshoot - turns * length;
+  const bool turned = (_loop_mode == LoopMode::PingPong) && (std::fmod( turns, 2.0 ) == 0);
+  if( cycles ) {
+    *cycles = (uint64_t)turns + 1;
+  }
+  if( reversed ) {
+    *reversed = turned;
+  }
+
+  // Repeat lands the same side it left from the far boundary; PingPong alternates.
+  const bool from_begin = over != turned;
+  return from_begin ? begin + remainder : end - remainder;
+}
+
+template<typename T>
+bool Motion<T>::wrapLoop()
+{
+  uint64_t cycles = 0;
+  bool reversed = false;
+  const Time t = loopedTime( time(), previousTime(), &cycles, &reversed );
+  if( cycles == 0 ) {
+    return false;
+  }
+
+  // Finish the part of the step up to the boundary we crossed, then continue from the one we wrap to.
+  const bool over = time() > previousTime();
+  const Time end = _source.getDuration();
+  const Time begin = _source.getTimeAtInflection( std::min( _loop_inflection, _source.getPhraseCount() ) );
+  callInflections( previousTime(), over ? end : begin );
+
+  if( reversed ) {
+    setPlaybackSpeed( - getPlaybackSpeed() );
+  }
+  const bool from_begin = over != reversed;
+  setLoopedTime( t, from_begin ? begin : end );
+  _loop_count += cycles;
+
+  if( _loop_fn ) {
+    detail::invokeCallback( _loop_fn );
+  }
+  return true;
+}
+
+template<typename T>
+bool Motion<T>::gatherBatch( detail::BatchEvaluator &batch )
+{
+  // Still within the ramp we claimed last time, only the time changes.
+  const Time t = time();
+  const bool pending = _pending.load( std::memory_order_relaxed ) != nullptr;
+  if( ! pending && _batch_slot.covers( &batch, _source.getRevision(), t ) )
+  {
+    batch.touch( _batch_slot, _batch_slot.normalize( t ) );
+    return true;
+  }
+
+  _batch_slot.release();
+  // Callbacks may read the target, so they need it written in order.
+  if( detail::BatchFloats<T>::value == 0 || pending || _start_fn || _update_fn || _finish_fn || ! _inflection_callbacks.empty() || _loop_mode != LoopMode::None ) {
+    return false;
+  }
+
+  Time local_time = 0, start_time = 0;
+  auto phrase = _source.findPhrase( t, &local_time );
+  detail::RampShape<T> shape;
+  if( ! phrase || ! phrase->describeRamp( &shape ) ) {
+    return false;
+  }
+  const bool first = (phrase == _source.findPhrase( 0, &start_time ));
+  const Time begin = first ? 0 : t - local_time;
+  return batch.claim( _batch_slot, shape.ease, *shape.start, *shape.end, _target, (float)phrase->normalizeTime( local_time ), begin, phrase->getDuration(), first, _source.getRevision() );
+}
+
+template<typename T>
+void Motion<T>::peek( Time dt, PresentationBuffer &buffer ) const
+{
+  if( ! cancelled() ) {
+    _source.getValueInto( loopedTime( time() + dt * getPlaybackSpeed(), time() ), buffer.write( _target ) );
+  }
+}
+
+template<typename T>
+void Motion<T>::interpolateStep( Time dt, float alpha )
+{
+  if( cancelled() ) {
+    return;
+  }
+  const T previous = _source.getValue( loopedTime( time() - dt * getPlaybackSpeed(), time() ) );
+  const T current = _source.getValue( time() );
+  interpolateInto( previous, current, alpha, std::integral_constant<bool, detail::has_trait_lerp<T>::value>() );
+}
+
+template<typename T>
+bool Motion<T>::mayBeVisible( const CullTest &cull, Time from, Time to ) const
+{
+  const auto visible = cull.find<T>();
+  if( ! visible || _start_fn || _update_fn || _finish_fn || _loop_fn || ! _inflection_callbacks.empty() || _pending.load( std::memory_order_relaxed ) ) {
+    return true;
+  }
+  return (*visible)( (_loop_mode == LoopMode::None) ? _source.getBounds( from, to ) : _source.getBounds() );
+}
+
+template<typename T>
+void Motion<T>::publish( SequenceT sequence, const RemapFn &remap )
+{
+  auto pending = new Pending( std::move( sequence ), remap );
+  // Whatever we swap out was never seen by the stepping thread, so it is ours to delete.
+  delete _pending.exchange( pending, std::memory_order_acq_rel );
+  reclaim();
+}
+
+template<typename T>
+void Motion<T>::reclaim()
+{
+  auto retired = _retired.exchange( nullptr, std::memory_order_acquire );
+  while( retired ) {
+    auto next = retired->next;
+    delete retired;
+    retired = next;
+  }
+}
+
+template<typename T>
+void Motion<T>::installPending()
+{
+  // A relaxed load keeps the common case to a single read.
+  if( ! _pending.load( std::memory_order_relaxed ) ) {
+    return;
+  }
+  auto pending = _pending.exchange( nullptr, std::memory_order_acquire );
+  if( ! pending ) {
+    return;
+  }
+
+  const Time mapped = pending->remap ? pending->remap( time(), _source, pending->sequence ) : time();
+  // The old Sequence moves into the Pending record, which retires along with its remap function,
+  // so neither is freed here.
+  _source.swap( pending->sequence );
+  if( pending->remap ) {
+    setTime( getStartTime() + mapped );
+  }
+
+  pending->next = _retired.load( std::memory_order_relaxed );
+  while( ! _retired.compare_exchange_weak( pending->next, pending, std::memory_order_release, std::memory_order_relaxed ) ) {}
+}
+
 template<typename T>
 void Motion<T>::addInflectionCallback( size_t inflection_point, const Callback &callback )
 {
   _inflection_callbacks.emplace_back( std::make_pair( (int)inflection_point, callback ) );
+  _batch_slot.release();
 }
 
 template<typename T>
@@ -228,6 +521,8 @@ void Motion<T>::setOutput( Output<T> *output )
      _output->_input = nullptr;
    }
 
+  // The batch writes to the old target.
+  _batch_slot.release();
   _output = output;
   _target = _output->valuePtr();
 }
@@ -240,6 +535,7 @@ void Motion<T>::disconnect()
     _output->_input = nullptr;
     _output = nullptr;
   }
+  _batch_slot.release();
   // Stop evaluation of TimelineItem.
   cancel();
 }
@@ -28,6 +28,10 @@
 #pragma once
 
 #include "TimeType.h"
+#include "Interpolation.hpp"
+#include "MemoryUsage.h"
+#include "BatchEvaluation.h"
+#include "Bounds.hpp"
 
 namespace choreograph
 {
@@ -41,13 +45,26 @@ using PhraseRef = std::shared_ptr<Phrase<T>>;
 template<typename T>
 using PhraseUniqueRef = std::unique_ptr<Phrase<T>>;
 
-/// The default templated linear interpolation function.
-template<typename T>
-T lerpT( const T &a, const T &b, float t )
+namespace detail
+{
+
+/// Counter bumped when a Phrase's values change in place, so bounds cached from it are rebuilt.
+/// Separate from batchEpoch() so batch evaluation doesn't throw away Sequence bounds.
+inline std::atomic<uint64_t>& phraseEpoch()
+{
+  static std::atomic<uint64_t> epoch( 0 );
+  return epoch;
+}
+
+/// Call after changing a Phrase's values in place.
+inline void phraseChanged()
 {
-  return a + (b - a) * t;
+  phraseEpoch().fetch_add( 1, std::memory_order_relaxed );
+  invalidateBatches();
 }
 
+} // namespace detail
+
 ///
 /// A Phrase of motion.
 /// Virtual base class with concept of value and implementation of time.
@@ -73,12 +90,31 @@ public:
   /// Returns the interpolated value at the given time.
   virtual T getValue( Time at_time ) const = 0;
 
+  /// Writes the value at \a at_time into \a out.
+  /// Override to interpolate straight into existing storage, avoiding temporaries and allocation for large types.
+  /// The default assigns getValue().
+  virtual void getValueInto( Time at_time, T &out ) const { out = getValue( at_time ); }
+
   /// Override to provide value at start (and before).
   virtual T getStartValue() const { return getValue( 0 ); }
 
   /// Override to provide value at end (and beyond).
   virtual T getEndValue() const { return getValue( getDuration() ); }
 
+  /// Override to report memory use. Returns the bytes this Phrase owns (itself and its storage)
+  /// and passes any Phrases it is built from to \a counter.
+  /// The default only knows about the Phrase base class.
+  virtual size_t accountMemory( MemoryCounter &/*counter*/ ) const { return sizeof( Phrase<T> ); }
+
+  /// Override if this Phrase is a plain ramp between two stored values with a known ease,
+  /// filling in \a shape and returning true. Lets Timelines evaluate it in batches.
+  virtual bool describeRamp( detail::RampShape<T> * /*shape*/ ) const { return false; }
+
+  /// Override to bound the values this Phrase takes between \a from and \a to, which getBounds()
+  /// has ordered and clamped to [0, duration]. Bounds may be loose, but must contain every value.
+  /// The default knows nothing about the Phrase and returns unbounded Bounds.
+  virtual Bounds<T> calcBounds( Time /*from*/, Time /*to*/ ) const { return Bounds<T>::unbounded(); }
+
   //=================================================
   // Time querying.
   //=================================================
@@ -89,6 +125,18 @@ public:
   /// Returns the duration of this source.
   inline Time getDuration() const { return _duration; }
 
+  /// Returns bounds on the values this Phrase takes between \a from and \a to.
+  Bounds<T> getBounds( Time from, Time to ) const
+  {
+    if( to < from ) {
+      std::swap( from, to );
+    }
+    return calcBounds( std::min( std::max( from, Time( 0 ) ), _duration ), std::min( std::max( to, Time( 0 ) ), _duration ) );
+  }
+
+  /// Returns bounds on every value this Phrase takes.
+  Bounds<T> getBounds() const { return calcBounds( 0, _duration ); }
+
   /// Returns the Phrase value at \a time, looping past the end from inflection point to the end.
   /// Relies on the subclass implementation of getValue( t ).
   T getValueWrapped( Time time, Time inflectionPoint = 0.0f ) const { return getValue( wrapTime( time, getDuration(), inflectionPoint ) ); }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PhraseInterner.h"
+
+#include <algorithm>
+
+using namespace choreograph;
+using namespace choreograph::detail;
+
+size_t InternKey::hash() const
+{
+  // FNV-1a over the argument bytes, mixed with the argument types.
+  size_t h = (size_t)14695981039346656037ULL;
+  for( unsigned char c : _bytes ) {
+    h = (h ^ c) * (size_t)1099511628211ULL;
+  }
+  for( const auto &type : _types ) {
+    h ^= type.hash_code() + 0x9e3779b9 + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+std::shared_ptr<void> PhraseInterner::find( const InternKey &key, size_t phrase_size )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _stats.requests += 1;
+
+  auto iter = _table.find( key );
+  if( iter == _table.end() ) {
+    return nullptr;
+  }
+
+  auto phrase = iter->second.lock();
+  if( phrase ) {
+    _stats.shared += 1;
+    _stats.bytes_saved += phrase_size;
+  }
+  return phrase;
+}
+
+void PhraseInterner::insert( InternKey &&key, const std::shared_ptr<void> &phrase )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  // Another thread may have inserted an equal Phrase meanwhile; the newest one wins.
+  _table[std::move( key )] = phrase;
+
+  if( _table.size() >= _purge_threshold ) {
+    purgeLocked();
+    _purge_threshold = std::max<size_t>( 64, _table.size() * 2 );
+  }
+}
+
+void PhraseInterner::countUnkeyable()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _stats.requests += 1;
+  _stats.unkeyable += 1;
+}
+
+InternStats PhraseInterner::getStats() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  auto stats = _stats;
+  stats.entries = 0;
+  for( const auto &entry : _table ) {
+    if( ! entry.second.expired() ) {
+      stats.entries += 1;
+    }
+  }
+  return stats;
+}
+
+void PhraseInterner::resetStats()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _stats = InternStats();
+}
+
+void PhraseInterner::purge()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  purgeLocked();
+}
+
+void PhraseInterner::clear()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _table.clear();
+  _purge_threshold = 64;
+}
+
+void PhraseInterner::purgeLocked()
+{
+  for( auto iter = _table.begin(); iter != _table.end(); ) {
+    if( iter->second.expired() ) {
+      iter = _table.erase( iter );
+    }
+    else {
+      ++iter;
+    }
+  }
+}
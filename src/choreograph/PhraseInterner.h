@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimeType.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+///
+/// \file
+/// PhraseInterner shares one allocation between identical immutable Phrases.
+///
+
+namespace choreograph
+{
+
+class PhraseInterner;
+using PhraseInternerRef = std::shared_ptr<PhraseInterner>;
+
+namespace detail
+{
+
+///
+/// Identity of a Phrase: its type and the constructor arguments that produced it.
+/// Arguments contribute their type and, where that alone doesn't determine their
+/// behavior, their bytes. Arguments whose identity can't be known (e.g. a std::function
+/// wrapping a stateful functor) make the key unusable, and the Phrase is not shared.
+///
+class InternKey
+{
+public:
+  explicit InternKey( std::type_index phrase_type ):
+    _types( 1, phrase_type )
+  {}
+
+  /// Adds an argument to the key. Returns false if its identity can't be determined.
+  template<typename V>
+  bool append( const V &value ) { return appendArgument( value, 0 ); }
+
+  size_t hash() const;
+  bool   operator==( const InternKey &rhs ) const { return _types == rhs._types && _bytes == rhs._bytes; }
+
+private:
+  std::vector<std::type_index> _types;
+  std::string                  _bytes;
+
+  void appendBytes( const void *data, size_t size ) { _bytes.append( static_cast<const char*>( data ), size ); }
+
+  // Wrapped functions are identified by their target, if it is a plain function pointer.
+  template<typename R, typename... A>
+  bool appendArgument( const std::function<R (A...)> &fn, int )
+  {
+    using Pointer = R (*)(A...);
+    _types.emplace_back( typeid( fn ) );
+    if( ! fn ) {
+      return true;
+    }
+    const Pointer *target = fn.template target<Pointer>();
+    if( target ) {
+      appendBytes( target, sizeof( Pointer ) );
+    }
+    return target != nullptr;
+  }
+
+  // Stateless functors (the Ease structs, captureless lambdas) are identified by type alone.
+  // Trivially copyable values (numbers, vectors, function pointers, functors with parameters) add their bytes.
+  // Comparing bytes may miss equal values that differ in padding or sign of zero; that only costs sharing.
+  template<typename V>
+  bool appendArgument( const V &value, long )
+  {
+    _types.emplace_back( typeid( V ) );
+    if( std::is_empty<V>::value ) {
+      return true;
+    }
+    if( std::is_trivially_copyable<V>::value ) {
+      appendBytes( &value, sizeof( V ) );
+      return true;
+    }
+    return false;
+  }
+};
+
+struct InternKeyHash
+{
+  size_t operator()( const InternKey &key ) const { return key.hash(); }
+};
+
+} // namespace detail
+
+///
+/// Counters describing how well a PhraseInterner deduplicates.
+///
+struct InternStats
+{
+  /// Number of Phrases requested through the interner.
+  size_t requests = 0;
+  /// Requests answered with an existing Phrase.
+  size_t shared = 0;
+  /// Requests whose arguments couldn't be keyed, so a new Phrase was always made.
+  size_t unkeyable = 0;
+  /// Distinct Phrases currently alive in the table.
+  size_t entries = 0;
+  /// Approximate bytes of Phrase objects not allocated thanks to sharing.
+  size_t bytes_saved = 0;
+
+  /// Returns the fraction of requests that were answered with an existing Phrase.
+  double dedupRate() const { return requests ? (double)shared / requests : 0.0; }
+};
+
+///
+/// PhraseInterner hash-conses Phrases: requesting a Phrase with the same type,
+/// duration, values and ease as a living one returns the existing Phrase.
+///
+/// Give an interner to a Sequence (or to a Timeline, which passes it to the
+/// Sequences it creates) and Sequence::then<PhraseT>() will build Phrases through it.
+/// Shared Phrases must be treated as immutable; don't call setters such as
+/// RampTo::setEndValue on a Phrase that came from an interner.
+///
+/// The interner only holds weak references, so Phrases are freed as soon as the
+/// last Sequence using them goes away. Safe to use from multiple threads.
+///
+class PhraseInterner
+{
+public:
+  /// Returns a PhraseT constructed from \a args, or an existing one made from equal arguments.
+  template<typename PhraseT, typename... Args>
+  std::shared_ptr<PhraseT> make( Args&&... args );
+
+  /// Returns the current deduplication statistics.
+  InternStats getStats() const;
+  /// Resets request counters. Does not forget existing Phrases.
+  void        resetStats();
+
+  /// Removes table entries whose Phrases have been destroyed.
+  void purge();
+  /// Forgets every Phrase. Existing Phrases stay valid but will no longer be shared.
+  void clear();
+
+private:
+  using Table = std::unordered_map<detail::InternKey, std::weak_ptr<void>, detail::InternKeyHash>;
+
+  mutable std::mutex  _mutex;
+  Table               _table;
+  size_t              _purge_threshold = 64;
+  InternStats         _stats;
+
+  /// Returns the living Phrase stored for \a key, if any. Counts the request.
+  std::shared_ptr<void> find( const detail::InternKey &key, size_t phrase_size );
+  /// Stores \a phrase for \a key, purging dead entries as the table grows.
+  void insert( detail::InternKey &&key, const std::shared_ptr<void> &phrase );
+  void countUnkeyable();
+  void purgeLocked();
+
+  template<typename... Args>
+  static bool appendAll( detail::InternKey &key, const Args&... args )
+  {
+    bool keyable = true;
+    // Expand in order; initializer lists guarantee left-to-right evaluation.
+    const bool results[] = { true, (keyable = key.append( args ) && keyable)... };
+    (void)results;
+    return keyable;
+  }
+};
+
+//=================================================
+// PhraseInterner Template Implementation.
+//=================================================
+
+template<typename PhraseT, typename... Args>
+std::shared_ptr<PhraseT> PhraseInterner::make( Args&&... args )
+{
+  detail::InternKey key( typeid( PhraseT ) );
+  if( ! appendAll( key, args... ) ) {
+    countUnkeyable();
+    return std::make_shared<PhraseT>( std::forward<Args>( args )... );
+  }
+
+  auto existing = find( key, sizeof( PhraseT ) );
+  if( existing ) {
+    // The key includes the Phrase type, so the stored object is a PhraseT.
+    return std::static_pointer_cast<PhraseT>( existing );
+  }
+
+  auto phrase = std::make_shared<PhraseT>( std::forward<Args>( args )... );
+  insert( std::move( key ), phrase );
+  return phrase;
+}
+
+} // namespace choreograph
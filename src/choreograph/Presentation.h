@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimeType.h"
+#include "Output.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace choreograph
+{
+
+namespace detail
+{
+
+struct PresentedValueBase
+{
+  virtual ~PresentedValueBase() = default;
+  virtual size_t size() const = 0;
+};
+
+template<typename T>
+struct PresentedValue : public PresentedValueBase
+{
+  explicit PresentedValue( const T &value ): value( value ) {}
+  size_t size() const override { return sizeof( *this ); }
+
+  T value;
+};
+
+} // namespace detail
+
+///
+/// Values predicted for presentation, separate from the Outputs a Timeline drives.
+///
+/// Fill one with Timeline::present() just before rendering, passing the time until the frame
+/// will be displayed, then read values through get(). Simulation time and Outputs are untouched,
+/// so animation appears in step with input that was processed a vsync or two before display.
+///
+/// Values are stored per target and reused between frames, so steady-state presents don't allocate.
+/// Targets without a prediction this frame (no Motion, or an item that can't peek) read their current value.
+///
+class PresentationBuffer
+{
+public:
+  /// Starts a new frame; values written before are no longer returned.
+  void beginFrame() { _frame += 1; }
+
+  /// Returns storage for the predicted value of \a target, initialized to the target's value on first use.
+  template<typename T>
+  T& write( const T *target );
+
+  /// Returns the predicted value of \a target this frame, or nullptr if there is none.
+  template<typename T>
+  const T* find( const T *target ) const;
+  template<typename T>
+  const T* find( const Output<T> *output ) const { return find( output->valuePtr() ); }
+
+  /// Returns the predicted value of \a target this frame, or its current value if there is none.
+  template<typename T>
+  const T& get( const T *target ) const { auto value = find( target ); return value ? *value : *target; }
+  template<typename T>
+  const T& get( const Output<T> &output ) const { return get( output.valuePtr() ); }
+
+  /// Returns the number of targets with storage, predicted this frame or not.
+  size_t size() const { return _entries.size(); }
+  /// Drops all storage.
+  void clear() { _entries.clear(); _index.clear(); }
+
+  /// Returns the bytes owned by the buffer and its values.
+  size_t getStorageSize() const;
+
+private:
+  struct Entry
+  {
+    std::unique_ptr<detail::PresentedValueBase> value;
+    const std::type_info                        *type;
+    uint64_t                                    frame;
+  };
+
+  std::vector<Entry>                            _entries;
+  std::unordered_map<const void*, size_t>       _index;
+  uint64_t                                      _frame = 1;
+};
+
+//=================================================
+// PresentationBuffer Template Implementation.
+//=================================================
+
+template<typename T>
+T& PresentationBuffer::write( const T *target )
+{
+  auto iter = _index.find( target );
+  if( iter == _index.end() || *_entries[iter->second].type != typeid( T ) )
+  {
+    // A new target, or a reused address now holding a different type.
+    Entry entry{ std::unique_ptr<detail::PresentedValueBase>( new detail::PresentedValue<T>( *target ) ), &typeid( T ), _frame };
+    if( iter == _index.end() ) {
+      _index[target] = _entries.size();
+      _entries.push_back( std::move( entry ) );
+    }
+    else {
+      _entries[iter->second] = std::move( entry );
+    }
+    return static_cast<detail::PresentedValue<T>&>( *_entries[_index[target]].value ).value;
+  }
+
+  auto &entry = _entries[iter->second];
+  entry.frame = _frame;
+  return static_cast<detail::PresentedValue<T>&>( *entry.value ).value;
+}
+
+template<typename T>
+const T* PresentationBuffer::find( const T *target ) const
+{
+  auto iter = _index.find( target );
+  if( iter == _index.end() ) {
+    return nullptr;
+  }
+  const auto &entry = _entries[iter->second];
+  if( entry.frame != _frame || *entry.type != typeid( T ) ) {
+    return nullptr;
+  }
+  return &static_cast<const detail::PresentedValue<T>&>( *entry.value ).value;
+}
+
+} // namespace choreograph
@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Recording.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+const char      kMagic[4] = { 'C', 'H', 'R', 'C' };
+const uint32_t  kVersion = 1;
+/// Frames between RecordingPlayer checkpoints.
+const size_t    kCheckpointInterval = 32;
+const size_t    kNoEntry = numeric_limits<size_t>::max();
+
+enum RecordTag : uint8_t
+{
+  ChannelTag = 1,
+  FrameTag = 2
+};
+
+template<typename T>
+void append( vector<uint8_t> *bytes, const T &value )
+{
+  auto begin = reinterpret_cast<const uint8_t*>( &value );
+  bytes->insert( bytes->end(), begin, begin + sizeof( T ) );
+}
+
+/// Bounds-checked reader over a loaded file.
+class Reader
+{
+public:
+  explicit Reader( const vector<uint8_t> &bytes ):
+    _bytes( bytes )
+  {}
+
+  template<typename T>
+  T read()
+  {
+    T value;
+    std::memcpy( &value, skip( sizeof( T ) ), sizeof( T ) );
+    return value;
+  }
+
+  const uint8_t* skip( size_t count )
+  {
+    if( _position + count > _bytes.size() ) {
+      throw runtime_error( "Recording is truncated." );
+    }
+    auto data = _bytes.data() + _position;
+    _position += count;
+    return data;
+  }
+
+  bool done() const { return _position >= _bytes.size(); }
+  size_t position() const { return _position; }
+
+private:
+  const vector<uint8_t> &_bytes;
+  size_t                _position = 0;
+};
+
+} // namespace
+
+//=================================================
+// Recording
+//=================================================
+
+Recording Recording::load( const string &path )
+{
+  ifstream file( path, ios::binary );
+  if( ! file ) {
+    throw runtime_error( "Unable to open recording: " + path );
+  }
+  vector<uint8_t> bytes( (istreambuf_iterator<char>( file )), istreambuf_iterator<char>() );
+
+  Reader reader( bytes );
+  if( std::memcmp( reader.skip( sizeof( kMagic ) ), kMagic, sizeof( kMagic ) ) != 0 || reader.read<uint32_t>() != kVersion ) {
+    throw runtime_error( "Not a Choreograph recording: " + path );
+  }
+
+  Recording recording;
+  recording._payload.reserve( bytes.size() );
+  while( ! reader.done() )
+  {
+    auto tag = reader.read<uint8_t>();
+    if( tag == ChannelTag )
+    {
+      auto id = reader.read<uint32_t>();
+      auto size = reader.read<uint32_t>();
+      auto name_length = reader.read<uint16_t>();
+      auto name = reinterpret_cast<const char*>( reader.skip( name_length ) );
+      if( id != recording._channels.size() ) {
+        throw runtime_error( "Recording channels are out of order." );
+      }
+      recording._channels.push_back( Channel{ string( name, name_length ), size } );
+    }
+    else if( tag == FrameTag )
+    {
+      Frame frame;
+      frame.time = reader.read<Time>();
+      frame.begin = recording._entries.size();
+      auto value_count = reader.read<uint32_t>();
+      auto event_count = reader.read<uint32_t>();
+      for( uint32_t i = 0; i < value_count + event_count; ++i )
+      {
+        auto id = reader.read<uint32_t>();
+        if( id >= recording._channels.size() || recording._channels[id].isEvent() != (i >= value_count) ) {
+          throw runtime_error( "Recording refers to an unknown channel." );
+        }
+        auto size = recording._channels[id].size;
+        recording._entries.push_back( Entry{ id, recording._payload.size() } );
+        auto data = reader.skip( size );
+        recording._payload.insert( recording._payload.end(), data, data + size );
+      }
+      frame.end = recording._entries.size();
+      recording._frames.push_back( frame );
+    }
+    else
+    {
+      throw runtime_error( "Unknown record in recording: " + path );
+    }
+  }
+
+  return recording;
+}
+
+int Recording::findChannel( const string &name ) const
+{
+  for( size_t i = 0; i < _channels.size(); ++i ) {
+    if( _channels[i].name == name ) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+size_t Recording::getStorageSize() const
+{
+  size_t bytes = _channels.capacity() * sizeof( Channel ) + _frames.capacity() * sizeof( Frame ) + _entries.capacity() * sizeof( Entry ) + _payload.capacity();
+  for( auto &channel : _channels ) {
+    bytes += channel.name.capacity();
+  }
+  return bytes;
+}
+
+//=================================================
+// Recorder
+//=================================================
+
+Recorder::Recorder( const string &path, size_t buffer_size ):
+  _buffer( buffer_size )
+{
+  // Open the file here so failures are reported on the calling thread.
+  auto file = make_shared<ofstream>( path, ios::binary | ios::trunc );
+  if( ! *file ) {
+    throw runtime_error( "Unable to open recording for writing: " + path );
+  }
+
+  _scratch.reserve( 4096 );
+  push( reinterpret_cast<const uint8_t*>( kMagic ), sizeof( kMagic ) );
+  push( reinterpret_cast<const uint8_t*>( &kVersion ), sizeof( kVersion ) );
+
+  _writer = thread( [this, file] {
+    vector<uint8_t> chunk( 64 * 1024 );
+    while( true )
+    {
+      // Read the flag before draining so nothing pushed before close() is missed.
+      bool writing = _writing.load();
+      auto count = _buffer.read( chunk.data(), chunk.size() );
+      if( count > 0 ) {
+        file->write( reinterpret_cast<const char*>( chunk.data() ), count );
+      }
+      else if( writing ) {
+        this_thread::sleep_for( chrono::milliseconds( 1 ) );
+      }
+      else {
+        break;
+      }
+    }
+    file->close();
+  } );
+}
+
+Recorder::~Recorder()
+{
+  close();
+}
+
+void Recorder::close()
+{
+  if( _closed ) {
+    return;
+  }
+  _closed = true;
+  _writing = false;
+  _writer.join();
+}
+
+void Recorder::push( const uint8_t *data, size_t bytes )
+{
+  _stats.bytes += bytes;
+  while( bytes > 0 )
+  {
+    auto written = _buffer.write( data, bytes );
+    data += written;
+    bytes -= written;
+    if( bytes > 0 ) {
+      // Buffer is full; give the writer a chance to drain it.
+      _stats.stalls += 1;
+      this_thread::yield();
+    }
+  }
+}
+
+void Recorder::writeDeclaration( uint32_t id, uint32_t size, const string &name )
+{
+  _scratch.clear();
+  append( &_scratch, ChannelTag );
+  append( &_scratch, id );
+  append( &_scratch, size );
+  append( &_scratch, (uint16_t)name.size() );
+  _scratch.insert( _scratch.end(), name.begin(), name.end() );
+  push( _scratch.data(), _scratch.size() );
+}
+
+void Recorder::addValueChannel( const string &name, const void *source, size_t size )
+{
+  writeDeclaration( _channel_count, (uint32_t)size, name );
+  _channels.push_back( Channel{ static_cast<const uint8_t*>( source ), size, _shadow.size(), false } );
+  _shadow.resize( _shadow.size() + size );
+  _channel_count += 1;
+}
+
+uint32_t Recorder::addEvent( const string &name )
+{
+  auto id = _channel_count;
+  writeDeclaration( id, 0, name );
+  // Events occupy a channel id but are not sampled.
+  _channels.push_back( Channel{ nullptr, 0, 0, false } );
+  _channel_count += 1;
+  return id;
+}
+
+void Recorder::recordEvent( uint32_t event_id )
+{
+  _events.push_back( event_id );
+}
+
+function<void ()> Recorder::wrapCue( const string &name, const function<void ()> &fn )
+{
+  auto id = addEvent( name );
+  return [this, id, fn] {
+    recordEvent( id );
+    if( fn ) {
+      fn();
+    }
+  };
+}
+
+void Recorder::capture( Time time )
+{
+  _scratch.clear();
+  append( &_scratch, FrameTag );
+  append( &_scratch, time );
+  const auto counts = _scratch.size();
+  append( &_scratch, uint32_t( 0 ) );
+  append( &_scratch, (uint32_t)_events.size() );
+
+  uint32_t changed = 0;
+  for( uint32_t id = 0; id < _channels.size(); ++id )
+  {
+    auto &channel = _channels[id];
+    if( channel.source == nullptr ) {
+      continue;
+    }
+
+    auto shadow = &_shadow[channel.shadow_offset];
+    if( channel.recorded && std::memcmp( shadow, channel.source, channel.size ) == 0 ) {
+      continue;
+    }
+
+    std::memcpy( shadow, channel.source, channel.size );
+    channel.recorded = true;
+    append( &_scratch, id );
+    _scratch.insert( _scratch.end(), shadow, shadow + channel.size );
+    changed += 1;
+  }
+  std::memcpy( &_scratch[counts], &changed, sizeof( changed ) );
+
+  for( auto id : _events ) {
+    append( &_scratch, id );
+  }
+  _events.clear();
+
+  push( _scratch.data(), _scratch.size() );
+  _stats.frames += 1;
+}
+
+//=================================================
+// RecordingPlayer
+//=================================================
+
+RecordingPlayer::RecordingPlayer( const Recording &recording ):
+  _recording( recording ),
+  _bindings( recording.getChannels().size() )
+{
+  buildCheckpoints();
+}
+
+void RecordingPlayer::buildCheckpoints()
+{
+  const auto &frames = _recording.getFrames();
+  const auto &entries = _recording.getEntries();
+  vector<size_t> latest( _recording.getChannels().size(), kNoEntry );
+  for( size_t f = 0; f < frames.size(); ++f )
+  {
+    if( f % kCheckpointInterval == 0 ) {
+      _checkpoints.insert( _checkpoints.end(), latest.begin(), latest.end() );
+    }
+    for( size_t i = frames[f].begin; i < frames[f].end; ++i ) {
+      latest[entries[i].channel] = i;
+    }
+  }
+}
+
+void RecordingPlayer::seekBackward( size_t frame )
+{
+  const auto &channels = _recording.getChannels();
+  const auto &entries = _recording.getEntries();
+  if( _checkpoints.empty() ) {
+    _next_frame = 0;
+    return;
+  }
+  const size_t checkpoint = min( frame / kCheckpointInterval, _checkpoints.size() / channels.size() - 1 );
+  const size_t *row = _checkpoints.data() + checkpoint * channels.size();
+  for( size_t c = 0; c < channels.size(); ++c ) {
+    if( row[c] != kNoEntry && _bindings[c].target ) {
+      std::memcpy( _bindings[c].target, _recording.getPayload( entries[row[c]] ), channels[c].size );
+    }
+  }
+  _next_frame = checkpoint * kCheckpointInterval;
+}
+
+bool RecordingPlayer::bindValue( const string &name, void *target, size_t size )
+{
+  auto index = _recording.findChannel( name );
+  if( index < 0 || _recording.getChannels()[index].size != size ) {
+    return false;
+  }
+  _bindings[index].target = static_cast<uint8_t*>( target );
+  return true;
+}
+
+bool RecordingPlayer::bindEvent( const string &name, const function<void ()> &fn )
+{
+  auto index = _recording.findChannel( name );
+  if( index < 0 || ! _recording.getChannels()[index].isEvent() ) {
+    return false;
+  }
+  _bindings[index].event = fn;
+  return true;
+}
+
+void RecordingPlayer::applyFrame( const Recording::Frame &frame, bool fire_events )
+{
+  const auto &entries = _recording.getEntries();
+  const auto &channels = _recording.getChannels();
+  for( size_t i = frame.begin; i < frame.end; ++i )
+  {
+    const auto &entry = entries[i];
+    const auto &binding = _bindings[entry.channel];
+    if( channels[entry.channel].isEvent() ) {
+      if( fire_events && binding.event ) {
+        detail::invokeCallback( binding.event );
+      }
+    }
+    else if( binding.target ) {
+      std::memcpy( binding.target, _recording.getPayload( entry ), channels[entry.channel].size );
+    }
+  }
+}
+
+void RecordingPlayer::update()
+{
+  const auto &frames = _recording.getFrames();
+  bool fire_events = true;
+  if( time() < previousTime() ) {
+    // Frames only hold changes, so rebuild the state from the checkpoint before the target frame.
+    auto target = upper_bound( frames.begin(), frames.begin() + _next_frame, time(), [] ( Time t, const Recording::Frame &frame ) {
+      return t < frame.time;
+    } );
+    seekBackward( target - frames.begin() );
+    fire_events = false;
+  }
+
+  while( _next_frame < frames.size() && frames[_next_frame].time <= time() ) {
+    applyFrame( frames[_next_frame], fire_events );
+    _next_frame += 1;
+  }
+}
+
+void RecordingPlayer::accountMemory( MemoryCounter &counter ) const
+{
+  accountItem( counter, sizeof( *this ) );
+  counter.addItemStorage( _recording.getStorageSize() + _checkpoints.capacity() * sizeof( size_t ) );
+  counter.addCallbacks( _bindings.capacity() * sizeof( Binding ) );
+}
+
+//=================================================
+// Recording comparison
+//=================================================
+
+namespace
+{
+
+/// Channel state of a recording being walked frame by frame, indexed by shared channel names.
+struct ReplayState
+{
+  ReplayState( const Recording &recording, const vector<string> &names ):
+    recording( recording ),
+    values( names.size() ),
+    mapping( recording.getChannels().size() )
+  {
+    for( size_t i = 0; i < mapping.size(); ++i ) {
+      mapping[i] = find( names.begin(), names.end(), recording.getChannels()[i].name ) - names.begin();
+    }
+  }
+
+  /// Applies a frame, collecting fired event names.
+  void apply( const Recording::Frame &frame, vector<size_t> *events )
+  {
+    events->clear();
+    for( size_t i = frame.begin; i < frame.end; ++i )
+    {
+      const auto &entry = recording.getEntries()[i];
+      const auto &channel = recording.getChannels()[entry.channel];
+      if( channel.isEvent() ) {
+        events->push_back( mapping[entry.channel] );
+      }
+      else {
+        auto data = recording.getPayload( entry );
+        values[mapping[entry.channel]].assign( data, data + channel.size );
+      }
+    }
+  }
+
+  const Recording               &recording;
+  vector<vector<uint8_t>>       values;
+  vector<size_t>                mapping;
+};
+
+} // namespace
+
+RecordingDiff choreograph::compareRecordings( const Recording &a, const Recording &b )
+{
+  vector<string> names;
+  for( const auto *recording : { &a, &b } ) {
+    for( const auto &channel : recording->getChannels() ) {
+      if( find( names.begin(), names.end(), channel.name ) == names.end() ) {
+        names.push_back( channel.name );
+      }
+    }
+  }
+
+  RecordingDiff diff;
+  auto mismatch = [&diff] ( Time time, const string &description ) {
+    if( diff.identical ) {
+      diff.identical = false;
+      diff.first_difference = description;
+      diff.first_difference_time = time;
+    }
+  };
+
+  ReplayState state_a( a, names );
+  ReplayState state_b( b, names );
+  vector<size_t> events_a, events_b;
+  const auto &frames_a = a.getFrames();
+  const auto &frames_b = b.getFrames();
+  const auto count = min( frames_a.size(), frames_b.size() );
+
+  for( size_t i = 0; i < count; ++i )
+  {
+    const auto &fa = frames_a[i];
+    const auto &fb = frames_b[i];
+    state_a.apply( fa, &events_a );
+    state_b.apply( fb, &events_b );
+    diff.frames_compared += 1;
+
+    bool frame_matches = true;
+    if( std::memcmp( &fa.time, &fb.time, sizeof( Time ) ) != 0 ) {
+      mismatch( fa.time, "Frame " + to_string( i ) + " times differ." );
+      frame_matches = false;
+    }
+    if( events_a != events_b ) {
+      mismatch( fa.time, "Frame " + to_string( i ) + " events differ." );
+      frame_matches = false;
+    }
+    for( size_t c = 0; c < names.size(); ++c ) {
+      if( state_a.values[c] != state_b.values[c] ) {
+        mismatch( fa.time, "Frame " + to_string( i ) + " channel \"" + names[c] + "\" differs." );
+        frame_matches = false;
+      }
+    }
+
+    if( ! frame_matches ) {
+      diff.mismatched_frames += 1;
+    }
+  }
+
+  if( frames_a.size() != frames_b.size() ) {
+    mismatch( count > 0 ? frames_a[count - 1].time : 0, "Recordings have different frame counts (" + to_string( frames_a.size() ) + " and " + to_string( frames_b.size() ) + ")." );
+  }
+
+  return diff;
+}
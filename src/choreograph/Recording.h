@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+#include "Output.hpp"
+#include "detail/RingBuffer.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+///
+/// \file
+/// Record-and-replay of Timeline output streams.
+/// A Recorder captures Output values and Cue firings into a compact file,
+/// a RecordingPlayer drives Outputs from that file, and compareRecordings()
+/// reports where two recordings differ.
+///
+
+namespace choreograph
+{
+
+///
+/// In-memory representation of a recording file.
+/// Frames store only the channels whose bytes changed since the previous frame.
+///
+class Recording
+{
+public:
+  struct Channel
+  {
+    std::string name;
+    /// Size of the channel value in bytes. Event channels have size zero.
+    uint32_t    size;
+    bool        isEvent() const { return size == 0; }
+  };
+
+  /// A value change or an event within a frame.
+  struct Entry
+  {
+    uint32_t channel;
+    /// Offset of the value bytes in the payload. Unused for events.
+    size_t   offset;
+  };
+
+  struct Frame
+  {
+    Time   time;
+    /// Range of entries [begin, end) belonging to this frame.
+    size_t begin;
+    size_t end;
+  };
+
+  /// Loads a recording from \a path. Throws std::runtime_error if the file can't be read or is malformed.
+  static Recording load( const std::string &path );
+
+  const std::vector<Channel>& getChannels() const { return _channels; }
+  const std::vector<Frame>&   getFrames() const { return _frames; }
+  const std::vector<Entry>&   getEntries() const { return _entries; }
+  const uint8_t*              getPayload( const Entry &entry ) const { return _payload.data() + entry.offset; }
+
+  /// Returns the index of the channel named \a name, or -1 if there is no such channel.
+  int findChannel( const std::string &name ) const;
+
+  /// Returns the time of the last frame.
+  Time getDuration() const { return _frames.empty() ? 0 : _frames.back().time; }
+
+  /// Returns the bytes held by the channel, frame, entry and payload tables.
+  size_t getStorageSize() const;
+
+private:
+  std::vector<Channel>  _channels;
+  std::vector<Frame>    _frames;
+  std::vector<Entry>    _entries;
+  std::vector<uint8_t>  _payload;
+};
+
+///
+/// Records the values of Outputs and firing of Cues to a file.
+/// Call capture() once per step, after stepping your Timeline.
+/// Encoding happens on the calling thread into a lock-free buffer;
+/// a background thread writes the buffer to disk.
+///
+/// Values are recorded bit-for-bit, so channel types must be trivially copyable.
+/// Files use the native byte order and are meant to be replayed on the same platform.
+///
+class Recorder
+{
+public:
+  struct Stats
+  {
+    size_t frames = 0;
+    /// Bytes handed to the writer thread.
+    size_t bytes = 0;
+    /// Number of times capture() had to wait for the writer thread to free buffer space.
+    size_t stalls = 0;
+  };
+
+  /// Opens \a path for writing. Throws std::runtime_error if the file can't be opened.
+  explicit Recorder( const std::string &path, size_t buffer_size = 1 << 20 );
+  /// Flushes remaining data and closes the file.
+  ~Recorder();
+
+  Recorder( const Recorder &rhs ) = delete;
+  Recorder& operator= ( const Recorder &rhs ) = delete;
+
+  /// Record the value of \a output every frame. Names must be unique within a recording.
+  template<typename T>
+  void addChannel( const std::string &name, const Output<T> *output ) { addChannel( name, output->valuePtr() ); }
+
+  /// Record the value pointed to by \a value every frame. Raw pointer edition.
+  template<typename T>
+  void addChannel( const std::string &name, const T *value );
+
+  /// Declare an event channel and return its id for use with recordEvent().
+  uint32_t addEvent( const std::string &name );
+
+  /// Note that the event \a event_id happened during the current frame.
+  void recordEvent( uint32_t event_id );
+
+  /// Returns a function that records an event named \a name and then calls \a fn.
+  /// Pass the result to Timeline::cue() to record the Cue firing.
+  std::function<void ()> wrapCue( const std::string &name, const std::function<void ()> &fn );
+
+  /// Encodes every channel that changed since the last capture as a frame at \a time.
+  void capture( Time time );
+
+  /// Flushes remaining data, stops the writer thread and closes the file.
+  /// Called automatically on destruction.
+  void close();
+
+  const Stats& getStats() const { return _stats; }
+
+private:
+  struct Channel
+  {
+    const uint8_t *source;
+    size_t        size;
+    /// Offset of the last recorded value in _shadow.
+    size_t        shadow_offset;
+    bool          recorded;
+  };
+
+  std::vector<Channel>      _channels;
+  std::vector<uint8_t>      _shadow;
+  std::vector<uint32_t>     _events;
+  std::vector<uint8_t>      _scratch;
+  uint32_t                  _channel_count = 0;
+  Stats                     _stats;
+
+  detail::RingBuffer        _buffer;
+  std::atomic<bool>         _writing { true };
+  std::thread               _writer;
+  bool                      _closed = false;
+
+  void addValueChannel( const std::string &name, const void *source, size_t size );
+  void writeDeclaration( uint32_t id, uint32_t size, const std::string &name );
+  void push( const uint8_t *data, size_t bytes );
+  void writerLoop( const std::string &path );
+};
+
+///
+/// Plays back a Recording, driving bound Outputs and calling bound event functions.
+/// Add it to a Timeline or step it directly; time maps onto recorded frame times.
+/// Scrubbing backward restores the nearest earlier checkpoint and replays from there without firing events.
+///
+class RecordingPlayer : public TimelineItem
+{
+public:
+  explicit RecordingPlayer( const Recording &recording );
+  /// Loads the recording at \a path. Throws std::runtime_error on failure.
+  explicit RecordingPlayer( const std::string &path ): RecordingPlayer( Recording::load( path ) ) {}
+
+  /// Drive \a output with the channel named \a name. Returns false if there is no matching channel.
+  template<typename T>
+  bool bind( const std::string &name, Output<T> *output ) { return bind( name, output->valuePtr() ); }
+
+  /// Drive \a value with the channel named \a name. Raw pointer edition.
+  template<typename T>
+  bool bind( const std::string &name, T *value );
+
+  /// Call \a fn whenever the event named \a name was recorded. Returns false if there is no matching channel.
+  bool bindEvent( const std::string &name, const std::function<void ()> &fn );
+
+  void update() override;
+  Time getDuration() const override { return _recording.getDuration(); }
+
+  const Recording& getRecording() const { return _recording; }
+
+  void accountMemory( MemoryCounter &counter ) const override;
+
+private:
+  struct Binding
+  {
+    uint8_t                 *target = nullptr;
+    std::function<void ()>  event;
+  };
+
+  Recording             _recording;
+  std::vector<Binding>  _bindings;
+  /// Index of the next frame to apply.
+  size_t                _next_frame = 0;
+  /// For every checkpoint interval, the entry holding each channel's latest value before that frame.
+  /// One row of channel count entries per checkpoint; channels without a value yet hold SIZE_MAX.
+  std::vector<size_t>   _checkpoints;
+
+  bool bindValue( const std::string &name, void *target, size_t size );
+  void applyFrame( const Recording::Frame &frame, bool fire_events );
+  void buildCheckpoints();
+  /// Restores the channel values from before \a frame, leaving _next_frame at or before it.
+  void seekBackward( size_t frame );
+};
+
+///
+/// Result of comparing two recordings.
+///
+struct RecordingDiff
+{
+  bool        identical = true;
+  size_t      frames_compared = 0;
+  size_t      mismatched_frames = 0;
+  /// Description of the first difference found, empty if identical.
+  std::string first_difference;
+  Time        first_difference_time = 0;
+};
+
+/// Compares the channel state and events of two recordings frame by frame.
+/// Channels are matched by name.
+RecordingDiff compareRecordings( const Recording &a, const Recording &b );
+
+//=================================================
+// Template Implementation.
+//=================================================
+
+template<typename T>
+void Recorder::addChannel( const std::string &name, const T *value )
+{
+  static_assert( std::is_trivially_copyable<T>::value, "Recorded values must be trivially copyable." );
+  addValueChannel( name, value, sizeof( T ) );
+}
+
+template<typename T>
+bool RecordingPlayer::bind( const std::string &name, T *value )
+{
+  static_assert( std::is_trivially_copyable<T>::value, "Replayed values must be trivially copyable." );
+  return bindValue( name, value, sizeof( T ) );
+}
+
+} // namespace choreograph
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Phrase.hpp"
+#include "PhraseInterner.h"
 #include "phrase/Hold.hpp"
 #include "phrase/Retime.hpp"
 #include <assert.h>
@@ -137,14 +138,23 @@ public:
   /// Replaces a single Phrase in this Sequence.
   void replacePhraseAtIndex( size_t index, const PhraseRef<T> &phrase ) { splice( index, 1, { phrase } ); }
 
+  /// Exchanges contents with \a other without allocating.
+  void swap( Sequence<T> &other );
+
   /// Returns a shared_ptr to the phrase at the requested index.
   /// Throws an exception if the index provided is out of bounds.
   PhraseRef<T> getPhraseAtIndex( size_t index ) { return _phrases.at( index ); }
+  /// Returns the phrase at the requested index. Const edition.
+  const PhraseRef<T>& getPhraseAtIndex( size_t index ) const { return _phrases.at( index ); }
   /// Returns the phrase at the requested time.
   /// If the time is past duration, returns the last phrase in the Sequence.
   /// If there are no phrases in the sequence, behavior is undefined (asserts in debug builds).
   PhraseRef<T> getPhraseAtTime( Time time );
 
+  /// Returns the Phrase playing at \a time and sets \a local_time to the time within it.
+  /// Returns nullptr outside of [0, duration), where getValue() returns the initial or end value.
+  const Phrase<T>* findPhrase( Time time, Time *local_time ) const;
+
   //
   // Phrase<T> Equivalents.
   //
@@ -152,9 +162,21 @@ public:
   /// Returns the Sequence value at \a atTime.
   T getValue( Time atTime ) const;
 
+  /// Writes the Sequence value at \a atTime into \a out, reusing its storage where the Phrases allow.
+  /// Before the start and past the end, the initial or end value is assigned.
+  void getValueInto( Time atTime, T &out ) const;
+
   /// Returns the Sequence value at \a atTime, wrapped past the end of .
   T getValueWrapped( Time time, Time inflectionPoint = 0.0f ) const { return getValue( wrapTime( time, getDuration(), inflectionPoint ) ); }
 
+  /// Returns bounds on the values the Sequence takes between \a from and \a to, including the
+  /// initial and end values held before and after it. Phrases that can't bound themselves make it unbounded.
+  /// Sequences with many Phrases cache per-Phrase bounds in a segment tree, rebuilt after any change to
+  /// their Phrases, so a query costs O(log n) Phrase lookups. Don't query one Sequence from several threads at once.
+  Bounds<T> getBounds( Time from, Time to ) const;
+  /// Returns bounds on every value the Sequence takes.
+  Bounds<T> getBounds() const { return getBounds( 0, _duration ); }
+
   /// Returns the value at the end of the Sequence.
   T getEndValue() const { return _phrases.empty() ? _initial_value : _phrases.back()->getEndValue(); }
 
@@ -182,11 +204,49 @@ public:
   /// Calculate and return the Sequence duration.
   Time calcDuration() const;
 
+  /// Returns the memory held by this Sequence and its Phrases, counting shared Phrases once.
+  MemoryUsage memoryUsage() const;
+  /// Adds this Sequence's phrase list and Phrases to \a counter.
+  /// Does not count the Sequence object itself, which usually lives inside another object.
+  void accountMemory( MemoryCounter &counter ) const;
+
+  /// Sets an interner that then<PhraseT>() uses to share identical Phrases with other Sequences.
+  /// Pass nullptr to give every new Phrase its own allocation (the default).
+  void setInterner( const PhraseInternerRef &interner ) { _interner = interner; }
+  const PhraseInternerRef& getInterner() const { return _interner; }
+
+  /// Returns a number identifying the current Phrases. Changes whenever Phrases are added or removed,
+  /// and is never shared by Sequences with different Phrases. Copies share their source's revision.
+  uint64_t getRevision() const { return _revision; }
+
 private:
   // Storing shared_ptr's to Phrases requires their duration to be immutable.
   std::vector<PhraseRef<T>> _phrases;
   T                         _initial_value;
   Time                      _duration = 0;
+  PhraseInternerRef         _interner;
+  uint64_t                  _revision = detail::nextRevision();
+
+  /// Phrase start times and full bounds, valid for one revision and phrase epoch.
+  struct BoundsCache
+  {
+    uint64_t                  revision;
+    uint64_t                  epoch;
+    std::vector<Time>         starts;
+    detail::BoundsTree<T>     tree;
+
+    BoundsCache( uint64_t revision, uint64_t epoch, std::vector<Time> &&starts, const std::vector<Bounds<T>> &leaves ):
+      revision( revision ),
+      epoch( epoch ),
+      starts( std::move( starts ) ),
+      tree( leaves )
+    {}
+  };
+  /// Shared between copies, which share the revision it was built for.
+  mutable std::shared_ptr<const BoundsCache>  _bounds_cache;
+
+  /// Returns the bounds cache for the current Phrases, building it if needed.
+  std::shared_ptr<const BoundsCache> boundsCache() const;
 };
 
 //=================================================
@@ -202,6 +262,7 @@ Sequence<T>& Sequence<T>::set( const T &value )
   else {
     then<Hold>( value, 0.0f );
   }
+  _revision = detail::nextRevision();
   return *this;
 }
 
@@ -209,8 +270,14 @@ template<typename T>
 template<template <typename> class PhraseT, typename... Args>
 Sequence<T>& Sequence<T>::then( const T &value, Time duration, Args&&... args )
 {
-  _phrases.emplace_back( std::make_shared<PhraseT<T>>( duration, this->getEndValue(), value, std::forward<Args>(args)... ) );
+  if( _interner ) {
+    _phrases.emplace_back( _interner->template make<PhraseT<T>>( duration, this->getEndValue(), value, std::forward<Args>(args)... ) );
+  }
+  else {
+    _phrases.emplace_back( std::make_shared<PhraseT<T>>( duration, this->getEndValue(), value, std::forward<Args>(args)... ) );
+  }
   _duration += duration;
+  _revision = detail::nextRevision();
 
   return *this;
 }
@@ -220,6 +287,7 @@ Sequence<T>& Sequence<T>::then( const PhraseRef<T> &phrase )
 {
   _phrases.push_back( phrase );
   _duration += phrase->getDuration();
+  _revision = detail::nextRevision();
 
   return *this;
 }
@@ -230,6 +298,7 @@ Sequence<T>& Sequence<T>::then( const Sequence<T> &next )
   auto phrases = next._phrases;
   _phrases.insert( _phrases.end(), phrases.begin(), phrases.end() );
   _duration = calcDuration();
+  _revision = detail::nextRevision();
 
   return *this;
 }
@@ -261,6 +330,26 @@ PhraseRef<T> Sequence<T>::getPhraseAtTime( Time time )
   return _phrases.back();
 }
 
+template<typename T>
+const Phrase<T>* Sequence<T>::findPhrase( Time time, Time *local_time ) const
+{
+  if( time < 0 || time >= this->getDuration() ) {
+    return nullptr;
+  }
+
+  for( const auto &phrase : _phrases )
+  {
+    if( phrase->getDuration() < time ) {
+      time -= phrase->getDuration();
+    }
+    else {
+      *local_time = time;
+      return phrase.get();
+    }
+  }
+  return nullptr;
+}
+
 template<typename T>
 T Sequence<T>::getValue( Time atTime ) const
 {
@@ -287,6 +376,33 @@ T Sequence<T>::getValue( Time atTime ) const
   return getEndValue();
 }
 
+template<typename T>
+void Sequence<T>::getValueInto( Time atTime, T &out ) const
+{
+  if( atTime < 0 )
+  {
+    out = _initial_value;
+    return;
+  }
+  else if ( atTime >= this->getDuration() )
+  {
+    out = getEndValue();
+    return;
+  }
+
+  for( const auto &phrase : _phrases )
+  {
+    if( phrase->getDuration() < atTime ) {
+      atTime -= phrase->getDuration();
+    }
+    else {
+      phrase->getValueInto( atTime, out );
+      return;
+    }
+  }
+  out = getEndValue();
+}
+
 template<typename T>
 Time Sequence<T>::calcDuration() const
 {
@@ -297,6 +413,115 @@ Time Sequence<T>::calcDuration() const
   return sum;
 }
 
+template<typename T>
+void Sequence<T>::swap( Sequence<T> &other )
+{
+  using std::swap;
+  swap( _phrases, other._phrases );
+  swap( _initial_value, other._initial_value );
+  swap( _duration, other._duration );
+  swap( _interner, other._interner );
+  swap( _revision, other._revision );
+  swap( _bounds_cache, other._bounds_cache );
+}
+
+template<typename T>
+Bounds<T> Sequence<T>::getBounds( Time from, Time to ) const
+{
+  if( to < from ) {
+    std::swap( from, to );
+  }
+  if( _phrases.empty() ) {
+    return Bounds<T>( _initial_value );
+  }
+
+  Bounds<T> bounds;
+  if( from < 0 ) {
+    bounds.include( _initial_value );
+  }
+  if( to >= _duration ) {
+    bounds.include( getEndValue() );
+  }
+  from = std::min( std::max( from, Time( 0 ) ), _duration );
+  to = std::min( std::max( to, Time( 0 ) ), _duration );
+
+  // Short Sequences aren't worth a tree.
+  const size_t tree_threshold = 16;
+  if( _phrases.size() < tree_threshold )
+  {
+    Time start = 0;
+    for( const auto &phrase : _phrases )
+    {
+      const Time end = start + phrase->getDuration();
+      if( end >= from && start <= to ) {
+        bounds.include( phrase->getBounds( from - start, to - start ) );
+      }
+      if( start > to ) {
+        break;
+      }
+      start = end;
+    }
+    return bounds;
+  }
+
+  const auto cache = boundsCache();
+  const auto &starts = cache->starts;
+  // Phrases overlapping [from, to] are [first, last]; those strictly inside come from the tree.
+  const size_t first = std::max<size_t>( std::lower_bound( starts.begin(), starts.end(), from ) - starts.begin(), 1 ) - 1;
+  const size_t last = std::max<size_t>( std::upper_bound( starts.begin(), starts.end(), to ) - starts.begin(), 1 ) - 1;
+  bounds.include( _phrases[first]->getBounds( from - starts[first], to - starts[first] ) );
+  if( last > first )
+  {
+    bounds.include( cache->tree.query( first + 1, last ) );
+    bounds.include( _phrases[last]->getBounds( from - starts[last], to - starts[last] ) );
+  }
+  return bounds;
+}
+
+template<typename T>
+std::shared_ptr<const typename Sequence<T>::BoundsCache> Sequence<T>::boundsCache() const
+{
+  const uint64_t epoch = detail::phraseEpoch().load( std::memory_order_relaxed );
+  if( _bounds_cache && _bounds_cache->revision == _revision && _bounds_cache->epoch == epoch ) {
+    return _bounds_cache;
+  }
+
+  std::vector<Time> starts;
+  std::vector<Bounds<T>> leaves;
+  starts.reserve( _phrases.size() );
+  leaves.reserve( _phrases.size() );
+  Time start = 0;
+  for( const auto &phrase : _phrases )
+  {
+    starts.push_back( start );
+    leaves.push_back( phrase->getBounds() );
+    start += phrase->getDuration();
+  }
+  _bounds_cache = std::make_shared<const BoundsCache>( _revision, epoch, std::move( starts ), leaves );
+  return _bounds_cache;
+}
+
+template<typename T>
+MemoryUsage Sequence<T>::memoryUsage() const
+{
+  MemoryCounter counter;
+  counter.addIndex( sizeof( *this ) );
+  accountMemory( counter );
+  return counter.getUsage();
+}
+
+template<typename T>
+void Sequence<T>::accountMemory( MemoryCounter &counter ) const
+{
+  counter.addIndex( _phrases.capacity() * sizeof( PhraseRef<T> ) );
+  if( _bounds_cache ) {
+    counter.addIndex( sizeof( BoundsCache ) + _bounds_cache->starts.capacity() * sizeof( Time ) + 2 * _bounds_cache->tree.size() * sizeof( Bounds<T> ) );
+  }
+  for( const auto &phrase : _phrases ) {
+    counter.addPhrase( phrase );
+  }
+}
+
 template<typename T>
 std::pair<size_t, size_t> Sequence<T>::getInflectionPoints( Time t1, Time t2 ) const
 {
@@ -350,7 +575,9 @@ template<typename T>
 Sequence<T> Sequence<T>::slice( Time from, Time to ) const
 {
   if( _phrases.empty() ) {
-    return Sequence<T>( PhraseRef<T>( std::make_shared<Hold<T>>( to - from, _initial_value ) ) );
+    Sequence<T> hold( PhraseRef<T>( std::make_shared<Hold<T>>( to - from, _initial_value ) ) );
+    hold.setInterner( _interner );
+    return hold;
   }
 
   // the indices of the first and last Phrases in our time range.
@@ -370,11 +597,15 @@ Sequence<T> Sequence<T>::slice( Time from, Time to ) const
     phrases[0] = std::make_shared<ClipPhrase<T>>( first, t1, first->getDuration() );
     phrases[phrases.size() - 1] = std::make_shared<ClipPhrase<T>>( last, 0, t2 );
 
-    return Sequence<T>( phrases );
+    Sequence<T> sliced( phrases );
+    sliced.setInterner( _interner );
+    return sliced;
   }
   else {
     Time t = getTimeAtInflection( points.first );
-    return Sequence<T>( PhraseRef<T>( std::make_shared<ClipPhrase<T>>( first, from - t, to - t ) ) );
+    Sequence<T> sliced( PhraseRef<T>( std::make_shared<ClipPhrase<T>>( first, from - t, to - t ) ) );
+    sliced.setInterner( _interner );
+    return sliced;
   }
 }
 
@@ -392,6 +623,7 @@ void Sequence<T>::splice( size_t start_index, size_t phrases_to_remove, const st
   auto begin = _phrases.begin() + start_index;
   _phrases.insert( begin, phrases_to_insert.begin(), phrases_to_insert.end() );
   _duration = calcDuration();
+  _revision = detail::nextRevision();
 }
 
 //=================================================
@@ -413,9 +645,19 @@ public:
   /// Returns the interpolated value at the given time.
   T getValue( Time atTime ) const override { return _sequence.getValue( atTime ); }
 
+  void getValueInto( Time atTime, T &out ) const override { _sequence.getValueInto( atTime, out ); }
+
   T getStartValue() const override { return _sequence.getStartValue(); }
 
   T getEndValue() const override { return _sequence.getEndValue(); }
+
+  Bounds<T> calcBounds( Time from, Time to ) const override { return _sequence.getBounds( from, to ); }
+
+  size_t accountMemory( MemoryCounter &counter ) const override
+  {
+    _sequence.accountMemory( counter );
+    return sizeof( *this );
+  }
 private:
   Sequence<T>  _sequence;
 };
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SharedMemory.h"
+#include "Timeline.h"
+
+#include <stdexcept>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+  #define CHOREOGRAPH_POSIX_SHM 1
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+const uint32_t SharedFrameMagic = 0x43484652; // "CHFR"
+const uint32_t SharedFrameVersion = 1;
+
+size_t alignUp( size_t bytes, size_t alignment )
+{
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+size_t channelTableOffset()
+{
+  return alignUp( sizeof( detail::SharedFrameHeader ), 16 );
+}
+
+size_t valuesOffset( size_t max_channels )
+{
+  return alignUp( channelTableOffset() + max_channels * sizeof( detail::SharedChannelInfo ), 16 );
+}
+
+string segmentName( const string &name )
+{
+  return (name.empty() || name[0] != '/') ? "/" + name : name;
+}
+
+} // namespace
+
+//=================================================
+// SharedFramePublisher
+//=================================================
+
+SharedFramePublisher::SharedFramePublisher( const string &name, size_t max_channels, size_t value_capacity ):
+  _name( segmentName( name ) )
+{
+#if defined( CHOREOGRAPH_POSIX_SHM )
+  _bytes = valuesOffset( max_channels ) + value_capacity;
+
+  shm_unlink( _name.c_str() );
+  const int fd = shm_open( _name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+  if( fd < 0 ) {
+    throw runtime_error( "Unable to create shared memory segment: " + _name );
+  }
+  if( ftruncate( fd, _bytes ) != 0 ) {
+    close( fd );
+    shm_unlink( _name.c_str() );
+    throw runtime_error( "Unable to size shared memory segment: " + _name );
+  }
+  _memory = mmap( nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( _memory == MAP_FAILED ) {
+    _memory = nullptr;
+    shm_unlink( _name.c_str() );
+    throw runtime_error( "Unable to map shared memory segment: " + _name );
+  }
+
+  auto bytes = static_cast<uint8_t*>( _memory );
+  _header = reinterpret_cast<detail::SharedFrameHeader*>( bytes );
+  _channel_info = reinterpret_cast<detail::SharedChannelInfo*>( bytes + channelTableOffset() );
+  _values = bytes + valuesOffset( max_channels );
+
+  assert( _header->sequence.is_lock_free() );
+  _header->abi_version = SharedFrameVersion;
+  _header->max_channels = (uint32_t)max_channels;
+  _header->value_capacity = (uint32_t)value_capacity;
+  _header->sequence.store( 0, memory_order_relaxed );
+  _header->layout = 0;
+  _header->channel_count = 0;
+  _header->value_bytes = 0;
+  _header->frame = 0;
+  _header->time = 0;
+  _header->published_ns = 0;
+  // Subscribers check the magic number, so write it once everything else is in place.
+  atomic_thread_fence( memory_order_release );
+  _header->magic = SharedFrameMagic;
+#else
+  throw runtime_error( "Shared memory publishing requires POSIX shared memory." );
+#endif
+}
+
+SharedFramePublisher::~SharedFramePublisher()
+{
+#if defined( CHOREOGRAPH_POSIX_SHM )
+  if( _memory ) {
+    munmap( _memory, _bytes );
+    shm_unlink( _name.c_str() );
+  }
+#endif
+}
+
+void SharedFramePublisher::beginWrite()
+{
+  // Odd while writing. The fence keeps the writes below from moving ahead of it.
+  _header->sequence.store( _header->sequence.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+  atomic_thread_fence( memory_order_release );
+}
+
+void SharedFramePublisher::endWrite()
+{
+  _header->sequence.store( _header->sequence.load( memory_order_relaxed ) + 1, memory_order_release );
+}
+
+size_t SharedFramePublisher::addChannel( const string &name, const void *source, size_t size )
+{
+  if( _channels.size() >= _header->max_channels ) {
+    throw runtime_error( "Shared frame segment " + _name + " has no room for channel " + name + "." );
+  }
+  if( _value_bytes + size > _header->value_capacity ) {
+    throw runtime_error( "Shared frame segment " + _name + " has no room for the value of channel " + name + "." );
+  }
+
+  const size_t index = _channels.size();
+  _channels.push_back( Channel{ source, (uint32_t)size } );
+
+  beginWrite();
+  auto &info = _channel_info[index];
+  memset( info.name, 0, sizeof( info.name ) );
+  strncpy( info.name, name.c_str(), sizeof( info.name ) - 1 );
+  info.offset = _value_bytes;
+  info.size = (uint32_t)size;
+  _value_bytes += (uint32_t)size;
+  _header->channel_count = (uint32_t)_channels.size();
+  _header->value_bytes = _value_bytes;
+  _header->layout = ++_layout;
+  endWrite();
+
+  return index;
+}
+
+void SharedFramePublisher::clear()
+{
+  _channels.clear();
+  _value_bytes = 0;
+
+  beginWrite();
+  _header->channel_count = 0;
+  _header->value_bytes = 0;
+  _header->layout = ++_layout;
+  endWrite();
+}
+
+void SharedFramePublisher::publish( const Timeline &timeline )
+{
+  publish( timeline.time() );
+}
+
+void SharedFramePublisher::publish( Time time )
+{
+  const auto start = detail::monotonicNanoseconds();
+  _frame += 1;
+
+  beginWrite();
+  auto values = _values;
+  for( const auto &channel : _channels ) {
+    memcpy( values, channel.source, channel.size );
+    values += channel.size;
+  }
+  _header->frame = _frame;
+  _header->time = time;
+  _header->published_ns = start;
+  endWrite();
+
+  _publish_latency.add( detail::monotonicNanoseconds() - start );
+}
+
+//=================================================
+// SharedFrameSubscriber
+//=================================================
+
+SharedFrameSubscriber::SharedFrameSubscriber( const string &name )
+{
+#if defined( CHOREOGRAPH_POSIX_SHM )
+  const auto segment = segmentName( name );
+  const int fd = shm_open( segment.c_str(), O_RDONLY, 0 );
+  if( fd < 0 ) {
+    throw runtime_error( "Unable to open shared memory segment: " + segment );
+  }
+  struct stat info;
+  if( fstat( fd, &info ) != 0 || (size_t)info.st_size < sizeof( detail::SharedFrameHeader ) ) {
+    close( fd );
+    throw runtime_error( "Not a Choreograph frame segment: " + segment );
+  }
+  _bytes = info.st_size;
+  _memory = mmap( nullptr, _bytes, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if( _memory == MAP_FAILED ) {
+    _memory = nullptr;
+    throw runtime_error( "Unable to map shared memory segment: " + segment );
+  }
+
+  auto bytes = static_cast<const uint8_t*>( _memory );
+  _header = reinterpret_cast<const detail::SharedFrameHeader*>( bytes );
+  if( _header->magic != SharedFrameMagic || _header->abi_version != SharedFrameVersion || valuesOffset( _header->max_channels ) + _header->value_capacity > _bytes ) {
+    munmap( _memory, _bytes );
+    _memory = nullptr;
+    throw runtime_error( "Not a Choreograph frame segment: " + segment );
+  }
+  atomic_thread_fence( memory_order_acquire );
+  _channel_info = reinterpret_cast<const detail::SharedChannelInfo*>( bytes + channelTableOffset() );
+  _values = bytes + valuesOffset( _header->max_channels );
+  _value_copy.reserve( _header->value_capacity );
+#else
+  throw runtime_error( "Shared memory publishing requires POSIX shared memory." );
+#endif
+}
+
+SharedFrameSubscriber::~SharedFrameSubscriber()
+{
+#if defined( CHOREOGRAPH_POSIX_SHM )
+  if( _memory ) {
+    munmap( _memory, _bytes );
+  }
+#endif
+}
+
+bool SharedFrameSubscriber::read( int max_attempts )
+{
+  const auto start = detail::monotonicNanoseconds();
+  vector<detail::SharedChannelInfo> channels;
+
+  for( int attempt = 0; attempt < max_attempts; ++attempt )
+  {
+    const uint32_t before = _header->sequence.load( memory_order_acquire );
+    if( before & 1 ) {
+      continue;
+    }
+
+    const uint64_t frame = _header->frame;
+    if( frame == _frame ) {
+      return false;
+    }
+    const Time time = _header->time;
+    const int64_t published = _header->published_ns;
+    const uint32_t layout = _header->layout;
+    const uint32_t count = _header->channel_count;
+    const uint32_t value_bytes = _header->value_bytes;
+    if( count > _header->max_channels || value_bytes > _header->value_capacity ) {
+      continue;
+    }
+
+    if( layout != _layout ) {
+      channels.assign( _channel_info, _channel_info + count );
+    }
+    _value_copy.resize( value_bytes );
+    memcpy( _value_copy.data(), _values, value_bytes );
+
+    atomic_thread_fence( memory_order_acquire );
+    if( _header->sequence.load( memory_order_relaxed ) != before ) {
+      continue;
+    }
+
+    if( layout != _layout ) {
+      _channels.swap( channels );
+      _layout = layout;
+    }
+    _frame = frame;
+    _time = time;
+
+    const auto now = detail::monotonicNanoseconds();
+    _read_latency.add( now - start );
+    _frame_age.add( now - published );
+    return true;
+  }
+  return false;
+}
+
+int SharedFrameSubscriber::findChannel( const string &name ) const
+{
+  for( size_t i = 0; i < _channels.size(); ++i ) {
+    if( name == _channels[i].name ) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+#include "Output.hpp"
+#include "TimeType.h"
+#include "detail/Latency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+///
+/// \file
+/// Publishing a Timeline's clock and Output values to other processes through POSIX shared memory.
+///
+
+namespace choreograph
+{
+
+class Timeline;
+
+namespace detail
+{
+
+/// Segment layout shared by publisher and subscriber.
+/// A seqlock guards everything after the immutable fields: the publisher makes sequence odd
+/// while writing and even when done, and readers retry if it changed while they copied.
+struct SharedFrameHeader
+{
+  uint32_t                magic;
+  uint32_t                abi_version;
+  uint32_t                max_channels;
+  uint32_t                value_capacity;
+  std::atomic<uint32_t>   sequence;
+  uint32_t                layout;
+  uint32_t                channel_count;
+  uint32_t                value_bytes;
+  uint64_t                frame;
+  double                  time;
+  int64_t                 published_ns;
+};
+
+struct SharedChannelInfo
+{
+  char      name[48];
+  uint32_t  offset;
+  uint32_t  size;
+};
+
+} // namespace detail
+
+///
+/// SharedFramePublisher writes a clock and a set of Output values into a named POSIX shared memory segment.
+///
+/// Call publish() once per step, after stepping the master Timeline. Each publish writes one
+/// consistent frame under a seqlock; it never blocks on readers and makes no system calls.
+/// Subscribers in other processes read frames with SharedFrameSubscriber and can drive their
+/// own Timelines from the published time instead of their own clocks, so they don't drift.
+///
+/// Published values are copied bytewise, so Output types must be trivially copyable and have
+/// the same layout in every process. The segment is removed when the publisher is destroyed.
+/// Throws std::runtime_error if the segment can't be created, or on platforms without POSIX shared memory.
+///
+class SharedFramePublisher
+{
+public:
+  /// Creates (or recreates) segment \a name with room for \a max_channels Outputs totalling \a value_capacity bytes.
+  explicit SharedFramePublisher( const std::string &name, size_t max_channels = 64, size_t value_capacity = 4096 );
+  ~SharedFramePublisher();
+
+  SharedFramePublisher( const SharedFramePublisher &rhs ) = delete;
+  SharedFramePublisher& operator= ( const SharedFramePublisher &rhs ) = delete;
+
+  /// Publishes \a output under \a name. The Output must stay in place (not be moved or destroyed)
+  /// until the publisher is destroyed or clear() is called.
+  /// Returns the channel index, which subscribers can also find by name.
+  template<typename T>
+  size_t addOutput( const std::string &name, const Output<T> *output );
+
+  /// Removes all channels.
+  void clear();
+
+  /// Publishes \a timeline's current time and every channel's value.
+  void publish( const Timeline &timeline );
+  /// Publishes \a time and every channel's value.
+  void publish( Time time );
+
+  /// Returns the number of frames published.
+  uint64_t getFrameCount() const { return _frame; }
+  /// Returns the number of published channels.
+  size_t getChannelCount() const { return _channels.size(); }
+  /// Returns how long publish() takes.
+  const LatencyStats& getPublishLatency() const { return _publish_latency; }
+
+  const std::string& getName() const { return _name; }
+
+private:
+  struct Channel
+  {
+    const void  *source;
+    uint32_t    size;
+  };
+
+  std::string                   _name;
+  void                          *_memory = nullptr;
+  size_t                        _bytes = 0;
+  detail::SharedFrameHeader     *_header = nullptr;
+  detail::SharedChannelInfo     *_channel_info = nullptr;
+  uint8_t                       *_values = nullptr;
+  std::vector<Channel>          _channels;
+  uint32_t                      _value_bytes = 0;
+  uint32_t                      _layout = 0;
+  uint64_t                      _frame = 0;
+  LatencyStats                  _publish_latency;
+
+  size_t addChannel( const std::string &name, const void *source, size_t size );
+  void   beginWrite();
+  void   endWrite();
+};
+
+///
+/// SharedFrameSubscriber reads frames written by a SharedFramePublisher in another process.
+///
+/// read() copies the latest consistent frame into local storage without system calls or locks;
+/// the accessors then refer to that copy. Tracks how long reads take and how old frames are
+/// when read.
+///
+class SharedFrameSubscriber
+{
+public:
+  /// Opens segment \a name. Throws std::runtime_error if it doesn't exist or isn't a Choreograph frame segment.
+  explicit SharedFrameSubscriber( const std::string &name );
+  ~SharedFrameSubscriber();
+
+  SharedFrameSubscriber( const SharedFrameSubscriber &rhs ) = delete;
+  SharedFrameSubscriber& operator= ( const SharedFrameSubscriber &rhs ) = delete;
+
+  /// Copies the latest frame. Returns true if it is newer than the previous read.
+  /// Returns false if nothing new was published, or the publisher kept writing through every attempt.
+  bool read( int max_attempts = 64 );
+
+  /// Returns the frame number of the last read, starting at 1. Zero until a frame has been read.
+  uint64_t getFrame() const { return _frame; }
+  /// Returns the published time of the last read frame.
+  Time getTime() const { return _time; }
+
+  /// Returns the number of channels in the last read frame.
+  size_t getChannelCount() const { return _channels.size(); }
+  /// Returns the index of the channel called \a name, or -1 if there is none.
+  int findChannel( const std::string &name ) const;
+  /// Returns the name of channel \a index.
+  std::string getChannelName( size_t index ) const { return _channels.at( index ).name; }
+
+  /// Returns the value of channel \a index from the last read frame.
+  /// Throws std::runtime_error if T isn't the size of the published type or the frame doesn't hold the channel.
+  template<typename T>
+  T getValue( size_t index ) const;
+
+  /// Returns how long successful reads take.
+  const LatencyStats& getReadLatency() const { return _read_latency; }
+  /// Returns the time between a frame being published and read.
+  const LatencyStats& getFrameAge() const { return _frame_age; }
+
+private:
+  void                                    *_memory = nullptr;
+  size_t                                  _bytes = 0;
+  const detail::SharedFrameHeader         *_header = nullptr;
+  const detail::SharedChannelInfo         *_channel_info = nullptr;
+  const uint8_t                           *_values = nullptr;
+
+  uint32_t                                _layout = 0;
+  uint64_t                                _frame = 0;
+  Time                                    _time = 0;
+  std::vector<detail::SharedChannelInfo>  _channels;
+  std::vector<uint8_t>                    _value_copy;
+  LatencyStats                            _read_latency;
+  LatencyStats                            _frame_age;
+};
+
+//=================================================
+// Template Implementation.
+//=================================================
+
+template<typename T>
+size_t SharedFramePublisher::addOutput( const std::string &name, const Output<T> *output )
+{
+  static_assert( std::is_trivially_copyable<T>::value, "Shared Outputs must be trivially copyable." );
+  return addChannel( name, output->valuePtr(), sizeof( T ) );
+}
+
+template<typename T>
+T SharedFrameSubscriber::getValue( size_t index ) const
+{
+  static_assert( std::is_trivially_copyable<T>::value, "Shared Outputs must be trivially copyable." );
+  const auto &channel = _channels.at( index );
+  // Channels come from another process, so check them before copying.
+  if( channel.size != sizeof( T ) ) {
+    throw std::runtime_error( "Shared frame channel " + std::to_string( index ) + " holds " + std::to_string( channel.size ) + " bytes, not " + std::to_string( sizeof( T ) ) + "." );
+  }
+  if( (size_t)channel.offset + channel.size > _value_copy.size() ) {
+    throw std::runtime_error( "Shared frame channel " + std::to_string( index ) + " lies outside the frame's values." );
+  }
+
+  T value;
+  std::memcpy( &value, _value_copy.data() + channel.offset, sizeof( T ) );
+  return value;
+}
+
+} // namespace choreograph
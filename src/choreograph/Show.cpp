@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Show.h"
+
+using namespace choreograph;
+using namespace std;
+
+//=================================================
+// Show
+//=================================================
+
+void Show::addEvent( const Cue &cue )
+{
+  const Time time = cue.getStartTime() / cue.getPlaybackSpeed();
+  _events.push_back( Event{ time, cue.getFunction() } );
+  _duration = std::max( _duration, time );
+}
+
+void Show::addEvents( const CueTrack &track )
+{
+  const Time start = track.getStartTime();
+  const Time speed = track.getPlaybackSpeed();
+  track.forEachCue( [this, start, speed] ( Time time, const function<void ()> &fn ) {
+    const Time t = (start + time) / speed;
+    _events.push_back( Event{ t, fn } );
+    _duration = std::max( _duration, t );
+  } );
+}
+
+void Show::finalize()
+{
+  stable_sort( _events.begin(), _events.end(), [] (const Event &a, const Event &b) {
+    return a.time < b.time;
+  } );
+
+  for( auto &t : _tracks ) {
+    t->finalize();
+  }
+  setTime( 0 );
+}
+
+void Show::customSetTime( Time time )
+{
+  for( auto &t : _tracks ) {
+    t->reposition( time );
+  }
+}
+
+void Show::update()
+{
+  const Time now = time();
+  const Time previous = previousTime();
+  const auto before = [] (const Event &e, Time t) { return e.time < t; };
+  const auto after = [] (Time t, const Event &e) { return t < e.time; };
+
+  if( now >= previous )
+  {
+    for( auto &t : _tracks ) {
+      t->advance( now );
+    }
+    // Fire events in (previous, now].
+    auto begin = upper_bound( _events.begin(), _events.end(), previous, after );
+    auto end = upper_bound( begin, _events.end(), now, after );
+    for( auto it = begin; it != end; ++it ) {
+      detail::invokeCallback( it->fn );
+    }
+  }
+  else
+  {
+    for( auto &t : _tracks ) {
+      t->retreat( now );
+    }
+    // Fire events in [now, previous) in reverse order.
+    auto begin = lower_bound( _events.begin(), _events.end(), now, before );
+    auto end = lower_bound( begin, _events.end(), previous, before );
+    for( auto it = end; it != begin; --it ) {
+      detail::invokeCallback( (it - 1)->fn );
+    }
+  }
+}
+
+size_t Show::getTrackCount() const
+{
+  size_t count = 0;
+  for( auto &t : _tracks ) {
+    count += t->size();
+  }
+  return count;
+}
+
+size_t Show::getActiveTrackCount() const
+{
+  size_t count = 0;
+  for( auto &t : _tracks ) {
+    count += t->activeSize();
+  }
+  return count;
+}
+
+void Show::accountMemory( MemoryCounter &counter ) const
+{
+  accountItem( counter, sizeof( *this ) );
+  counter.addCallbacks( _events.capacity() * sizeof( Event ) );
+  counter.addIndex( _tracks.capacity() * sizeof( _tracks[0] ) + _track_types.capacity() * sizeof( _track_types[0] ) );
+  for( auto &tracks : _tracks ) {
+    tracks->accountMemory( counter );
+  }
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Timeline.h"
+#include "Cue.h"
+#include "CueTrack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+///
+/// \file
+/// Shows are Timelines compiled into immutable programs for fast playback.
+/// Use compileShow() on a Timeline of Motions and Cues that won't change at runtime.
+///
+
+namespace choreograph
+{
+
+namespace detail
+{
+
+/// Non-templated interface to a Show's per-type track storage.
+class ShowTracksBase
+{
+public:
+  virtual ~ShowTracksBase() = default;
+
+  /// Sorts tracks by start time and reserves playback storage. Called once when compiling.
+  virtual void finalize() = 0;
+  /// Rebuilds the active set for \a time and writes every target.
+  virtual void reposition( Time time ) = 0;
+  /// Activates tracks starting by \a time and writes the values of active tracks.
+  virtual void advance( Time time ) = 0;
+  /// Moves back to \a time, earlier than the last time advanced to, touching only the tracks crossed and the active tracks.
+  virtual void retreat( Time time ) = 0;
+
+  virtual size_t size() const = 0;
+  virtual size_t activeSize() const = 0;
+  /// Adds the track table and sample storage to \a counter.
+  virtual void accountMemory( MemoryCounter &counter ) const = 0;
+};
+
+///
+/// Baked tracks of a single type.
+/// Samples for all tracks live in one contiguous buffer, tracks are sorted by start time,
+/// and the active set is preallocated so playback never allocates.
+///
+template<typename T>
+class ShowTracks : public ShowTracksBase
+{
+public:
+  struct Track
+  {
+    Time    begin;
+    Time    end;
+    /// Reciprocal of the time between samples.
+    Time    rate;
+    size_t  offset;
+    size_t  count;
+    T       *target;
+  };
+
+  /// Bakes \a sequence, played at \a speed after \a delay, into samples spaced by at most 1/samples_per_second.
+  void add( const Sequence<T> &sequence, T *target, Time delay, Time speed, Time samples_per_second )
+  {
+    Track track;
+    track.begin = delay / speed;
+    track.end = track.begin + sequence.getDuration() / speed;
+    track.count = std::max<size_t>( (size_t)std::ceil( (track.end - track.begin) * samples_per_second ) + 1, 2 );
+    track.rate = (track.count - 1) / std::max( track.end - track.begin, Time( 1.0e-9 ) );
+    track.offset = _samples.size();
+    track.target = target;
+
+    for( size_t i = 0; i < track.count; ++i ) {
+      _samples.push_back( sequence.getValue( sequence.getDuration() * i / (track.count - 1) ) );
+    }
+    _samples.back() = sequence.getEndValue();
+    _tracks.push_back( track );
+  }
+
+  /// Points every track writing to \a from at \a to instead. Returns the number of tracks rebound.
+  size_t rebind( const T *from, T *to )
+  {
+    size_t count = 0;
+    for( auto &track : _tracks ) {
+      if( track.target == from ) {
+        track.target = to;
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  void finalize() override
+  {
+    std::stable_sort( _tracks.begin(), _tracks.end(), [] (const Track &a, const Track &b) {
+      return a.begin < b.begin;
+    } );
+    _active.reserve( _tracks.size() );
+
+    _by_end.resize( _tracks.size() );
+    for( size_t i = 0; i < _by_end.size(); ++i ) {
+      _by_end[i] = i;
+    }
+    std::stable_sort( _by_end.begin(), _by_end.end(), [this] (size_t a, size_t b) {
+      return _tracks[a].end < _tracks[b].end;
+    } );
+  }
+
+  void reposition( Time time ) override
+  {
+    _active.clear();
+    _next = std::upper_bound( _tracks.begin(), _tracks.end(), time, [] (Time t, const Track &track) {
+      return t < track.begin;
+    } ) - _tracks.begin();
+
+    for( size_t i = 0; i < _tracks.size(); ++i )
+    {
+      const auto &track = _tracks[i];
+      if( i >= _next ) {
+        *track.target = _samples[track.offset];
+      }
+      else if( time >= track.end ) {
+        *track.target = _samples[track.offset + track.count - 1];
+      }
+      else {
+        _active.push_back( i );
+      }
+    }
+    advance( time );
+  }
+
+  void advance( Time time ) override
+  {
+    _time = time;
+    while( _next < _tracks.size() && _tracks[_next].begin <= time ) {
+      _active.push_back( _next );
+      ++_next;
+    }
+
+    for( size_t i = 0; i < _active.size(); )
+    {
+      const auto &track = _tracks[_active[i]];
+      const T *samples = &_samples[track.offset];
+      if( time >= track.end ) {
+        *track.target = samples[track.count - 1];
+        _active[i] = _active.back();
+        _active.pop_back();
+      }
+      else {
+        const Time position = (time - track.begin) * track.rate;
+        const size_t index = std::min( (size_t)position, track.count - 2 );
+        *track.target = lerpT( samples[index], samples[index + 1], (float)(position - index) );
+        ++i;
+      }
+    }
+  }
+
+  void retreat( Time time ) override
+  {
+    const Time previous = _time;
+    const size_t next = std::upper_bound( _tracks.begin(), _tracks.end(), time, [] (Time t, const Track &track) {
+      return t < track.begin;
+    } ) - _tracks.begin();
+
+    // Tracks starting in (time, previous] haven't started yet.
+    for( size_t i = 0; i < _active.size(); )
+    {
+      if( _active[i] >= next ) {
+        _active[i] = _active.back();
+        _active.pop_back();
+      }
+      else {
+        ++i;
+      }
+    }
+    for( size_t i = next; i < _next; ++i ) {
+      *_tracks[i].target = _samples[_tracks[i].offset];
+    }
+    _next = next;
+
+    // Tracks that ended in (time, previous] and started by time are playing again.
+    const auto first = std::upper_bound( _by_end.begin(), _by_end.end(), time, [this] (Time t, size_t i) {
+      return t < _tracks[i].end;
+    } );
+    for( auto it = first; it != _by_end.end() && _tracks[*it].end <= previous; ++it ) {
+      if( *it < next ) {
+        _active.push_back( *it );
+      }
+    }
+
+    advance( time );
+  }
+
+  size_t size() const override { return _tracks.size(); }
+  size_t activeSize() const override { return _active.size(); }
+
+  void accountMemory( MemoryCounter &counter ) const override
+  {
+    counter.addItemStorage( sizeof( *this ) + _samples.capacity() * sizeof( T ) );
+    counter.addIndex( _tracks.capacity() * sizeof( Track ) + (_active.capacity() + _by_end.capacity()) * sizeof( size_t ) );
+  }
+
+private:
+  std::vector<Track>  _tracks;
+  std::vector<T>      _samples;
+  std::vector<size_t> _active;
+  /// Track indices sorted by end time, for finding the tracks crossed when moving backward.
+  std::vector<size_t> _by_end;
+  size_t              _next = 0;
+  /// Time last advanced to.
+  Time                _time = 0;
+};
+
+} // namespace detail
+
+class Show;
+using ShowUniqueRef = std::unique_ptr<Show>;
+
+///
+/// Compiles the Motions, Cues and CueTracks on \a timeline into a Show.
+/// List the value types of the timeline's Motions as template arguments, e.g. compileShow<float, vec2>( timeline ).
+/// Motions are sampled \a samples_per_second times per second and linearly interpolated on playback.
+/// Compiles from the start of the timeline; motion callbacks are not carried over.
+/// The show writes to the same targets as the timeline, so clear the timeline once compiled.
+/// Throws std::invalid_argument for items that can't be compiled (nested timelines, unlisted types, reversed items)
+/// and for asynchronous Cues, whose executor and continuation a Show can't carry over.
+///
+template<typename ... Ts>
+ShowUniqueRef compileShow( const Timeline &timeline, Time samples_per_second = 60.0 );
+
+///
+/// An immutable, precompiled Timeline.
+/// Motions are baked into contiguous sample tracks, and Cues and CueTrack cues into a time-sorted event table.
+/// Stepping in either direction does work proportional to the active tracks plus the tracks and events crossed,
+/// found with binary searches, and playback never allocates.
+///
+/// Shows are TimelineItems, so they can be stepped, jumped and scrubbed like a Motion.
+/// Compiling positions the show at time zero, writing the starting value of every track.
+/// setTime() repositions the show from scratch and writes every target.
+/// Cues fire when crossed in either direction, as they do on a Timeline. setTime() never fires cues.
+///
+class Show : public TimelineItem
+{
+public:
+  struct Event
+  {
+    Time                    time;
+    std::function<void ()>  fn;
+  };
+
+  /// Writes active track values and fires any events crossed since the previous update.
+  void update() override;
+  Time getDuration() const override { return _duration; }
+
+  /// Returns the number of baked tracks.
+  size_t getTrackCount() const;
+  /// Returns the number of tracks currently being written each step.
+  size_t getActiveTrackCount() const;
+  /// Returns the time-sorted event table.
+  const std::vector<Event>& getEvents() const { return _events; }
+
+  /// Counts the show, its track tables, baked samples and event table.
+  void accountMemory( MemoryCounter &counter ) const override;
+
+  /// Binding table access: points every track that wrote to \a from at \a to instead.
+  /// Returns the number of tracks rebound. Use to retarget a show loaded for a different set of objects.
+  template<typename T>
+  size_t rebind( const T *from, T *to );
+  template<typename T>
+  size_t rebind( const Output<T> *from, Output<T> *to ) { return rebind( from->valuePtr(), to->valuePtr() ); }
+
+protected:
+  void customSetTime( Time time ) override;
+
+private:
+  std::vector<std::unique_ptr<detail::ShowTracksBase>>  _tracks;
+  std::vector<const std::type_info*>                    _track_types;
+  std::vector<Event>                                    _events;
+  Time                                                  _duration = 0;
+
+  template<typename T>
+  detail::ShowTracks<T>* tracks() const;
+  template<typename T>
+  bool compileItem( const TimelineItem &item, Time samples_per_second );
+  void addEvent( const Cue &cue );
+  void addEvents( const CueTrack &track );
+  void finalize();
+
+  template<typename ... Ts>
+  friend ShowUniqueRef compileShow( const Timeline &timeline, Time samples_per_second );
+};
+
+//=================================================
+// Show Template Implementation.
+//=================================================
+
+template<typename T>
+detail::ShowTracks<T>* Show::tracks() const
+{
+  for( size_t i = 0; i < _tracks.size(); ++i ) {
+    if( *_track_types[i] == typeid( T ) ) {
+      return static_cast<detail::ShowTracks<T>*>( _tracks[i].get() );
+    }
+  }
+  return nullptr;
+}
+
+template<typename T>
+size_t Show::rebind( const T *from, T *to )
+{
+  auto t = tracks<T>();
+  return t ? t->rebind( from, to ) : 0;
+}
+
+template<typename T>
+bool Show::compileItem( const TimelineItem &item, Time samples_per_second )
+{
+  auto motion = dynamic_cast<const Motion<T>*>( &item );
+  if( ! motion ) {
+    return false;
+  }
+
+  auto t = tracks<T>();
+  if( ! t ) {
+    t = new detail::ShowTracks<T>();
+    _tracks.emplace_back( t );
+    _track_types.push_back( &typeid( T ) );
+  }
+  // Motion targets are only exposed as const void* for identification; the motion itself writes through them.
+  auto target = static_cast<T*>( const_cast<void*>( motion->getTarget() ) );
+  t->add( motion->getSequence(), target, motion->getStartTime(), motion->getPlaybackSpeed(), samples_per_second );
+  _duration = std::max( _duration, motion->getEndTime() / motion->getPlaybackSpeed() );
+  return true;
+}
+
+template<typename ... Ts>
+ShowUniqueRef compileShow( const Timeline &timeline, Time samples_per_second )
+{
+  ShowUniqueRef show( new Show );
+
+  for( const auto &item : timeline )
+  {
+    if( item->cancelled() ) {
+      continue;
+    }
+    if( item->getPlaybackSpeed() <= 0 ) {
+      throw std::invalid_argument( "compileShow: reversed or paused items can't be compiled." );
+    }
+
+    auto cue = dynamic_cast<const Cue*>( item.get() );
+    if( cue ) {
+      if( cue->getCompletion() ) {
+        throw std::invalid_argument( "compileShow: asynchronous cues can't be compiled." );
+      }
+      show->addEvent( *cue );
+      continue;
+    }
+    auto track = dynamic_cast<const CueTrack*>( item.get() );
+    if( track ) {
+      show->addEvents( *track );
+      continue;
+    }
+
+    bool compiled = false;
+    const bool results[] = { false, (compiled = compiled || show->template compileItem<Ts>( *item, samples_per_second ))... };
+    (void)results;
+    if( ! compiled ) {
+      throw std::invalid_argument( "compileShow: timeline contains an item of a type not listed for compilation." );
+    }
+  }
+
+  show->finalize();
+  return show;
+}
+
+} // namespace choreograph
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Sequence.hpp"
+#include "phrase/Ramp.hpp"
+#include "detail/Components.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+///
+/// \file
+/// Simplification reduces a Sequence to fewer Phrases while staying within an error bound.
+///
+
+namespace choreograph
+{
+
+///
+/// Result of simplifying a Sequence.
+///
+template<typename T>
+struct SimplifyResult
+{
+  SimplifyResult( const Sequence<T> &sequence ):
+    sequence( sequence )
+  {}
+
+  /// The simplified Sequence, built from RampTo phrases, instantaneous holds and any original phrases a line couldn't replace.
+  Sequence<T> sequence;
+  size_t      original_phrases = 0;
+  size_t      simplified_phrases = 0;
+  /// Bound on the component-wise deviation from the original: the largest deviation at the samples
+  /// plus how far the original strays from straight lines between them (see simplify()).
+  double      max_error = 0;
+};
+
+namespace detail
+{
+
+/// Largest absolute difference between the components of \a a and \a b.
+template<typename T>
+double componentDistance( const T &a, const T &b )
+{
+  double distance = 0;
+  for( size_t i = 0; i < Components<T>::size; ++i ) {
+    distance = std::max<double>( distance, std::abs( (double)Components<T>::get( a, i ) - (double)Components<T>::get( b, i ) ) );
+  }
+  return distance;
+}
+
+/// How far \a bounds reach past the componentwise range of \a a and \a b; zero if they aren't finite.
+template<typename T>
+double overshoot( const Bounds<T> &bounds, const T &a, const T &b )
+{
+  double distance = 0;
+  if( bounds.isBounded() ) {
+    for( size_t i = 0; i < Components<T>::size; ++i ) {
+      const double ca = Components<T>::get( a, i );
+      const double cb = Components<T>::get( b, i );
+      distance = std::max( distance, (double)Components<T>::get( bounds.getMax(), i ) - std::max( ca, cb ) );
+      distance = std::max( distance, std::min( ca, cb ) - (double)Components<T>::get( bounds.getMin(), i ) );
+    }
+  }
+  return distance;
+}
+
+///
+/// Simplifies a window of consecutive, continuous phrases with Douglas-Peucker on the phrase boundaries.
+/// Each phrase is sampled at \a samples even steps, and steps are bisected while the phrase strays more than
+/// a quarter of the tolerance from the chord between their samples at the quarter points, or its bounds overshoot them.
+/// The largest remaining deviation is kept per phrase as slack and added to the error at the samples,
+/// so spans are only replaced by a line when the whole phrase is within tolerance of it.
+/// Spans that can't be replaced by a line keep their original phrase.
+///
+template<typename T>
+class SimplifyWindow
+{
+public:
+  SimplifyWindow( const Sequence<T> &source, double tolerance, size_t samples ):
+    _source( source ),
+    _tolerance( tolerance ),
+    _samples( samples )
+  {}
+
+  /// Appends the simplified phrases [first, last) starting at \a offset to \a result.
+  void simplify( size_t first, size_t last, Time offset, SimplifyResult<T> *result )
+  {
+    _times.clear();
+    _values.clear();
+    _begin.clear();
+    _slack.clear();
+    _first = first;
+    for( size_t p = first; p < last; ++p )
+    {
+      const auto &phrase = _source.getPhraseAtIndex( p );
+      const Time duration = phrase->getDuration();
+      double slack = 0;
+      _begin.push_back( _times.size() );
+      _times.push_back( offset );
+      _values.push_back( phrase->getValue( 0 ) );
+      for( size_t s = 1; s <= _samples; ++s ) {
+        const Time from = duration * (s - 1) / _samples;
+        const Time to = duration * s / _samples;
+        refine( *phrase, offset, from, to, s == _samples ? phrase->getEndValue() : phrase->getValue( to ), 0, &slack );
+      }
+      _slack.push_back( slack );
+      offset += duration;
+    }
+    _begin.push_back( _times.size() );
+
+    // Process spans depth-first, left to right, so phrases are emitted in order.
+    _stack.clear();
+    _stack.emplace_back( first, last );
+    while( ! _stack.empty() )
+    {
+      auto span = _stack.back();
+      _stack.pop_back();
+
+      auto farthest = measure( span.first, span.second );
+      if( farthest.second <= _tolerance ) {
+        result->sequence.template then<RampTo>( endValue( span.second - 1 ), endTime( span.second - 1 ) - startTime( span.first ) );
+        result->max_error = std::max( result->max_error, farthest.second );
+      }
+      else if( span.second - span.first == 1 ) {
+        result->sequence.then( _source.getPhraseAtIndex( span.first ) );
+      }
+      else {
+        // Split at a boundary of the phrase containing the largest deviation.
+        const size_t phrase = farthest.first;
+        const size_t split = (phrase > span.first) ? phrase : phrase + 1;
+        _stack.emplace_back( split, span.second );
+        _stack.emplace_back( span.first, split );
+      }
+    }
+  }
+
+private:
+  /// Limits bisection to 2^10 pieces per step.
+  static const size_t max_depth = 10;
+
+  const Sequence<T>                       &_source;
+  double                                  _tolerance;
+  size_t                                  _samples;
+  size_t                                  _first = 0;
+  std::vector<Time>                       _times;
+  std::vector<T>                          _values;
+  /// Index of each phrase's first sample, plus one past the last phrase's.
+  std::vector<size_t>                     _begin;
+  /// Largest deviation of each phrase from the chords between its samples.
+  std::vector<double>                     _slack;
+  std::vector<std::pair<size_t, size_t>>  _stack;
+
+  size_t  firstSample( size_t phrase ) const { return _begin[phrase - _first]; }
+  size_t  lastSample( size_t phrase ) const { return _begin[phrase - _first + 1] - 1; }
+  Time    startTime( size_t phrase ) const { return _times[firstSample( phrase )]; }
+  Time    endTime( size_t phrase ) const { return _times[lastSample( phrase )]; }
+  const T& startValue( size_t phrase ) const { return _values[firstSample( phrase )]; }
+  const T& endValue( size_t phrase ) const { return _values[lastSample( phrase )]; }
+
+  /// Samples \a phrase at \a to, whose value is \a to_value, after the last sample at \a from.
+  /// Bisects while the quarter points stray from the chord or the bounds overshoot its ends.
+  void refine( const Phrase<T> &phrase, Time offset, Time from, Time to, const T &to_value, size_t depth, double *slack )
+  {
+    const T from_value = _values.back();
+    const Time middle = (from + to) / 2;
+    const T middle_value = phrase.getValue( middle );
+    double deviation = overshoot( phrase.getBounds( from, to ), from_value, to_value );
+    deviation = std::max( deviation, componentDistance( middle_value, lerpT( from_value, to_value, 0.5f ) ) );
+    deviation = std::max( deviation, componentDistance( phrase.getValue( (from + middle) / 2 ), lerpT( from_value, to_value, 0.25f ) ) );
+    deviation = std::max( deviation, componentDistance( phrase.getValue( (middle + to) / 2 ), lerpT( from_value, to_value, 0.75f ) ) );
+    if( deviation > _tolerance / 4 && depth < max_depth ) {
+      refine( phrase, offset, from, middle, middle_value, depth + 1, slack );
+      refine( phrase, offset, middle, to, to_value, depth + 1, slack );
+    }
+    else {
+      *slack = std::max( *slack, deviation );
+      _times.push_back( offset + to );
+      _values.push_back( to_value );
+    }
+  }
+
+  /// Returns the phrase farthest from a line across phrases [first, last), and a bound on that distance.
+  std::pair<size_t, double> measure( size_t first, size_t last ) const
+  {
+    const Time start = startTime( first );
+    const Time span = endTime( last - 1 ) - start;
+    const T &a = startValue( first );
+    const T &b = endValue( last - 1 );
+
+    auto farthest = std::make_pair( first, 0.0 );
+    for( size_t p = first; p < last; ++p ) {
+      double error = 0;
+      for( size_t i = firstSample( p ); i <= lastSample( p ); ++i ) {
+        error = std::max( error, componentDistance( _values[i], lerpT( a, b, (float)((_times[i] - start) / span) ) ) );
+      }
+      error += _slack[p - _first];
+      if( error > farthest.second ) {
+        farthest = std::make_pair( p, error );
+      }
+    }
+    return farthest;
+  }
+};
+
+} // namespace detail
+
+///
+/// Returns a Sequence approximating \a sequence with fewer Phrases.
+/// Runs Douglas-Peucker over the phrase boundaries, replacing spans of phrases with a linear
+/// RampTo when every sample in the span is within \a tolerance of it.
+/// Phrases that can't be replaced are kept as they are, so the result never has more phrases.
+/// Each source Phrase is sampled at \a samples_per_phrase even steps, bisected where the Phrase curves or
+/// its bounds overshoot the samples. The error is bounded by the deviation at the samples plus the
+/// largest deviation between them, measured at the quarter points of the bisected steps. That bound is exact
+/// for linear and quadratic steps, and for others assumes they curve no more than their quarter points show.
+/// Discontinuities (e.g. from Sequence::set()) and instantaneous phrases are preserved.
+/// Works with any type that has components (see detail::Components) and a lerpT, including quaternions.
+///
+template<typename T>
+SimplifyResult<T> simplify( const Sequence<T> &sequence, double tolerance, size_t samples_per_phrase = 4 )
+{
+  static_assert( detail::Components<T>::size > 0, "simplify requires an arithmetic or vector-like type." );
+
+  // Bound the work per span so long sequences simplify in linear time.
+  const size_t window_size = 256;
+
+  SimplifyResult<T> result( Sequence<T>( sequence.getStartValue() ) );
+  result.original_phrases = sequence.size();
+  detail::SimplifyWindow<T> window( sequence, tolerance, std::max<size_t>( samples_per_phrase, 1 ) );
+
+  Time   offset = 0;
+  size_t first = 0;
+  auto flush = [&] ( size_t last ) {
+    if( last > first ) {
+      window.simplify( first, last, offset, &result );
+      for( size_t i = first; i < last; ++i ) {
+        offset += sequence.getPhraseAtIndex( i )->getDuration();
+      }
+    }
+    first = last;
+  };
+
+  for( size_t p = 0; p < sequence.size(); ++p )
+  {
+    const auto &phrase = sequence.getPhraseAtIndex( p );
+    const bool discontinuous = (p == 0) ? detail::componentDistance( phrase->getStartValue(), sequence.getStartValue() ) != 0
+                                        : detail::componentDistance( phrase->getStartValue(), sequence.getPhraseAtIndex( p - 1 )->getEndValue() ) != 0;
+
+    if( phrase->getDuration() <= 0 ) {
+      // Instantaneous phrases (e.g. from Sequence::set()) are kept as-is.
+      flush( p );
+      result.sequence.then( phrase );
+      first = p + 1;
+    }
+    else if( discontinuous || p - first == window_size ) {
+      flush( p );
+      if( detail::componentDistance( phrase->getStartValue(), result.sequence.getEndValue() ) != 0 ) {
+        result.sequence.template then<Hold>( phrase->getStartValue(), 0 );
+      }
+    }
+  }
+  flush( sequence.size() );
+  result.simplified_phrases = result.sequence.size();
+
+  return result;
+}
+
+} // namespace choreograph
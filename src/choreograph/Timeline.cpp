@@ -28,6 +28,9 @@
 #include "Timeline.h"
 #include "detail/VectorManipulation.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace choreograph;
 
 namespace
@@ -42,6 +45,8 @@ namespace
     {}
 
     void update() override { _item->step( deltaTime() ); }
+    void peek( Time dt, PresentationBuffer &buffer ) const override { _item->peek( dt * getPlaybackSpeed(), buffer ); }
+    void interpolateStep( Time dt, float alpha ) override { _item->interpolateStep( dt * getPlaybackSpeed(), alpha ); }
     Time getDuration() const override { return _item->getDuration(); }
     const void* getTarget() const override { return _item->getTarget(); }
   private:
@@ -52,9 +57,16 @@ namespace
 
 Timeline::Timeline( Timeline &&rhs )
     : _default_remove_on_finish( std::move( rhs._default_remove_on_finish ) ),
+      _phrase_interner( std::move( rhs._phrase_interner ) ),
       _items( std::move( rhs._items ) ),
       _queue( std::move( rhs._queue ) ),
       _updating( std::move( rhs._updating ) ),
+      _batch( std::move( rhs._batch ) ),
+      _resume_queue( std::move( rhs._resume_queue ) ),
+      _fixed_step( std::move( rhs._fixed_step ) ),
+      _cull( std::move( rhs._cull ) ),
+      _cull_window( std::move( rhs._cull_window ) ),
+      _culled_count( std::move( rhs._culled_count ) ),
       _finish_fn( std::move( rhs._finish_fn ) )
 {}
 
@@ -70,33 +82,149 @@ void Timeline::customSetTime( Time time )
   }
 }
 
+void Timeline::setBatchEvaluation( bool enabled )
+{
+  if( ! enabled ) {
+    _batch.reset();
+  }
+  else if( ! _batch ) {
+    _batch = detail::make_unique<detail::BatchEvaluator>();
+  }
+}
+
 void Timeline::update()
 {
-  _updating = true;
-  for( auto &item : _items ) {
-    item->step( deltaTime() );
+  const bool was_empty = empty();
+
+  std::exception_ptr cue_error;
+  if( _fixed_step.dt > 0 ) {
+    stepFixed( &cue_error );
+  }
+  else {
+    stepItems( deltaTime(), &cue_error );
   }
-  _updating = false;
 
-  postUpdate();
+  postUpdate( was_empty );
+
+  if( cue_error ) {
+    std::rethrow_exception( cue_error );
+  }
 }
 
-void Timeline::postUpdate()
+void Timeline::stepItems( Time dt, std::exception_ptr *cue_error )
 {
-  bool was_empty = empty();
+  _updating = true;
+
+  if( _resume_queue && ! *cue_error )
+  {
+    try {
+      _resume_queue->resume();
+    }
+    catch( ... ) {
+      *cue_error = std::current_exception();
+    }
+  }
+
+  if( ! _cull.empty() )
+  {
+    _culled_count = 0;
+    for( auto &item : _items ) {
+      item->stepCulled( dt, _cull, _cull_window );
+      _culled_count += item->isCulled();
+    }
+  }
+  else if( _batch )
+  {
+    for( auto &item : _items ) {
+      item->stepBatched( dt, *_batch );
+    }
+    _batch->evaluate();
+  }
+  else
+  {
+    for( auto &item : _items ) {
+      item->step( dt );
+    }
+  }
+  _updating = false;
 
   removeFinishedAndInvalidMotions();
 
   processQueue();
+}
+
+void Timeline::stepFixed( std::exception_ptr *cue_error )
+{
+  auto &fixed = _fixed_step;
+  fixed.accumulator += deltaTime();
+
+  // Reverse playback steps backward.
+  const Time step = (fixed.accumulator < 0) ? -fixed.dt : fixed.dt;
+  size_t substeps = 0;
+  while( std::abs( fixed.accumulator ) >= fixed.dt && substeps < fixed.max_substeps )
+  {
+    stepItems( step, cue_error );
+    fixed.accumulator -= step;
+    substeps += 1;
+  }
+
+  if( std::abs( fixed.accumulator ) >= fixed.dt )
+  {
+    fixed.stats.capped_updates += 1;
+    if( fixed.catch_up == FixedStepCatchUp::Drop )
+    {
+      const Time kept = std::fmod( fixed.accumulator, fixed.dt );
+      fixed.stats.dropped_time += std::abs( fixed.accumulator - kept );
+      fixed.accumulator = kept;
+    }
+  }
+
+  fixed.stats.substeps = substeps;
+  fixed.stats.total_substeps += substeps;
+  fixed.stats.alpha = (float)std::min<Time>( std::abs( fixed.accumulator ) / fixed.dt, 1 );
+
+  const bool culling = ! _cull.empty();
+  for( auto &item : _items ) {
+    if( ! (culling && item->isCulled()) ) {
+      item->interpolateStep( step, fixed.stats.alpha );
+    }
+  }
+}
+
+void Timeline::setFixedTimestep( Time dt, size_t max_substeps, FixedStepCatchUp catch_up )
+{
+  _fixed_step = FixedStep();
+  _fixed_step.dt = std::max<Time>( dt, 0 );
+  _fixed_step.max_substeps = max_substeps;
+  _fixed_step.catch_up = catch_up;
+}
+
+void Timeline::interpolateStep( Time dt, float alpha )
+{
+  const Time item_dt = dt * getPlaybackSpeed();
+  for( auto &item : _items ) {
+    item->interpolateStep( item_dt, alpha );
+  }
+}
 
+void Timeline::peek( Time dt, PresentationBuffer &buffer ) const
+{
+  const Time item_dt = dt * getPlaybackSpeed();
+  for( auto &item : _items ) {
+    item->peek( item_dt, buffer );
+  }
+}
+
+void Timeline::postUpdate( bool was_empty )
+{
   if( _finish_fn )
   {
     auto d = getDuration();
     if( forward() && time() >= d && previousTime() < d ) {
-      _finish_fn();
+      detail::invokeCallback( _finish_fn );
     }
     else if( backward() && time() <= 0.0f && previousTime() > 0.0f ) {
-      _finish_fn();
+      detail::invokeCallback( _finish_fn );
     }
   }
 
@@ -105,7 +233,7 @@ void Timeline::postUpdate()
   bool is_empty = empty();
   if( _cleared_fn ) {
     if( is_empty && ! was_empty ) {
-      _cleared_fn();
+      detail::invokeCallback( _cleared_fn );
     }
   }
 }
@@ -128,6 +256,24 @@ Time Timeline::getDuration() const
   return duration;
 }
 
+void Timeline::accountMemory( MemoryCounter &counter ) const
+{
+  accountItem( counter, sizeof( *this ), sizeof( _finish_fn ) + sizeof( _cleared_fn ) );
+  counter.addIndex( (_items.capacity() + _queue.capacity()) * sizeof( TimelineItemUniqueRef ) );
+  if( _batch ) {
+    counter.addIndex( sizeof( detail::BatchEvaluator ) + _batch->getStorageSize() );
+  }
+  if( _resume_queue ) {
+    counter.addIndex( sizeof( detail::CueResumeQueue ) + _resume_queue->size() * sizeof( detail::CueTicket ) );
+  }
+  for( auto &item : _items ) {
+    item->accountMemory( counter );
+  }
+  for( auto &item : _queue ) {
+    item->accountMemory( counter );
+  }
+}
+
 void Timeline::processQueue()
 {
   using namespace std;
@@ -150,9 +296,10 @@ void Timeline::cancel( void *output )
   }
 }
 
-void Timeline::add( TimelineItemUniqueRef &&item )
+TimelineOptions Timeline::add( TimelineItemUniqueRef &&item )
 {
   item->setRemoveOnFinish( _default_remove_on_finish );
+  TimelineOptions options( *item );
 
   if( _updating ) {
     _queue.emplace_back( std::move( item ) );
@@ -160,6 +307,8 @@ void Timeline::add( TimelineItemUniqueRef &&item )
   else {
     _items.emplace_back( std::move( item ) );
   }
+
+  return options;
 }
 
 TimelineOptions Timeline::addShared( const TimelineItemRef &shared )
@@ -178,10 +327,10 @@ TimelineOptions Timeline::addShared( const TimelineItemRef &shared )
   return TimelineOptions( ref );
 }
 
-TimelineOptions Timeline::cue( const std::function<void ()> &fn, Time delay )
+CueOptions Timeline::cue( const std::function<void ()> &fn, Time delay )
 {
   auto cue = detail::make_unique<Cue>( fn, delay );
-  TimelineOptions options( *cue );
+  CueOptions options( *cue, _resume_queue );
 
   add( std::move( cue ) );
 
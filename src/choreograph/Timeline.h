@@ -33,6 +33,30 @@
 namespace choreograph
 {
 
+/// What a fixed timestep Timeline does with time it couldn't simulate within its substep limit.
+enum class FixedStepCatchUp
+{
+  /// Discard whole steps of the backlog. Animation slows down rather than falling further behind.
+  Drop,
+  /// Keep the backlog and work it off over later updates, up to the substep limit each time.
+  Carry
+};
+
+/// Counts from a fixed timestep Timeline.
+struct FixedStepStats
+{
+  /// Substeps run by the last update.
+  size_t    substeps = 0;
+  /// Substeps run since fixed stepping was enabled.
+  uint64_t  total_substeps = 0;
+  /// Updates that hit the substep limit.
+  uint64_t  capped_updates = 0;
+  /// Time discarded by FixedStepCatchUp::Drop.
+  Time      dropped_time = 0;
+  /// Fraction of a step left in the accumulator after the last update, used to interpolate Outputs.
+  float     alpha = 0;
+};
+
 ///
 /// Timeline holds a collection of TimelineItems and updates them through time.
 /// TimelineItems include Motions and Cues.
@@ -73,15 +97,15 @@ public:
   //=================================================
 
   /// Add a cue to the timeline. It will be called after \a delay time elapses on this Timeline.
-  TimelineOptions cue( const std::function<void ()> &fn, Time delay );
+  CueOptions cue( const std::function<void ()> &fn, Time delay );
 
   //=================================================
   // Adding TimelineItems.
   //=================================================
 
   /// Add an item to the timeline. Called by append/apply/cue methods.
-  /// Use to pass in MotionGroups and other types that Timeline doesn't create.
-  void add( TimelineItemUniqueRef &&item );
+  /// Use to pass in MotionGroups, CueTracks and other types that Timeline doesn't create.
+  TimelineOptions add( TimelineItemUniqueRef &&item );
 
   /// Add a shared item to the timeline.
   /// Use in advanced cases when you want to maintain the TimelineItem outside the Timeline.
@@ -91,7 +115,17 @@ public:
   // Time manipulation.
   //=================================================
 
+  /// Writes the values every item would produce after stepping \a dt into \a buffer.
+  /// Time, Outputs and callbacks are untouched, and nested Timelines are peeked too.
+  void peek( Time dt, PresentationBuffer &buffer ) const override;
+
+  /// Render-time pass: starts a new frame in \a buffer and fills it with values predicted \a dt ahead,
+  /// typically the time until the frame being rendered is displayed. Read them with PresentationBuffer::get().
+  void present( Time dt, PresentationBuffer &buffer ) const { buffer.beginFrame(); peek( dt, buffer ); }
+
   /// Updates all timeline items to the current time.
+  /// First runs continuations of asynchronous cues that finished since the last update.
+  /// If an asynchronous cue threw, rethrows its exception after the update.
   void update() override;
 
   //=================================================
@@ -117,6 +151,9 @@ public:
 
   Time getDuration() const override;
 
+  /// Counts the timeline, its item lists and every item, including items queued during update.
+  void accountMemory( MemoryCounter &counter ) const override;
+
   //=================================================
   // Timeline element manipulation.
   //=================================================
@@ -126,6 +163,50 @@ public:
   /// Does not affect TimelineItems already on the Timeline.
   void setDefaultRemoveOnFinish( bool doRemove ) { _default_remove_on_finish = doRemove; }
 
+  /// Set an interner for the Sequences of Motions created by this timeline, so identical Phrases are shared.
+  /// Sequences passed to apply() keep their own interner if they have one.
+  /// Does not affect Motions already on the Timeline.
+  void setPhraseInterner( const PhraseInternerRef &interner ) { _phrase_interner = interner; }
+  const PhraseInternerRef& getPhraseInterner() const { return _phrase_interner; }
+
+  /// Simulate in fixed steps of \a dt. Set to zero (the default) to step items by whatever step() receives.
+  /// Each update adds its time to an accumulator and steps items zero or more times by \a dt, so callbacks
+  /// fire on fixed ticks, then presents Motion Outputs interpolated between the last two steps' values.
+  /// Presented values trail simulation by up to one step.
+  /// At most \a max_substeps run per update; \a catch_up decides what happens to the rest.
+  void setFixedTimestep( Time dt, size_t max_substeps = 4, FixedStepCatchUp catch_up = FixedStepCatchUp::Drop );
+  Time getFixedTimestep() const { return _fixed_step.dt; }
+  /// Returns counts from fixed stepping.
+  const FixedStepStats& getFixedStepStats() const { return _fixed_step.stats; }
+
+  /// Presents Outputs between the values of the last step and the one \a dt before it.
+  void interpolateStep( Time dt, float alpha ) override;
+
+  /// Evaluate Motions in batches. Off by default.
+  /// Motions without callbacks whose current Phrase is a RampTo or Hold of float or packed floats
+  /// (e.g. vec2, vec3, vec4), with an Easing.h ease of kind EaseKind and no custom lerp, are grouped
+  /// by float count and ease and evaluated together after all items have stepped.
+  /// Other items update individually, in order, as usual; they see batched Outputs' values from the previous step.
+  void setBatchEvaluation( bool enabled );
+  bool getBatchEvaluation() const { return _batch != nullptr; }
+  /// Returns counts from the last batched update. Zeroes when batch evaluation is off.
+  BatchStats getBatchStats() const { return _batch ? _batch->getStats() : BatchStats(); }
+
+  /// Skips updating Motions of type T whose values can't pass \a visible over the next cull window,
+  /// e.g. objects whose animated position bounds never enter the viewport. Culled Outputs keep their last value
+  /// until the Motion is visible again or finishes.
+  /// Motions with callbacks are never culled. Culling takes the place of batch evaluation.
+  template<typename T>
+  void setCullTest( const CullTest::Fn<T> &visible ) { _cull.set<T>( visible ); }
+  /// Removes all cull tests, so every item updates.
+  void clearCullTests() { _cull.clear(); _culled_count = 0; }
+  /// Sets how many seconds of playback each visibility test covers. Items are retested when it has passed.
+  /// Longer windows test less often but with looser bounds. Default is half a second.
+  void setCullWindow( Time seconds ) { _cull_window = seconds; }
+  Time getCullWindow() const { return _cull_window; }
+  /// Returns the number of items culled in the last update.
+  size_t getCulledCount() const { return _culled_count; }
+
   /// Remove all items from this timeline.
   /// Do not call from a callback.
   void clear() { _items.clear(); }
@@ -160,17 +241,40 @@ protected:
 private:
   // True if Motions should be removed from timeline when they reach their endTime.
   bool                                _default_remove_on_finish = true;
+  PhraseInternerRef                   _phrase_interner;
   std::vector<TimelineItemUniqueRef>  _items;
 
   // queue to make adding cues from callbacks safe. Used if modifying functions are called during update loop.
   std::vector<TimelineItemUniqueRef>  _queue;
   bool                                _updating = false;
+  std::unique_ptr<detail::BatchEvaluator> _batch;
+  // Firings of asynchronous cues waiting to resume, created by the first async cue.
+  std::shared_ptr<detail::CueResumeQueue> _resume_queue;
+  struct FixedStep
+  {
+    Time              dt = 0;
+    size_t            max_substeps = 4;
+    FixedStepCatchUp  catch_up = FixedStepCatchUp::Drop;
+    Time              accumulator = 0;
+    FixedStepStats    stats;
+  };
+  FixedStep                           _fixed_step;
+
+  CullTest                            _cull;
+  Time                                _cull_window = 0.5;
+  size_t                              _culled_count = 0;
   std::function<void ()>              _finish_fn = nullptr;
   std::function<void ()>        _cleared_fn = nullptr;
 
-  // Clean up finished motions and add queued motions after update.
-  // Calls finish function if we went from having items to no items this iteration.
-  void postUpdate();
+  // Steps every item by dt, then cleans up finished motions and adds queued motions.
+  // Resumes asynchronous cues first, storing any error they raise in cue_error.
+  void stepItems( Time dt, std::exception_ptr *cue_error );
+
+  // Runs fixed substeps for this update's time and interpolates Outputs.
+  void stepFixed( std::exception_ptr *cue_error );
+
+  // Calls finish function if we reached the end and cleared function if we went from having items to no items this update.
+  void postUpdate( bool was_empty );
 
   // Remove any motions that have stale pointers or that have completed playing.
   void removeFinishedAndInvalidMotions();
@@ -184,6 +288,10 @@ private:
   template<typename T>
   Motion<T>* find( T *output ) const;
 
+  /// Gives \a sequence the timeline's interner unless it already has one.
+  template<typename T>
+  void adoptInterner( Sequence<T> &sequence ) const;
+
   /// Remove motion associated with specific output.
   /// Used internally to manage raw pointer animation.
   void cancel( void *output );
@@ -199,6 +307,7 @@ MotionOptions<T> Timeline::apply( Output<T> *output )
   auto motion = detail::make_unique<Motion<T>>( output );
 
   auto &motion_ref = *motion;
+  adoptInterner( motion_ref.getSequence() );
   add( std::move( motion ) );
 
   return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
@@ -210,6 +319,7 @@ MotionOptions<T> Timeline::apply( Output<T> *output, const PhraseRef<T> &phrase
   auto motion = detail::make_unique<Motion<T>>( output, Sequence<T>( phrase ) );
 
   auto &motion_ref = *motion;
+  adoptInterner( motion_ref.getSequence() );
   add( std::move( motion ) );
 
   return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
@@ -221,6 +331,7 @@ MotionOptions<T> Timeline::apply( Output<T> *output, const Sequence<T> &sequence
   auto motion = detail::make_unique<Motion<T>>( output, sequence );
 
   auto &motion_ref = *motion;
+  adoptInterner( motion_ref.getSequence() );
   add( std::move( motion ) );
 
   return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
@@ -245,6 +356,7 @@ MotionOptions<T> Timeline::applyRaw( T *output )
   auto motion = detail::make_unique<Motion<T>>( output );
 
   auto &m = *motion;
+  adoptInterner( m.getSequence() );
   add( std::move( motion ) );
 
   return MotionOptions<T>( m, m.getSequence(), *this );
@@ -257,6 +369,7 @@ MotionOptions<T> Timeline::applyRaw( T *output, const Sequence<T> &sequence )
   auto motion = detail::make_unique<Motion<T>>( output, sequence );
 
   auto &m = *motion;
+  adoptInterner( m.getSequence() );
   add( std::move( motion ) );
 
   return MotionOptions<T>( m, m.getSequence(), *this );
@@ -272,6 +385,14 @@ MotionOptions<T> Timeline::appendRaw( T *output )
   return apply( output );
 }
 
+template<typename T>
+void Timeline::adoptInterner( Sequence<T> &sequence ) const
+{
+  if( _phrase_interner && ! sequence.getInterner() ) {
+    sequence.setInterner( _phrase_interner );
+  }
+}
+
 template<typename T>
 Motion<T>* Timeline::find( T *output ) const
 {
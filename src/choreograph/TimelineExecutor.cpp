@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TimelineExecutor.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace choreograph;
+using namespace std;
+
+TimelineExecutor::TimelineExecutor( size_t threads ):
+  _remaining( 0 )
+{
+  if( threads == 0 ) {
+    threads = max<size_t>( thread::hardware_concurrency(), 1 );
+  }
+
+  for( size_t i = 0; i < threads; ++i ) {
+    _queues.emplace_back( new WorkQueue );
+  }
+  // Queue zero belongs to the thread calling step().
+  for( size_t i = 1; i < threads; ++i ) {
+    _workers.emplace_back( &TimelineExecutor::workerLoop, this, i );
+  }
+}
+
+TimelineExecutor::~TimelineExecutor()
+{
+  {
+    lock_guard<mutex> lock( _mutex );
+    _stopping = true;
+  }
+  _start.notify_all();
+  for( auto &worker : _workers ) {
+    worker.join();
+  }
+}
+
+void TimelineExecutor::add( Timeline *timeline, CallbackPolicy policy )
+{
+  _entries.push_back( Entry{ timeline, policy, {} } );
+}
+
+void TimelineExecutor::remove( Timeline *timeline )
+{
+  _entries.erase( remove_if( _entries.begin(), _entries.end(), [timeline] ( const Entry &e ) {
+    return e.timeline == timeline;
+  } ), _entries.end() );
+}
+
+void TimelineExecutor::step( Time dt )
+{
+  if( _entries.empty() ) {
+    return;
+  }
+
+  // A worker finishing the previous step may already see new tasks, so set up state first.
+  _dt = dt;
+  _error = nullptr;
+  _remaining = _entries.size();
+  distribute();
+
+  if( ! _workers.empty() )
+  {
+    {
+      lock_guard<mutex> lock( _mutex );
+      _generation += 1;
+    }
+    _start.notify_all();
+  }
+
+  work( 0 );
+
+  if( ! _workers.empty() )
+  {
+    unique_lock<mutex> lock( _mutex );
+    _done.wait( lock, [this] { return _remaining == 0; } );
+  }
+
+  if( _error ) {
+    for( auto &entry : _entries ) {
+      entry.deferred.clear();
+    }
+    rethrow_exception( _error );
+  }
+
+  // Gather everything first, so callbacks may add or remove Timelines.
+  detail::CallbackQueue callbacks;
+  for( auto &entry : _entries )
+  {
+    move( entry.deferred.begin(), entry.deferred.end(), back_inserter( callbacks ) );
+    entry.deferred.clear();
+  }
+  for( auto &fn : callbacks ) {
+    fn();
+  }
+}
+
+void TimelineExecutor::distribute()
+{
+  // Longest processing time first: biggest timelines go to the least loaded queue.
+  _order.resize( _entries.size() );
+  for( size_t i = 0; i < _order.size(); ++i ) {
+    _order[i] = i;
+  }
+  stable_sort( _order.begin(), _order.end(), [this] ( size_t a, size_t b ) {
+    return _entries[a].timeline->size() > _entries[b].timeline->size();
+  } );
+
+  _loads.assign( _queues.size(), 0 );
+  for( auto task : _order )
+  {
+    const size_t queue = min_element( _loads.begin(), _loads.end() ) - _loads.begin();
+    // Count empty timelines as one unit so they spread out too.
+    _loads[queue] += max<size_t>( _entries[task].timeline->size(), 1 );
+    lock_guard<mutex> lock( _queues[queue]->mutex );
+    _queues[queue]->tasks.push_back( task );
+  }
+}
+
+void TimelineExecutor::workerLoop( size_t index )
+{
+  size_t generation = 0;
+  while( true )
+  {
+    {
+      unique_lock<mutex> lock( _mutex );
+      _start.wait( lock, [&] { return _stopping || _generation != generation; } );
+      if( _stopping ) {
+        return;
+      }
+      generation = _generation;
+    }
+    work( index );
+  }
+}
+
+void TimelineExecutor::work( size_t index )
+{
+  size_t task;
+  while( takeTask( index, &task ) )
+  {
+    runTask( task );
+    if( --_remaining == 0 && ! _workers.empty() ) {
+      lock_guard<mutex> lock( _mutex );
+      _done.notify_all();
+    }
+  }
+}
+
+bool TimelineExecutor::takeTask( size_t index, size_t *task )
+{
+  {
+    auto &own = *_queues[index];
+    lock_guard<mutex> lock( own.mutex );
+    if( ! own.tasks.empty() ) {
+      *task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+
+  for( size_t i = 1; i < _queues.size(); ++i )
+  {
+    auto &victim = *_queues[(index + i) % _queues.size()];
+    lock_guard<mutex> lock( victim.mutex );
+    if( ! victim.tasks.empty() ) {
+      *task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void TimelineExecutor::runTask( size_t task )
+{
+  auto &entry = _entries[task];
+  auto &deferred = detail::deferredCallbacks();
+  auto previous = deferred;
+  deferred = (entry.policy == CallbackPolicy::Deferred) ? &entry.deferred : nullptr;
+
+  try {
+    entry.timeline->step( _dt );
+  }
+  catch( ... ) {
+    lock_guard<mutex> lock( _mutex );
+    if( ! _error ) {
+      _error = current_exception();
+    }
+  }
+
+  deferred = previous;
+}
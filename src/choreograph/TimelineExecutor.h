@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Timeline.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace choreograph
+{
+
+///
+/// TimelineExecutor steps many independent Timelines concurrently on a pool of threads.
+///
+/// Register Timelines with add(), then call step() once per frame from the owning thread.
+/// Each step hands out the Timelines largest first (by item count) to per-thread queues,
+/// and idle threads steal from busy ones. The calling thread works too, and step()
+/// returns when every Timeline has been stepped.
+///
+/// Timelines must be independent: no shared Outputs, raw targets or Phrases with mutable state.
+/// Their callbacks either run on whichever thread steps the Timeline (CallbackPolicy::Immediate),
+/// or are queued and run on the thread calling step() once all Timelines are done
+/// (CallbackPolicy::Deferred). Deferred callbacks run in registration order, and in the
+/// order they were raised within each Timeline, so results don't depend on scheduling.
+///
+/// If a callback throws on a worker, the first exception is rethrown from step().
+///
+class TimelineExecutor
+{
+public:
+  enum class CallbackPolicy
+  {
+    /// Callbacks run on the worker thread during the step.
+    Immediate,
+    /// Callbacks are queued and run on the calling thread after the step.
+    Deferred
+  };
+
+  /// Creates an executor using \a threads threads, including the thread calling step().
+  /// Zero uses one thread per hardware thread.
+  explicit TimelineExecutor( size_t threads = 0 );
+  ~TimelineExecutor();
+
+  TimelineExecutor( const TimelineExecutor &rhs ) = delete;
+  TimelineExecutor& operator= ( const TimelineExecutor &rhs ) = delete;
+
+  /// Registers \a timeline, which must outlive its registration. Don't register a Timeline twice.
+  /// Safe to call from deferred callbacks, but not from immediate ones.
+  void add( Timeline *timeline, CallbackPolicy policy = CallbackPolicy::Deferred );
+  /// Unregisters \a timeline. Safe to call from deferred callbacks, but not from immediate ones.
+  void remove( Timeline *timeline );
+
+  /// Steps every registered Timeline by \a dt and runs deferred callbacks.
+  void step( Time dt );
+
+  /// Returns the number of registered Timelines.
+  size_t size() const { return _entries.size(); }
+  /// Returns the number of threads stepping Timelines, including the caller.
+  size_t getThreadCount() const { return _queues.size(); }
+
+private:
+  struct Entry
+  {
+    Timeline              *timeline;
+    CallbackPolicy        policy;
+    detail::CallbackQueue deferred;
+  };
+
+  /// Work queue of one thread. Owners pop from the front, thieves from the back.
+  struct WorkQueue
+  {
+    std::mutex          mutex;
+    std::deque<size_t>  tasks;
+  };
+
+  std::vector<Entry>                        _entries;
+  std::vector<std::unique_ptr<WorkQueue>>   _queues;
+  std::vector<std::thread>                  _workers;
+  std::vector<size_t>                       _order;
+  std::vector<size_t>                       _loads;
+
+  std::mutex                _mutex;
+  std::condition_variable   _start;
+  std::condition_variable   _done;
+  size_t                    _generation = 0;
+  bool                      _stopping = false;
+  std::atomic<size_t>       _remaining;
+  Time                      _dt = 0;
+  std::exception_ptr        _error;
+
+  void distribute();
+  void workerLoop( size_t index );
+  void work( size_t index );
+  bool takeTask( size_t index, size_t *task );
+  void runTask( size_t task );
+};
+
+} // namespace choreograph
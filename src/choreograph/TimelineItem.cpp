@@ -26,9 +26,17 @@
  */
 
 #include "TimelineItem.h"
+#include "BatchEvaluation.h"
+#include "Bounds.hpp"
 
 using namespace choreograph;
 
+detail::CallbackQueue*& detail::deferredCallbacks()
+{
+  static thread_local CallbackQueue *queue = nullptr;
+  return queue;
+}
+
 Control::Control( TimelineItem *item ):
   _item( item )
 {}
@@ -72,6 +80,38 @@ void TimelineItem::step( Time dt )
   _previous_time = _time;
 }
 
+void TimelineItem::stepBatched( Time dt, detail::BatchEvaluator &batch )
+{
+  _time += dt * _speed;
+  if( ! cancelled() && ! gatherBatch( batch ) ) {
+    update();
+    batch.addFallback();
+  }
+  _previous_time = _time;
+}
+
+void TimelineItem::stepCulled( Time dt, const CullTest &cull, Time window )
+{
+  _time += dt * _speed;
+  if( ! cancelled() )
+  {
+    const Time t = time();
+    if( cull.getRevision() != _cull_revision || t < _cull_from || t > _cull_to )
+    {
+      const Time span = window * std::abs( _speed );
+      _cull_from = forward() ? t : t - span;
+      _cull_to = forward() ? t + span : t;
+      _cull_revision = cull.getRevision();
+      _culled = ! mayBeVisible( cull, _cull_from, _cull_to );
+    }
+    // Finishing items update once more so their targets end on their final values.
+    if( ! _culled || isFinished() ) {
+      update();
+    }
+  }
+  _previous_time = _time;
+}
+
 void TimelineItem::jumpTo( Time time )
 {
   _time = time;
@@ -118,4 +158,17 @@ const std::shared_ptr<Control>& TimelineItem::getControl()
     _control = std::make_shared<Control>( this );
   }
   return _control;
-}
\ No newline at end of file
+}
+
+MemoryUsage TimelineItem::memoryUsage() const
+{
+  MemoryCounter counter;
+  accountMemory( counter );
+  return counter.getUsage();
+}
+
+void TimelineItem::accountItem( MemoryCounter &counter, size_t object_bytes, size_t callback_bytes ) const
+{
+  counter.addItem( object_bytes, callback_bytes );
+  counter.addControl( _control );
+}
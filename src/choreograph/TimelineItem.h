@@ -28,14 +28,46 @@
 #pragma once
 
 #include "TimeType.h"
+#include "MemoryUsage.h"
+
+#include <functional>
+#include <vector>
 
 namespace choreograph
 {
 
 class TimelineItem;
+class PresentationBuffer;
+class CullTest;
+namespace detail { class BatchEvaluator; }
 using TimelineItemRef = std::shared_ptr<TimelineItem>;
 using TimelineItemUniqueRef = std::unique_ptr<TimelineItem>;
 
+namespace detail
+{
+
+using CallbackQueue = std::vector<std::function<void ()>>;
+
+/// Returns the queue collecting this thread's callbacks while a TimelineExecutor defers them.
+/// Null while callbacks run immediately.
+CallbackQueue*& deferredCallbacks();
+
+/// Calls \a fn with \a args, or queues the call if this thread's callbacks are deferred.
+/// TimelineItems invoke all user callbacks through this.
+template<typename Fn, typename... Args>
+void invokeCallback( const Fn &fn, const Args&... args )
+{
+  auto queue = deferredCallbacks();
+  if( queue ) {
+    queue->emplace_back( [fn, args...] { fn( args... ); } );
+  }
+  else {
+    fn( args... );
+  }
+}
+
+} // namespace detail
+
 ///
 /// Control struct for cancelling TimelineItems.
 /// Accessible through the CueOptions struct.
@@ -90,6 +122,17 @@ public:
   /// Do not use from callbacks (it will fire them, likely causing an infinite loop).
   void step( Time dt );
 
+  /// Advance like step(), but let the item queue its evaluation in \a batch instead of updating.
+  /// The batch must be evaluated before the item's output is read.
+  void stepBatched( Time dt, detail::BatchEvaluator &batch );
+
+  /// Advance like step(), but skip updating while the item can't be visible to \a cull.
+  /// Visibility is tested over the next \a window seconds of playback and retested once they have passed.
+  void stepCulled( Time dt, const CullTest &cull, Time window );
+
+  /// Returns true if the last stepCulled() skipped updating.
+  bool isCulled() const { return _culled; }
+
   /// Jump to a point in time. Ignores playback speed.
   /// Do not use from callbacks (it will fire them, likely causing an infinite loop).
   void jumpTo( Time time );
@@ -117,6 +160,21 @@ public:
   /// May be removed in favor of an alternative identifying mechanism in the future.
   virtual const void* getTarget() const { return nullptr; }
 
+  /// Override to write the values this item would produce after stepping \a dt into \a buffer,
+  /// without changing time or calling callbacks.
+  /// The default predicts nothing, so the item's targets present their current values.
+  virtual void peek( Time /*dt*/, PresentationBuffer &/*buffer*/ ) const {}
+
+  /// Override to present targets at \a alpha of the way from their values one step of \a dt ago to their current values.
+  /// Called by fixed timestep Timelines after stepping; the next step writes the simulated values again.
+  /// The default leaves targets at their current values.
+  virtual void interpolateStep( Time /*dt*/, float /*alpha*/ ) {}
+
+  /// Override to report whether any value this item produces between \a from and \a to could pass \a cull.
+  /// Items that must keep updating while unseen, e.g. to call callbacks, should return true.
+  /// The default is always visible.
+  virtual bool mayBeVisible( const CullTest &/*cull*/, Time /*from*/, Time /*to*/ ) const { return true; }
+
   //=================================================
   // Time manipulation and querying.
   //=================================================
@@ -169,7 +227,29 @@ public:
 
   /// Returns a shared_ptr to a control that allows you to cancel the Cue.
   const std::shared_ptr<Control>& getControl();
+
+  //=================================================
+  // Memory accounting.
+  //=================================================
+
+  /// Returns the memory held by this item and everything it owns, counting shared Phrases once.
+  MemoryUsage memoryUsage() const;
+
+  /// Override to report memory use. Count the item with accountItem() and pass owned objects to \a counter.
+  /// The default only knows about the TimelineItem base class.
+  virtual void accountMemory( MemoryCounter &counter ) const { accountItem( counter, sizeof( TimelineItem ) ); }
 protected:
+  /// Counts an item of \a object_bytes, \a callback_bytes of which are std::function members, along with its control.
+  void accountItem( MemoryCounter &counter, size_t object_bytes, size_t callback_bytes = 0 ) const;
+
+  /// Moves the playhead to \a time as though this step began at \a previous_time, without updating.
+  /// Times are relative to the start time. Lets looping items wrap their clock from update().
+  void setLoopedTime( Time time, Time previous_time ) { _time = _start_time + time; _previous_time = _start_time + previous_time; }
+
+  /// Override to queue this step's evaluation in \a batch instead of updating.
+  /// Return false to be updated normally.
+  virtual bool gatherBatch( detail::BatchEvaluator &/*batch*/ ) { return false; }
+
   /// Override to handle additional time setting as needed.
   /// Used by MotionGroup to propagate setTime calls to timeline.
   virtual void customSetTime( Time time ) {}
@@ -188,6 +268,12 @@ private:
   Time       _start_time = 0;
   /// True iff this item was cancelled.
   bool       _cancelled = false;
+  /// True if stepCulled() found the item invisible over [_cull_from, _cull_to].
+  bool       _culled = false;
+  Time       _cull_from = 0;
+  Time       _cull_to = -1;
+  /// CullTest revision the visibility was tested with.
+  uint64_t   _cull_revision = 0;
   std::shared_ptr<Control>  _control;
 };
 
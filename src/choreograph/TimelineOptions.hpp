@@ -80,7 +80,7 @@ private:
 
 ///
 /// TimelineOptions with no additional behaviors beyond base.
-/// Returned when creating cues.
+/// Returned when adding items.
 /// Do not store the TimelineOptions object, as it contains a non-owning reference.
 ///
 class TimelineOptions : public TimelineOptionsBase<TimelineOptions>
@@ -91,6 +91,45 @@ public:
   {}
 };
 
+///
+/// CueOptions add asynchronous execution to the TimelineOptions of a Cue.
+/// Returned when creating cues.
+/// Do not store the CueOptions object, as it contains non-owning references.
+///
+class CueOptions : public TimelineOptionsBase<CueOptions>
+{
+public:
+  CueOptions( Cue &cue, std::shared_ptr<detail::CueResumeQueue> &resume_queue ):
+  TimelineOptionsBase<CueOptions>( cue ),
+  _cue( cue ),
+  _resume_queue( resume_queue )
+  {}
+
+  /// Run the Cue's function on \a executor instead of during the Timeline step.
+  /// Use for expensive work; cheap cues are better left synchronous.
+  CueOptions& async( const CueExecutor &executor )
+  {
+    if( ! _resume_queue ) {
+      _resume_queue = std::make_shared<detail::CueResumeQueue>();
+    }
+    _cue.setExecutor( executor, _resume_queue );
+    return *this;
+  }
+
+  /// Set a function to run on the Timeline's thread during the first step after each asynchronous call finishes.
+  /// Continuations run in the order their Cues fired.
+  CueOptions& then( const std::function<void ()> &fn ) { _cue.setContinuation( fn ); return *this; }
+
+  /// Returns the completion handle of an asynchronous Cue, or nullptr if it is synchronous.
+  CueCompletionRef getCompletion() { return _cue.getCompletion(); }
+
+  Cue& getCue() { return _cue; }
+
+private:
+  Cue                                       &_cue;
+  std::shared_ptr<detail::CueResumeQueue>   &_resume_queue;
+};
+
 ///
 /// MotionOptions provide a temporary facade for manipulating a timeline Motion and its underlying Sequence.
 /// All methods return a reference back to the MotionOptions object for chaining.
@@ -138,6 +177,13 @@ public:
   /// When used after Timeline::apply, will have the same effect as cutIn().
   SelfT& cutAt( Time t ) { _motion.sliceSequence( 0, t ); return *this; }
 
+  /// Loop the Motion forever, wrapping from the end back to inflection point \a from_inflection.
+  /// Use instead of wrapping the Sequence in a LoopPhrase with a large loop count.
+  SelfT& loop( LoopMode mode = LoopMode::Repeat, size_t from_inflection = 0 ) { _motion.setLoop( mode, from_inflection ); return *this; }
+
+  /// Set function to be called each time a looping Motion wraps around.
+  SelfT& loopFn( const MotionCallback &fn ) { _motion.setLoopFn( fn ); return *this; }
+
   //=================================================
   // Sequence Interface Mirroring.
   //=================================================
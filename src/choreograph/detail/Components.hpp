@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace choreograph
+{
+namespace detail
+{
+
+template<typename... Ts> struct make_void { using type = void; };
+template<typename... Ts> using void_t = typename make_void<Ts...>::type;
+
+template<typename T, typename = void> struct has_x : std::false_type {};
+template<typename T> struct has_x<T, void_t<decltype( std::declval<T&>().x )>> : std::true_type {};
+template<typename T, typename = void> struct has_y : std::false_type {};
+template<typename T> struct has_y<T, void_t<decltype( std::declval<T&>().y )>> : std::true_type {};
+template<typename T, typename = void> struct has_z : std::false_type {};
+template<typename T> struct has_z<T, void_t<decltype( std::declval<T&>().z )>> : std::true_type {};
+template<typename T, typename = void> struct has_w : std::false_type {};
+template<typename T> struct has_w<T, void_t<decltype( std::declval<T&>().w )>> : std::true_type {};
+
+/// Access to the x, y, z, w members of vector-like types.
+template<typename T, size_t N>
+struct MemberComponents;
+
+template<typename T>
+struct MemberComponents<T, 1>
+{
+  using ValueT = typename std::decay<decltype( std::declval<T&>().x )>::type;
+  static ValueT get( const T &v, size_t /*i*/ ) { return v.x; }
+  static void   set( T &v, size_t /*i*/, ValueT c ) { v.x = c; }
+};
+
+template<typename T>
+struct MemberComponents<T, 2>
+{
+  using ValueT = typename std::decay<decltype( std::declval<T&>().x )>::type;
+  static ValueT get( const T &v, size_t i ) { return i == 0 ? v.x : v.y; }
+  static void   set( T &v, size_t i, ValueT c ) { (i == 0 ? v.x : v.y) = c; }
+};
+
+template<typename T>
+struct MemberComponents<T, 3>
+{
+  using ValueT = typename std::decay<decltype( std::declval<T&>().x )>::type;
+  static ValueT get( const T &v, size_t i ) { return i == 0 ? v.x : i == 1 ? v.y : v.z; }
+  static void   set( T &v, size_t i, ValueT c ) { (i == 0 ? v.x : i == 1 ? v.y : v.z) = c; }
+};
+
+template<typename T>
+struct MemberComponents<T, 4>
+{
+  using ValueT = typename std::decay<decltype( std::declval<T&>().x )>::type;
+  static ValueT get( const T &v, size_t i ) { return i == 0 ? v.x : i == 1 ? v.y : i == 2 ? v.z : v.w; }
+  static void   set( T &v, size_t i, ValueT c ) { (i == 0 ? v.x : i == 1 ? v.y : i == 2 ? v.z : v.w) = c; }
+};
+
+///
+/// Uniform access to the scalar components of a value.
+/// Arithmetic types have one component.
+/// Types with x, y, z, w members (glm, Cinder and most vector libraries) have one per member.
+/// Other types have size 0 and no accessors.
+///
+template<typename T, typename Enable = void>
+struct Components
+{
+  static const size_t size = 0;
+};
+
+template<typename T>
+struct Components<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+  using ValueT = T;
+  static const size_t size = 1;
+  static ValueT get( const T &v, size_t /*i*/ ) { return v; }
+  static void   set( T &v, size_t /*i*/, ValueT c ) { v = c; }
+};
+
+template<typename T>
+struct Components<T, typename std::enable_if<has_x<T>::value>::type>
+  : MemberComponents<T, has_w<T>::value ? 4 : has_z<T>::value ? 3 : has_y<T>::value ? 2 : 1>
+{
+  static const size_t size = has_w<T>::value ? 4 : has_z<T>::value ? 3 : has_y<T>::value ? 2 : 1;
+};
+
+} // namespace detail
+} // namespace choreograph
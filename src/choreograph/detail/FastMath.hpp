@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace choreograph
+{
+namespace detail
+{
+
+///
+/// Approximations of the transcendental functions used by the easing equations.
+/// Accurate to roughly single precision over the arguments the eases use,
+/// without calling into libm.
+///
+
+/// Sine via range reduction to [0, pi/2] and a degree 7 minimax polynomial.
+/// Absolute error below 1e-6 for |x| < 1e3.
+inline float fastSin( float x )
+{
+  const float pi = 3.14159265358979f;
+  // 2 pi split in two parts so the reduction stays exact for moderate arguments.
+  const float two_pi_high = 6.28125f;
+  const float two_pi_low = 1.9353071795864769e-3f;
+
+  const float turns = x * 0.159154943091895f;
+  // Round to the nearest turn with a single truncation; the bias keeps the argument positive.
+  const float k = (float)((int32_t)(turns + 1024.5f) - 1024);
+  const float y = (x - k * two_pi_high) - k * two_pi_low;
+
+  // Fold [-pi, pi] onto [0, pi/2] without branching: sin(y) = sign(y) * sin(min(|y|, pi - |y|)).
+  const float a = std::abs( y );
+  const float r = std::min( a, pi - a );
+  const float r2 = r * r;
+  const float s = r * (0.99999661f + r2 * (-0.16664824f + r2 * (0.00830629f + r2 * -0.00018363f)));
+  return y < 0 ? -s : s;
+}
+
+inline float fastCos( float x )
+{
+  return fastSin( x + 1.57079632679490f );
+}
+
+/// 2^x via an exact power of two for the nearest integer and a degree 6 polynomial for the remainder.
+/// Relative error below 5e-7.
+inline float fastExp2( float x )
+{
+  if( x < -126.0f ) {
+    return 0.0f;
+  }
+  if( x > 127.0f ) {
+    x = 127.0f;
+  }
+
+  const int32_t i = (int32_t)(x + (x >= 0 ? 0.5f : -0.5f));
+  const float f = x - (float)i;
+  // Taylor series of e^(f ln 2) for f in [-0.5, 0.5].
+  const float p = 1.0f + f * (6.9314718e-1f + f * (2.4022651e-1f + f * (5.5504109e-2f + f * (9.6181291e-3f + f * (1.3333558e-3f + f * 1.5403530e-4f)))));
+
+  const int32_t bits = (i + 127) << 23;
+  float scale;
+  std::memcpy( &scale, &bits, sizeof( scale ) );
+  return p * scale;
+}
+
+/// Arc tangent via a degree 11 odd polynomial on [-1, 1], reflected for larger arguments.
+/// Absolute error below 5e-6.
+inline float fastAtan( float x )
+{
+  const float half_pi = 1.57079632679490f;
+  const bool invert = std::abs( x ) > 1.0f;
+  const float y = invert ? 1.0f / x : x;
+  const float y2 = y * y;
+  const float a = y * (0.99997726f + y2 * (-0.33262347f + y2 * (0.19354346f + y2 * (-0.11643287f + y2 * (0.05265332f + y2 * -0.01172120f)))));
+  if( invert ) {
+    return (x > 0 ? half_pi : -half_pi) - a;
+  }
+  return a;
+}
+
+} // namespace detail
+} // namespace choreograph
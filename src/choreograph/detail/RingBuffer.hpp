@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace choreograph
+{
+namespace detail
+{
+
+///
+/// Single-producer, single-consumer ring buffer of bytes.
+/// Neither side ever blocks or takes a lock; writes and reads may be partial.
+/// Capacity is rounded up to a power of two.
+///
+class RingBuffer
+{
+public:
+  explicit RingBuffer( size_t capacity ):
+    _buffer( roundUp( capacity ) ),
+    _mask( _buffer.size() - 1 )
+  {}
+
+  /// Copies up to \a bytes from \a data into the buffer. Call from the producer thread only.
+  /// Returns the number of bytes actually written.
+  size_t write( const uint8_t *data, size_t bytes )
+  {
+    const size_t head = _head.load( std::memory_order_relaxed );
+    const size_t tail = _tail.load( std::memory_order_acquire );
+    const size_t count = std::min( bytes, _buffer.size() - (head - tail) );
+
+    const size_t start = head & _mask;
+    const size_t first = std::min( count, _buffer.size() - start );
+    std::memcpy( &_buffer[start], data, first );
+    std::memcpy( &_buffer[0], data + first, count - first );
+
+    _head.store( head + count, std::memory_order_release );
+    return count;
+  }
+
+  /// Copies up to \a max_bytes from the buffer into \a out. Call from the consumer thread only.
+  /// Returns the number of bytes actually read.
+  size_t read( uint8_t *out, size_t max_bytes )
+  {
+    const size_t tail = _tail.load( std::memory_order_relaxed );
+    const size_t head = _head.load( std::memory_order_acquire );
+    const size_t count = std::min( max_bytes, head - tail );
+
+    const size_t start = tail & _mask;
+    const size_t first = std::min( count, _buffer.size() - start );
+    std::memcpy( out, &_buffer[start], first );
+    std::memcpy( out + first, &_buffer[0], count - first );
+
+    _tail.store( tail + count, std::memory_order_release );
+    return count;
+  }
+
+  /// Returns the number of bytes waiting to be read. Approximate when called during writes.
+  size_t size() const { return _head.load( std::memory_order_acquire ) - _tail.load( std::memory_order_acquire ); }
+
+  size_t capacity() const { return _buffer.size(); }
+
+private:
+  std::vector<uint8_t>  _buffer;
+  size_t                _mask;
+  // Keep the producer and consumer indices on separate cache lines.
+  alignas(64) std::atomic<size_t> _head { 0 };
+  alignas(64) std::atomic<size_t> _tail { 0 };
+
+  static size_t roundUp( size_t capacity )
+  {
+    size_t size = 64;
+    while( size < capacity ) {
+      size <<= 1;
+    }
+    return size;
+  }
+};
+
+} // namespace detail
+} // namespace choreograph
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "choreograph/Interpolation.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+///
+/// \file
+/// A small vector and quaternion library, so Choreograph builds and runs without Cinder or GLM.
+///
+/// Vectors are plain runs of floats (vec4 and quat are 16-byte aligned), so Choreograph
+/// interpolates and batches them with SSE like any other packed float type.
+/// The types live in choreograph::math to keep them apart from your own math library's names.
+///
+
+namespace choreograph
+{
+namespace math
+{
+
+struct vec2
+{
+  float x, y;
+
+  vec2(): x( 0 ), y( 0 ) {}
+  explicit vec2( float s ): x( s ), y( s ) {}
+  vec2( float x, float y ): x( x ), y( y ) {}
+};
+
+struct vec3
+{
+  float x, y, z;
+
+  vec3(): x( 0 ), y( 0 ), z( 0 ) {}
+  explicit vec3( float s ): x( s ), y( s ), z( s ) {}
+  vec3( float x, float y, float z ): x( x ), y( y ), z( z ) {}
+};
+
+struct alignas( 16 ) vec4
+{
+  float x, y, z, w;
+
+  vec4(): x( 0 ), y( 0 ), z( 0 ), w( 0 ) {}
+  explicit vec4( float s ): x( s ), y( s ), z( s ), w( s ) {}
+  vec4( float x, float y, float z, float w ): x( x ), y( y ), z( z ), w( w ) {}
+};
+
+///
+/// Rotation quaternion. Constructed from w first, like GLM; stored x, y, z, w.
+///
+struct alignas( 16 ) quat
+{
+  float x, y, z, w;
+
+  /// The identity rotation.
+  quat(): x( 0 ), y( 0 ), z( 0 ), w( 1 ) {}
+  quat( float w, float x, float y, float z ): x( x ), y( y ), z( z ), w( w ) {}
+};
+
+//=================================================
+// Vector operators.
+//=================================================
+
+template<typename V> struct is_vector : std::false_type {};
+template<> struct is_vector<vec2> : std::true_type {};
+template<> struct is_vector<vec3> : std::true_type {};
+template<> struct is_vector<vec4> : std::true_type {};
+
+template<typename V>
+using EnableIfVector = typename std::enable_if<is_vector<V>::value, V>::type;
+
+/// Applies \a fn to each pair of components of \a a and \a b.
+template<typename V, typename Fn>
+inline V componentwise( const V &a, const V &b, const Fn &fn )
+{
+  using C = detail::Components<V>;
+  V r;
+  for( size_t i = 0; i < C::size; ++i ) {
+    C::set( r, i, fn( C::get( a, i ), C::get( b, i ) ) );
+  }
+  return r;
+}
+
+template<typename V> inline EnableIfVector<V> operator+ ( const V &a, const V &b ) { return componentwise( a, b, [] ( float l, float r ) { return l + r; } ); }
+template<typename V> inline EnableIfVector<V> operator- ( const V &a, const V &b ) { return componentwise( a, b, [] ( float l, float r ) { return l - r; } ); }
+template<typename V> inline EnableIfVector<V> operator* ( const V &a, const V &b ) { return componentwise( a, b, [] ( float l, float r ) { return l * r; } ); }
+template<typename V> inline EnableIfVector<V> operator/ ( const V &a, const V &b ) { return componentwise( a, b, [] ( float l, float r ) { return l / r; } ); }
+template<typename V> inline EnableIfVector<V> operator* ( const V &a, float s ) { return a * V( s ); }
+template<typename V> inline EnableIfVector<V> operator* ( float s, const V &a ) { return a * V( s ); }
+template<typename V> inline EnableIfVector<V> operator/ ( const V &a, float s ) { return a * (1.0f / s); }
+template<typename V> inline EnableIfVector<V> operator- ( const V &a ) { return a * -1.0f; }
+template<typename V> inline EnableIfVector<V>& operator+= ( V &a, const V &b ) { return a = a + b; }
+template<typename V> inline EnableIfVector<V>& operator-= ( V &a, const V &b ) { return a = a - b; }
+template<typename V> inline EnableIfVector<V>& operator*= ( V &a, float s ) { return a = a * s; }
+template<typename V> inline EnableIfVector<V>& operator/= ( V &a, float s ) { return a = a / s; }
+
+inline bool operator== ( const vec2 &a, const vec2 &b ) { return a.x == b.x && a.y == b.y; }
+inline bool operator== ( const vec3 &a, const vec3 &b ) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+inline bool operator== ( const vec4 &a, const vec4 &b ) { return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w; }
+inline bool operator== ( const quat &a, const quat &b ) { return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w; }
+inline bool operator!= ( const vec2 &a, const vec2 &b ) { return ! (a == b); }
+inline bool operator!= ( const vec3 &a, const vec3 &b ) { return ! (a == b); }
+inline bool operator!= ( const vec4 &a, const vec4 &b ) { return ! (a == b); }
+inline bool operator!= ( const quat &a, const quat &b ) { return ! (a == b); }
+
+inline float dot( const vec2 &a, const vec2 &b ) { return a.x * b.x + a.y * b.y; }
+inline float dot( const vec3 &a, const vec3 &b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float dot( const vec4 &a, const vec4 &b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline float dot( const quat &a, const quat &b ) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline vec3 cross( const vec3 &a, const vec3 &b ) { return vec3( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x ); }
+
+template<typename V>
+inline float length( const V &v ) { return std::sqrt( dot( v, v ) ); }
+
+template<typename V>
+inline EnableIfVector<V> normalize( const V &v ) { return v / length( v ); }
+
+/// Linear interpolation, as GLM's mix().
+template<typename V>
+inline EnableIfVector<V> mix( const V &a, const V &b, float t ) { return a + (b - a) * t; }
+
+//=================================================
+// Quaternion functions.
+//=================================================
+
+inline quat operator* ( const quat &a, const quat &b )
+{
+  return quat( a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+               a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+               a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+               a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w );
+}
+
+inline quat operator* ( const quat &q, float s ) { return quat( q.w * s, q.x * s, q.y * s, q.z * s ); }
+inline quat operator+ ( const quat &a, const quat &b ) { return quat( a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z ); }
+inline quat operator- ( const quat &q ) { return quat( -q.w, -q.x, -q.y, -q.z ); }
+
+inline quat normalize( const quat &q ) { return q * (1.0f / std::sqrt( dot( q, q ) )); }
+inline quat conjugate( const quat &q ) { return quat( q.w, -q.x, -q.y, -q.z ); }
+
+/// Rotation of \a angle radians around the unit vector \a axis.
+inline quat angleAxis( float angle, const vec3 &axis )
+{
+  const float s = std::sin( angle * 0.5f );
+  return quat( std::cos( angle * 0.5f ), axis.x * s, axis.y * s, axis.z * s );
+}
+
+/// Rotates \a v by the unit quaternion \a q.
+inline vec3 operator* ( const quat &q, const vec3 &v )
+{
+  const vec3 u( q.x, q.y, q.z );
+  const vec3 t = cross( u, v ) * 2.0f;
+  return v + t * q.w + cross( u, t );
+}
+
+/// Spherical interpolation along the shorter arc between unit quaternions.
+/// Falls back to normalized lerp when they are nearly equal.
+inline quat slerp( const quat &a, const quat &b, float t )
+{
+  float cos_theta = dot( a, b );
+  const quat end = (cos_theta < 0) ? -b : b;
+  cos_theta = std::abs( cos_theta );
+
+  if( cos_theta > 0.9995f ) {
+    return normalize( a * (1 - t) + end * t );
+  }
+  const float theta = std::acos( cos_theta );
+  const float sin_theta = std::sin( theta );
+  return a * (std::sin( (1 - t) * theta ) / sin_theta) + end * (std::sin( t * theta ) / sin_theta);
+}
+
+} // namespace math
+
+/// Quaternions slerp rather than lerp, and are left out of batch evaluation.
+template<>
+struct InterpolationTraits<math::quat> : detail::ComponentTraits<math::quat>
+{
+  static const bool has_slerp = true;
+  static const bool linear_floats = false;
+
+  static math::quat slerp( const math::quat &start, const math::quat &end, float time ) { return math::normalize( math::slerp( start, end, time ) ); }
+  static math::quat lerp( const math::quat &start, const math::quat &end, float time ) { return slerp( start, end, time ); }
+};
+
+} // namespace choreograph
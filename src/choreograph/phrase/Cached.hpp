@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "choreograph/Phrase.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+///
+/// \file
+/// CachedPhrase stores sampled values of another Phrase so that costly
+/// sources are evaluated once per sample instead of once per lookup.
+///
+
+namespace choreograph
+{
+
+///
+/// Counters describing how a CachedPhrase has been used.
+///
+struct CacheStats
+{
+  /// Number of calls to getValue.
+  size_t lookups = 0;
+  /// Lookups that found their block already baked.
+  size_t hits = 0;
+  /// Blocks baked from the source, by lookups that missed or by precache().
+  size_t blocks_baked = 0;
+  /// Blocks discarded to stay within the memory cap.
+  size_t evictions = 0;
+  /// Bytes currently held in baked blocks.
+  size_t bytes = 0;
+  /// Largest value \a bytes has reached.
+  size_t peak_bytes = 0;
+
+  /// Returns the fraction of lookups served without sampling the source.
+  double hitRate() const { return lookups ? (double)hits / lookups : 0.0; }
+};
+
+///
+/// CachedPhrase wraps an expensive Phrase (deep accumulations, procedural
+/// simulations, noise) and serves interpolated values from a sample table.
+///
+/// The table is baked lazily, one block of samples at a time, the first time
+/// a lookup lands in that block. Revisiting the same times (scrubbing, or
+/// wrapping in LoopPhrase or PingPongPhrase) then costs a table lookup and a lerp.
+/// With a memory cap, the least recently used blocks are discarded and
+/// rebaked on demand.
+///
+/// Values are sampled at \a samples_per_second and interpolated with
+/// InterpolationTraits<T> unless given a lerp function, so detail finer than
+/// the resolution is lost. Call invalidate() after changing anything the
+/// source depends on.
+///
+/// The cache is filled from the const getValue(), so a CachedPhrase must not
+/// be evaluated from several threads at once.
+///
+template<typename T>
+class CachedPhrase : public Phrase<T>
+{
+public:
+  using LerpFn = std::function<T (const T&, const T&, float)>;
+
+  /// Caches \a source at \a samples_per_second, baking \a block_size samples at a time.
+  /// A \a max_bytes of zero lets the cache grow to hold the whole source.
+  CachedPhrase( const PhraseRef<T> &source, Time samples_per_second = 60.0, size_t max_bytes = 0, size_t block_size = 64, const LerpFn &lerp_fn = detail::traitLerpFn<T>() ):
+    Phrase<T>( source->getDuration() ),
+    _source( source ),
+    _block_size( std::max<size_t>( block_size, 1 ) ),
+    _max_bytes( max_bytes ),
+    _lerp_fn( detail::requireLerpFn<T>( lerp_fn ) )
+  {
+    const Time duration = source->getDuration();
+    _intervals = std::max<size_t>( (size_t)std::ceil( duration * samples_per_second ), 1 );
+    _samples_per_second = duration > 0 ? _intervals / duration : 0;
+    _blocks.resize( (_intervals + _block_size - 1) / _block_size );
+  }
+
+  T getValue( Time at_time ) const override
+  {
+    _stats.lookups += 1;
+
+    const Time position = std::min( std::max( at_time * _samples_per_second, Time( 0 ) ), Time( _intervals ) );
+    const size_t interval = std::min( (size_t)position, _intervals - 1 );
+    if( ! _blocks[interval / _block_size].samples.empty() ) {
+      _stats.hits += 1;
+    }
+    const Block &block = bakedBlock( interval / _block_size );
+    const size_t index = interval % _block_size;
+    const float t = (float)(position - interval);
+
+    return lerp( block.samples[index], block.samples[index + 1], t );
+  }
+
+  T getStartValue() const override { return _source->getStartValue(); }
+  T getEndValue() const override { return _source->getEndValue(); }
+
+  /// Samples interpolate between source values, so the source's bounds one sample either side contain them.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    if( _lerp_fn || ! detail::has_linear_bounds<T>::value ) {
+      return Bounds<T>::unbounded();
+    }
+    const Time interval = _samples_per_second > 0 ? 1 / _samples_per_second : this->getDuration();
+    return _source->getBounds( from - interval, to + interval );
+  }
+
+  /// Discards every baked block.
+  void invalidate()
+  {
+    for( auto &block : _blocks ) {
+      discard( block );
+    }
+  }
+
+  /// Discards the blocks covering times in [\a begin, \a end].
+  void invalidate( Time begin, Time end )
+  {
+    if( end < begin ) {
+      return;
+    }
+    // Samples in [begin, end] may have changed; so have the intervals on either side of them.
+    const Time first = std::ceil( std::max( begin * _samples_per_second, Time( 0 ) ) );
+    const Time last = std::floor( std::min( end * _samples_per_second, Time( _intervals - 1 ) ) );
+    const size_t first_interval = std::min( first > 0 ? (size_t)first - 1 : 0, _intervals - 1 );
+    const size_t last_interval = last > 0 ? (size_t)last : 0;
+    for( size_t i = first_interval / _block_size; i <= last_interval / _block_size; ++i ) {
+      discard( _blocks[i] );
+    }
+  }
+
+  /// Replaces the cached Phrase and discards all baked samples.
+  /// The new source is sampled over this Phrase's original duration.
+  void setSource( const PhraseRef<T> &source )
+  {
+    _source = source;
+    invalidate();
+  }
+
+  /// Bakes every block up front, e.g. before handing the Phrase to a realtime thread.
+  /// Stops early if the memory cap cannot hold the whole table.
+  void precache() const
+  {
+    for( size_t i = 0; i < _blocks.size(); ++i ) {
+      if( _max_bytes && _stats.bytes + blockBytes( i ) > _max_bytes ) {
+        break;
+      }
+      bakedBlock( i );
+    }
+  }
+
+  const PhraseRef<T>& getSource() const { return _source; }
+  Time                getSamplesPerSecond() const { return _samples_per_second; }
+  size_t              getBlockSize() const { return _block_size; }
+  size_t              getMaxBytes() const { return _max_bytes; }
+  /// Sets the memory cap, evicting blocks right away if needed. Zero means unlimited.
+  void                setMaxBytes( size_t max_bytes ) { _max_bytes = max_bytes; evictToFit( 0, _blocks.size() ); }
+
+  size_t accountMemory( MemoryCounter &counter ) const override
+  {
+    counter.addPhrase( _source );
+    return sizeof( *this ) + _blocks.capacity() * sizeof( Block ) + _stats.bytes;
+  }
+
+  const CacheStats&   getStats() const { return _stats; }
+  /// Resets the usage counters. Memory figures keep describing the current table.
+  void                resetStats() { const size_t bytes = _stats.bytes; _stats = CacheStats(); _stats.bytes = _stats.peak_bytes = bytes; }
+
+private:
+  struct Block
+  {
+    std::vector<T> samples;
+    size_t         last_used = 0;
+  };
+
+  PhraseRef<T>          _source;
+  Time                  _samples_per_second = 0;
+  size_t                _intervals = 1;
+  size_t                _block_size;
+  size_t                _max_bytes;
+  LerpFn                _lerp_fn;
+
+  mutable std::vector<Block> _blocks;
+  mutable CacheStats         _stats;
+  mutable size_t             _clock = 0;
+
+  T lerp( const T &a, const T &b, float t ) const { return _lerp_fn ? _lerp_fn( a, b, t ) : detail::traitLerp( a, b, t ); }
+
+  /// Returns the number of bytes block \a index uses once baked.
+  /// Each block stores one more sample than it has intervals so lookups never straddle blocks.
+  size_t blockBytes( size_t index ) const
+  {
+    const size_t intervals = std::min( _block_size, _intervals - index * _block_size );
+    return (intervals + 1) * sizeof( T );
+  }
+
+  const Block& bakedBlock( size_t index ) const
+  {
+    Block &block = _blocks[index];
+    block.last_used = ++_clock;
+
+    if( ! block.samples.empty() ) {
+      return block;
+    }
+
+    const size_t bytes = blockBytes( index );
+    evictToFit( bytes, index );
+
+    const size_t begin = index * _block_size;
+    const size_t count = bytes / sizeof( T );
+    block.samples.reserve( count );
+    for( size_t i = 0; i < count; ++i ) {
+      block.samples.push_back( _source->getValue( this->getDuration() * (begin + i) / _intervals ) );
+    }
+
+    _stats.blocks_baked += 1;
+    _stats.bytes += bytes;
+    _stats.peak_bytes = std::max( _stats.peak_bytes, _stats.bytes );
+    return block;
+  }
+
+  /// Evicts least recently used blocks until \a incoming more bytes fit under the cap.
+  /// Never evicts block \a keep.
+  void evictToFit( size_t incoming, size_t keep ) const
+  {
+    if( ! _max_bytes ) {
+      return;
+    }
+    while( _stats.bytes + incoming > _max_bytes ) {
+      Block *oldest = nullptr;
+      for( size_t i = 0; i < _blocks.size(); ++i ) {
+        auto &block = _blocks[i];
+        if( i != keep && ! block.samples.empty() && (! oldest || block.last_used < oldest->last_used) ) {
+          oldest = &block;
+        }
+      }
+      if( ! oldest ) {
+        // A single block larger than the cap is still baked; there is nothing else to drop.
+        return;
+      }
+      discard( *oldest );
+      _stats.evictions += 1;
+    }
+  }
+
+  void discard( Block &block ) const
+  {
+    if( ! block.samples.empty() ) {
+      _stats.bytes -= block.samples.size() * sizeof( T );
+      std::vector<T>().swap( block.samples );
+    }
+  }
+};
+
+template<typename T>
+using CachedPhraseRef = std::shared_ptr<CachedPhrase<T>>;
+
+} // namespace choreograph
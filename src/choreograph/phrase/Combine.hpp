@@ -47,25 +47,36 @@ class MixPhrase : public Phrase<T>
 public:
   using LerpFn = std::function<T (const T&, const T&, float)>;
 
-  MixPhrase( const PhraseRef<T> &a, const PhraseRef<T> &b, float mix = 0.5f, const LerpFn &fn = &lerpT<T> ):
+  MixPhrase( const PhraseRef<T> &a, const PhraseRef<T> &b, float mix = 0.5f, const LerpFn &fn = detail::traitLerpFn<T>() ):
     Phrase<T>( std::max( a->getDuration(), b->getDuration() ) ),
     _a( a ),
     _b( b ),
     _mix( mix ),
-    _lerp_fn( fn )
+    _lerp_fn( detail::requireLerpFn<T>( fn ) )
   {}
 
   /// Returns a blend of the values of a and b at \a atTime.
   T getValue( Time atTime ) const override {
-    return _lerp_fn( _a->getValue( atTime ), _b->getValue( atTime ), _mix() );
+    return lerp( _a->getValue( atTime ), _b->getValue( atTime ) );
   }
 
   T getStartValue() const override {
-    return _lerp_fn( _a->getStartValue(), _b->getStartValue(), _mix() );
+    return lerp( _a->getStartValue(), _b->getStartValue() );
   }
 
   T getEndValue() const override {
-    return _lerp_fn( _a->getEndValue(), _b->getEndValue(), _mix() );
+    return lerp( _a->getEndValue(), _b->getEndValue() );
+  }
+
+  /// Holds for any mix in [0, 1]. Custom lerp functions and mixes outside it are unbounded.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    if( _lerp_fn || ! detail::has_linear_bounds<T>::value || _mix() < 0 || _mix() > 1 ) {
+      return Bounds<T>::unbounded();
+    }
+    auto bounds = _a->getBounds( from, to );
+    bounds.include( _b->getBounds( from, to ) );
+    return bounds;
   }
 
   /// Sets the balance of the Phrase mix. Values should be in the range [0, 1].
@@ -77,12 +88,20 @@ public:
   /// Returns a pointer to the mix output for animation with a choreograph::Motion.
   Output<float>* getMixOutput() { return &_mix; }
 
+  size_t accountMemory( MemoryCounter &counter ) const override
+  {
+    counter.addPhrase( _a );
+    counter.addPhrase( _b );
+    return sizeof( *this );
+  }
+
 private:
   Output<float> _mix = 0.5f;
   PhraseRef<T>  _a;
   PhraseRef<T>  _b;
   LerpFn        _lerp_fn;
 
+  T lerp( const T &a, const T &b ) const { return _lerp_fn ? _lerp_fn( a, b, _mix() ) : detail::traitLerp( a, b, _mix() ); }
 };
 
 ///
@@ -156,11 +175,33 @@ public:
     return value;
   }
 
+  /// Sums of bounded sources are bounded; other reduce functions are unbounded.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    auto fn = _reduce_fn.template target<T (*)( const T&, const T& )>();
+    if( ! fn || *fn != &AccumulatePhrase<T>::sum ) {
+      return Bounds<T>::unbounded();
+    }
+    Bounds<T> bounds( _initial_value );
+    for( const auto &source : _sources ) {
+      bounds.add( source->getBounds( from, to ) );
+    }
+    return bounds;
+  }
+
   /// Default reduce function sums all inputs.
   static T sum( const T &a, const T &b ) {
     return a + b;
   }
 
+  size_t accountMemory( MemoryCounter &counter ) const override
+  {
+    for( const auto &source : _sources ) {
+      counter.addPhrase( source );
+    }
+    return sizeof( *this ) + _sources.capacity() * sizeof( PhraseRef<T> );
+  }
+
 private:
   // Function to apply to values.
   CombineFunction           _reduce_fn;
@@ -177,7 +218,7 @@ private:
 template<typename T>
 class RaisePhrase : public Phrase<T>
 {
-  using ComponentT = decltype( T().x ); // get the type of the x component. decltype( T()[0] ) doesn't compile with glm's vecN unions.
+  using ComponentT = typename InterpolationTraits<T>::ComponentT;
 
   template<typename... Args>
   RaisePhrase( Time duration, Args&&... args ):
@@ -189,7 +230,7 @@ class RaisePhrase : public Phrase<T>
   {
     T out;
     for( size_t i = 0; i < _sources.size(); ++i ) {
-      out[i] = _sources[i]->getStartValue();
+      InterpolationTraits<T>::setComponent( out, i, _sources[i]->getStartValue() );
     }
     return out;
   }
@@ -198,7 +239,7 @@ class RaisePhrase : public Phrase<T>
   {
     T out;
     for( size_t i = 0; i < _sources.size(); ++i ) {
-      out[i] = _sources[i]->getValue( atTime );
+      InterpolationTraits<T>::setComponent( out, i, _sources[i]->getValue( atTime ) );
     }
     return out;
   }
@@ -207,11 +248,19 @@ class RaisePhrase : public Phrase<T>
   {
     T out;
     for( size_t i = 0; i < _sources.size(); ++i ) {
-      out[i] = _sources[i]->getEndValue();
+      InterpolationTraits<T>::setComponent( out, i, _sources[i]->getEndValue() );
     }
     return out;
   }
 
+  size_t accountMemory( MemoryCounter &counter ) const override
+  {
+    for( const auto &source : _sources ) {
+      counter.addPhrase( source );
+    }
+    return sizeof( *this ) + _sources.capacity() * sizeof( PhraseRef<ComponentT> );
+  }
+
 private:
   std::vector<PhraseRef<ComponentT>> _sources;
 };
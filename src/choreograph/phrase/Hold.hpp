@@ -57,6 +57,19 @@ public:
     return _value;
   }
 
+  void getValueInto( Time /*atTime*/, T &out ) const override { out = _value; }
+
+  bool describeRamp( detail::RampShape<T> *shape ) const override
+  {
+    shape->start = shape->end = &_value;
+    shape->ease = EaseKind::None;
+    return true;
+  }
+
+  Bounds<T> calcBounds( Time /*from*/, Time /*to*/ ) const override { return Bounds<T>( _value ); }
+
+  size_t accountMemory( MemoryCounter &/*counter*/ ) const override { return sizeof( *this ); }
+
 private:
   T       _value;
 };
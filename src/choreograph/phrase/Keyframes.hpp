@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "choreograph/Phrase.hpp"
+#include "choreograph/detail/Components.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <memory>
+
+///
+/// \file
+/// Keyframe tracks store many timed values in contiguous arrays and
+/// interpolate between them, replacing long chains of RampTo phrases.
+///
+
+namespace choreograph
+{
+
+///
+/// KeyframeTrack interpolates linearly between a sorted list of timed values.
+/// Lookups are a binary search, so long tracks stay cheap to evaluate.
+/// The first keyframe is at time zero of the Phrase; duration is the span of the keyframes.
+///
+template<typename T>
+class KeyframeTrack : public Phrase<T>
+{
+public:
+  using LerpFn = std::function<T (const T&, const T&, float)>;
+
+  /// Constructs a track from parallel arrays of keyframe \a times and \a values.
+  /// Times must be sorted and there must be at least one keyframe.
+  /// Interpolates with InterpolationTraits<T> unless given \a lerp_fn.
+  KeyframeTrack( std::vector<Time> times, std::vector<T> values, const LerpFn &lerp_fn = detail::traitLerpFn<T>() ):
+    Phrase<T>( times.back() - times.front() ),
+    _times( std::move( times ) ),
+    _values( std::move( values ) ),
+    _lerp_fn( detail::requireLerpFn<T>( lerp_fn ) )
+  {
+    assert( _times.size() == _values.size() );
+    const Time offset = _times.front();
+    for( auto &t : _times ) {
+      t -= offset;
+    }
+  }
+
+  T getValue( Time at_time ) const override
+  {
+    if( at_time <= 0 ) {
+      return _values.front();
+    }
+    else if( at_time >= this->getDuration() ) {
+      return _values.back();
+    }
+
+    const size_t next = std::upper_bound( _times.begin(), _times.end(), at_time ) - _times.begin();
+    const size_t prev = next - 1;
+    const Time t = (at_time - _times[prev]) / (_times[next] - _times[prev]);
+    return _lerp_fn ? _lerp_fn( _values[prev], _values[next], (float)t ) : detail::traitLerp( _values[prev], _values[next], (float)t );
+  }
+
+  void getValueInto( Time at_time, T &out ) const override
+  {
+    if( at_time <= 0 ) {
+      out = _values.front();
+      return;
+    }
+    else if( at_time >= this->getDuration() ) {
+      out = _values.back();
+      return;
+    }
+
+    const size_t next = std::upper_bound( _times.begin(), _times.end(), at_time ) - _times.begin();
+    const size_t prev = next - 1;
+    const Time t = (at_time - _times[prev]) / (_times[next] - _times[prev]);
+    if( _lerp_fn ) {
+      out = _lerp_fn( _values[prev], _values[next], (float)t );
+    }
+    else {
+      detail::traitLerpInto( _values[prev], _values[next], (float)t, out );
+    }
+  }
+
+  T getStartValue() const override { return _values.front(); }
+  T getEndValue() const override { return _values.back(); }
+
+  /// Linear segments are bounded by the values at the ends of the span and the keyframes inside it.
+  /// Long tracks build a segment tree over their keyframes on first use.
+  Bounds<T> calcBounds( Time from, Time to ) const override;
+
+  /// Returns the number of keyframes in the track.
+  size_t size() const { return _times.size(); }
+
+  const std::vector<Time>& getTimes() const { return _times; }
+  const std::vector<T>&    getValues() const { return _values; }
+
+  size_t accountMemory( MemoryCounter &/*counter*/ ) const override
+  {
+    auto tree = std::atomic_load( &_bounds_tree );
+    const size_t tree_bytes = tree ? sizeof( *tree ) + 2 * tree->size() * sizeof( Bounds<T> ) : 0;
+    return sizeof( *this ) + _times.capacity() * sizeof( Time ) + _values.capacity() * sizeof( T ) + tree_bytes;
+  }
+
+private:
+  std::vector<Time> _times;
+  std::vector<T>    _values;
+  LerpFn            _lerp_fn;
+  /// Built lazily by calcBounds(); accessed atomically so shared tracks can be queried from any thread.
+  mutable std::shared_ptr<const detail::BoundsTree<T>>  _bounds_tree;
+};
+
+template<typename T>
+Bounds<T> KeyframeTrack<T>::calcBounds( Time from, Time to ) const
+{
+  if( _lerp_fn || ! detail::has_linear_bounds<T>::value ) {
+    return Bounds<T>::unbounded();
+  }
+
+  Bounds<T> bounds( getValue( from ), getValue( to ) );
+  const size_t first = std::upper_bound( _times.begin(), _times.end(), from ) - _times.begin();
+  const size_t last = std::lower_bound( _times.begin(), _times.end(), to ) - _times.begin();
+  if( first >= last ) {
+    return bounds;
+  }
+
+  const size_t tree_threshold = 32;
+  if( last - first < tree_threshold )
+  {
+    for( size_t i = first; i < last; ++i ) {
+      bounds.include( _values[i] );
+    }
+    return bounds;
+  }
+
+  auto tree = std::atomic_load( &_bounds_tree );
+  if( ! tree )
+  {
+    std::vector<Bounds<T>> leaves;
+    leaves.reserve( _values.size() );
+    for( const auto &value : _values ) {
+      leaves.emplace_back( value );
+    }
+    tree = std::make_shared<const detail::BoundsTree<T>>( leaves );
+    std::atomic_store( &_bounds_tree, tree );
+  }
+  bounds.include( tree->query( first, last ) );
+  return bounds;
+}
+
+template<typename T>
+using KeyframeTrackRef = std::shared_ptr<KeyframeTrack<T>>;
+
+///
+/// KeyframeFitter turns a stream of timestamped samples into a compact KeyframeTrack.
+/// Fits piecewise-linear segments online (swinging door compression), keeping every
+/// component of every sample within \a tolerance of the fitted track.
+/// Each sample costs O(1) work and no allocation beyond appending emitted keyframes,
+/// so it is suitable for calling from input callbacks.
+///
+/// Works with arithmetic types and vector types with x, y, z, w members.
+///
+template<typename T>
+class KeyframeFitter
+{
+public:
+  using Components = detail::Components<T>;
+  static const size_t Size = Components::size;
+  static_assert( Size > 0, "KeyframeFitter requires an arithmetic or vector-like type." );
+
+  explicit KeyframeFitter( double tolerance ):
+    _tolerance( tolerance )
+  {}
+
+  /// Adds a sample. Samples must arrive in increasing time order; others are ignored.
+  void addSample( Time time, const T &value );
+
+  /// Returns a track fitting all samples added so far and resets the fitter.
+  /// Returns nullptr if no samples were added.
+  KeyframeTrackRef<T> finish( const typename KeyframeTrack<T>::LerpFn &lerp_fn = detail::traitLerpFn<T>() );
+
+  /// Discards all samples and keyframes.
+  void reset() { _times.clear(); _values.clear(); _sample_count = 0; }
+
+  /// Returns the number of samples consumed since the last finish() or reset().
+  size_t getSampleCount() const { return _sample_count; }
+
+  /// Returns the number of keyframes emitted so far. The final keyframe is emitted by finish().
+  size_t getKeyframeCount() const { return _times.size(); }
+
+private:
+  using Vector = std::array<double, Size>;
+
+  double            _tolerance;
+  std::vector<Time> _times;
+  std::vector<T>    _values;
+  size_t            _sample_count = 0;
+
+  // Current segment starts at the anchor; any slope in [low, high] stays within tolerance of all its samples.
+  Time    _anchor_time = 0;
+  Vector  _anchor;
+  Vector  _low;
+  Vector  _high;
+  Time    _last_time = 0;
+  T       _last_value;
+
+  /// Emits a keyframe on the current segment at the last sample's time and starts a new segment there.
+  void emitKeyframe();
+  /// Sets the segment slopes to those reaching \a value at \a time within tolerance.
+  void openSegment( Time time, const T &value );
+};
+
+//=================================================
+// KeyframeFitter Template Implementation.
+//=================================================
+
+template<typename T>
+void KeyframeFitter<T>::addSample( Time time, const T &value )
+{
+  if( _sample_count == 0 )
+  {
+    _times.push_back( time );
+    _values.push_back( value );
+    _anchor_time = time;
+    for( size_t i = 0; i < Size; ++i ) {
+      _anchor[i] = Components::get( value, i );
+    }
+    _low.fill( -std::numeric_limits<double>::infinity() );
+    _high.fill( std::numeric_limits<double>::infinity() );
+  }
+  else if( time <= _last_time )
+  {
+    return;
+  }
+  else
+  {
+    // Narrow the slope corridor; if it closes, the previous sample ends the segment.
+    const double dt = time - _anchor_time;
+    bool closed = false;
+    Vector low, high;
+    for( size_t i = 0; i < Size; ++i )
+    {
+      const double c = Components::get( value, i );
+      low[i] = std::max( _low[i], (c - _tolerance - _anchor[i]) / dt );
+      high[i] = std::min( _high[i], (c + _tolerance - _anchor[i]) / dt );
+      closed = closed || low[i] > high[i];
+    }
+
+    if( closed ) {
+      emitKeyframe();
+      openSegment( time, value );
+    }
+    else {
+      _low = low;
+      _high = high;
+    }
+  }
+
+  _last_time = time;
+  _last_value = value;
+  _sample_count += 1;
+}
+
+template<typename T>
+void KeyframeFitter<T>::emitKeyframe()
+{
+  T key = _last_value;
+  const double dt = _last_time - _anchor_time;
+  for( size_t i = 0; i < Size; ++i )
+  {
+    const double slope = (_low[i] + _high[i]) * 0.5;
+    _anchor[i] = _anchor[i] + slope * dt;
+    Components::set( key, i, static_cast<typename Components::ValueT>( _anchor[i] ) );
+  }
+  _anchor_time = _last_time;
+  _times.push_back( _last_time );
+  _values.push_back( key );
+}
+
+template<typename T>
+void KeyframeFitter<T>::openSegment( Time time, const T &value )
+{
+  const double dt = time - _anchor_time;
+  for( size_t i = 0; i < Size; ++i )
+  {
+    const double c = Components::get( value, i );
+    _low[i] = (c - _tolerance - _anchor[i]) / dt;
+    _high[i] = (c + _tolerance - _anchor[i]) / dt;
+  }
+}
+
+template<typename T>
+KeyframeTrackRef<T> KeyframeFitter<T>::finish( const typename KeyframeTrack<T>::LerpFn &lerp_fn )
+{
+  if( _sample_count == 0 ) {
+    return nullptr;
+  }
+  if( _sample_count > 1 ) {
+    emitKeyframe();
+  }
+
+  auto track = std::make_shared<KeyframeTrack<T>>( std::move( _times ), std::move( _values ), lerp_fn );
+  reset();
+  return track;
+}
+
+} // namespace choreograph
@@ -55,6 +55,8 @@ public:
     return _function( this->normalizeTime( atTime ), this->getDuration() );
   }
 
+  size_t accountMemory( MemoryCounter &/*counter*/ ) const override { return sizeof( *this ); }
+
 private:
   Function  _function;
 };
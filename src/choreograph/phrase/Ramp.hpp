@@ -52,6 +52,7 @@ typedef std::function<float (float)> EaseFn;
 
 ///
 /// RampTo is a phrase that interpolates all components with an ease function.
+/// Interpolates with InterpolationTraits<T> unless given a lerp function.
 ///
 template<typename T>
 class RampTo : public Phrase<T>
@@ -59,33 +60,76 @@ class RampTo : public Phrase<T>
 public:
   using LerpFn = std::function<T (const T&, const T&, float)>;
 
-  RampTo( Time duration, const T &start_value, const T &end_value, const EaseFn &ease_fn = &easeNone, const LerpFn &lerp_fn = &lerpT<T> ):
+  RampTo( Time duration, const T &start_value, const T &end_value, const EaseFn &ease_fn = &easeNone, const LerpFn &lerp_fn = detail::traitLerpFn<T>() ):
     Phrase<T>( duration ),
     _start_value( start_value ),
     _end_value( end_value ),
     _ease_fn( ease_fn ),
-    _lerp_fn( lerp_fn )
+    _lerp_fn( detail::requireLerpFn<T>( lerp_fn ) ),
+    _ease_kind( easeKindOf( ease_fn ) )
   {}
 
   /// Returns the interpolated value at the given time.
   T getValue( Time at_time ) const override
   {
-    return _lerp_fn( _start_value, _end_value, _ease_fn( this->normalizeTime( at_time ) ) );
+    const float t = _ease_fn( this->normalizeTime( at_time ) );
+    return _lerp_fn ? _lerp_fn( _start_value, _end_value, t ) : detail::traitLerp( _start_value, _end_value, t );
+  }
+
+  void getValueInto( Time at_time, T &out ) const override
+  {
+    const float t = _ease_fn( this->normalizeTime( at_time ) );
+    if( _lerp_fn ) {
+      out = _lerp_fn( _start_value, _end_value, t );
+    }
+    else {
+      detail::traitLerpInto( _start_value, _end_value, t, out );
+    }
   }
 
   T getStartValue() const override { return _start_value; }
   T getEndValue() const override { return _end_value; }
 
-  void setStartValue( const T &value ) { _start_value = value; }
-  void setEndValue( const T &value ) { _end_value = value; }
+  size_t accountMemory( MemoryCounter &/*counter*/ ) const override { return sizeof( *this ); }
+
+  bool describeRamp( detail::RampShape<T> *shape ) const override
+  {
+    if( _lerp_fn || _ease_kind == EaseKind::Custom ) {
+      return false;
+    }
+    shape->start = &_start_value;
+    shape->end = &_end_value;
+    shape->ease = _ease_kind;
+    return true;
+  }
+
+  /// Lerped types with linear bounds are bounded by the range of the ease over the span.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    if( _lerp_fn || ! detail::has_linear_bounds<T>::value ) {
+      return Bounds<T>::unbounded();
+    }
+    if( this->getDuration() <= 0 ) {
+      return Bounds<T>( _start_value, _end_value );
+    }
+    float low, high;
+    detail::easeRange( _ease_fn, _ease_kind, this->normalizeTime( from ), this->normalizeTime( to ), &low, &high );
+    return detail::lerpBounds( _start_value, _end_value, low, high );
+  }
+
+  void setStartValue( const T &value ) { _start_value = value; detail::phraseChanged(); }
+  void setEndValue( const T &value ) { _end_value = value; detail::phraseChanged(); }
 
-  void setLerpFn( const LerpFn &lerp_fn ) { _lerp_fn = lerp_fn; }
+  /// Sets a custom interpolation function. Pass nullptr to return to lerpT().
+  /// Throws std::invalid_argument for nullptr if T has no InterpolationTraits<T>::lerp.
+  void setLerpFn( const LerpFn &lerp_fn ) { _lerp_fn = detail::requireLerpFn<T>( lerp_fn ); detail::phraseChanged(); }
 
 private:
   T       _start_value;
   T       _end_value;
-  EaseFn  _ease_fn;
-  LerpFn  _lerp_fn;
+  EaseFn    _ease_fn;
+  LerpFn    _lerp_fn;
+  EaseKind  _ease_kind;
 };
 
 ///
@@ -120,10 +164,12 @@ public:
   T getValue( Time at_time ) const override
   {
     Time t = this->normalizeTime( at_time );
-    T out;
-    for( int i = 0; i < SIZE; ++i )
+    T out( _start_value );
+    for( size_t i = 0; i < SIZE; ++i )
     {
-      out[i] = _componentLerpFn( _start_value[i], _end_value[i], _ease_fns[i]( t ) );
+      const auto a = Traits::component( _start_value, i );
+      const auto b = Traits::component( _end_value, i );
+      Traits::setComponent( out, i, lerpT<ComponentT>( a, b, _ease_fns[i]( t ) ) );
     }
     return out;
   }
@@ -131,11 +177,35 @@ public:
   T getStartValue() const override { return _start_value; }
   T getEndValue() const override { return _end_value; }
 
+  /// Bounds each component by the range of its own ease over the span.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    if( ! detail::has_linear_bounds<ComponentT>::value ) {
+      return Bounds<T>::unbounded();
+    }
+    T low_value( _start_value );
+    T high_value( _start_value );
+    const Time duration = this->getDuration();
+    for( size_t i = 0; i < SIZE; ++i )
+    {
+      float low = 0, high = 1;
+      if( duration > 0 ) {
+        detail::easeRange( _ease_fns[i], easeKindOf( _ease_fns[i] ), from / duration, to / duration, &low, &high );
+      }
+      const auto a = Traits::component( _start_value, i );
+      const auto b = Traits::component( _end_value, i );
+      Traits::setComponent( low_value, i, lerpT<ComponentT>( a, b, low ) );
+      Traits::setComponent( high_value, i, lerpT<ComponentT>( a, b, high ) );
+    }
+    return Bounds<T>( low_value, high_value );
+  }
+
+  size_t accountMemory( MemoryCounter &/*counter*/ ) const override { return sizeof( *this ); }
+
 private:
-  using ComponentT = decltype( T().x ); // get the type of the x component. decltype( T()[0] ) doesn't compile with glm's vecN unions.
-  using ComponentLerpFn = std::function<ComponentT (const ComponentT&, const ComponentT&, float)>;
+  using Traits = InterpolationTraits<T>;
+  using ComponentT = typename Traits::ComponentT;
 
-  ComponentLerpFn           _componentLerpFn = &lerpT<ComponentT>;
   T                         _start_value;
   T                         _end_value;
   std::array<EaseFn, SIZE>  _ease_fns;
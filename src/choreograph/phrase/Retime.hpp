@@ -53,8 +53,21 @@ public:
   {}
 
   T getValue( Time atTime ) const override { return _source->getValueWrapped( atTime, _inflection_point ); }
+  void getValueInto( Time atTime, T &out ) const override { _source->getValueInto( wrapTime( atTime, _source->getDuration(), _inflection_point ), out ); }
   T getStartValue() const override { return _source->getStartValue(); }
   T getEndValue() const override { return _source->getValueWrapped( this->getDuration() ); }
+  /// Past the first pass, the value can be anything the source takes after the inflection point.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    const Time duration = _source->getDuration();
+    if( to <= duration ) {
+      return _source->getBounds( from, to );
+    }
+    Bounds<T> bounds = (from < duration) ? _source->getBounds( from, duration ) : Bounds<T>();
+    bounds.include( _source->getBounds( _inflection_point, duration ) );
+    return bounds;
+  }
+  size_t accountMemory( MemoryCounter &counter ) const override { counter.addPhrase( _source ); return sizeof( *this ); }
 private:
   PhraseRef<T>  _source;
   Time          _inflection_point;
@@ -88,6 +101,22 @@ public:
   }
   T getStartValue() const override { return _source->getStartValue(); }
   T getEndValue() const override { return getValue( this->getDuration() ); }
+  /// Spans within one pass map onto the source; longer spans take the source's full bounds.
+  Bounds<T> calcBounds( Time from, Time to ) const override
+  {
+    const Time duration = _source->getDuration();
+    const Time pass = duration > 0 ? std::floor( from / duration ) : 0;
+    if( duration <= 0 || pass != std::floor( to / duration ) ) {
+      return _source->getBounds();
+    }
+    const Time begin = from - pass * duration;
+    const Time end = to - pass * duration;
+    if( std::fmod( pass, 2.0 ) == 0 ) {
+      return _source->getBounds( begin, end );
+    }
+    return _source->getBounds( duration - end, duration - begin );
+  }
+  size_t accountMemory( MemoryCounter &counter ) const override { counter.addPhrase( _source ); return sizeof( *this ); }
 private:
   PhraseRef<T>  _source;
   Time          _inflection_point;
@@ -107,8 +136,11 @@ public:
   {}
 
   T getValue( Time atTime ) const override { return _source->getValue( _source->getDuration() - atTime ); }
+  void getValueInto( Time atTime, T &out ) const override { _source->getValueInto( _source->getDuration() - atTime, out ); }
   T getStartValue() const override { return _source->getEndValue(); }
   T getEndValue() const override { return _source->getStartValue(); }
+  Bounds<T> calcBounds( Time from, Time to ) const override { return _source->getBounds( _source->getDuration() - to, _source->getDuration() - from ); }
+  size_t accountMemory( MemoryCounter &counter ) const override { counter.addPhrase( _source ); return sizeof( *this ); }
 private:
   PhraseRef<T>  _source;
 };
@@ -130,8 +162,12 @@ public:
   {}
 
   T getValue( Time atTime ) const override { return _source->getValue( clampTime( _begin + atTime ) ); }
+  void getValueInto( Time atTime, T &out ) const override { _source->getValueInto( clampTime( _begin + atTime ), out ); }
+
+  Bounds<T> calcBounds( Time from, Time to ) const override { return _source->getBounds( clampTime( _begin + from ), clampTime( _begin + to ) ); }
 
   Time clampTime( Time t ) const { return std::min( std::min( t, _source->getDuration() ), _end ); }
+  size_t accountMemory( MemoryCounter &counter ) const override { counter.addPhrase( _source ); return sizeof( *this ); }
 private:
   PhraseRef<T>  _source;
   Time          _begin;
@@ -150,6 +186,8 @@ public:
 
   T getValue( Time atTime ) const override { return _source->getValue( stretchTime( atTime ) ); }
   Time stretchTime( Time t ) const { return (t / _source_duration) * _new_duration; }
+  Bounds<T> calcBounds( Time /*from*/, Time /*to*/ ) const override { return _source->getBounds(); }
+  size_t accountMemory( MemoryCounter &counter ) const override { counter.addPhrase( _source ); return sizeof( *this ); }
 private:
   PhraseRef<T> _source;
   Time         _new_duration;
@@ -29,6 +29,7 @@
 
 #include "Retime.hpp"
 #include "Combine.hpp"
+#include "Cached.hpp"
 
 ///
 /// \file
@@ -65,14 +66,14 @@ inline PhraseRef<T> makeReverse( const PhraseRef<T> &source )
 
 /// Create a MixPhrase that blends the value of Phrases \a a and \a b.
 template<typename T>
-inline std::shared_ptr<MixPhrase<T>> makeBlend( const PhraseRef<T> &a, const PhraseRef<T> &b, float mix = 0.5f, const typename MixPhrase<T>::LerpFn &lerp_fn = &lerpT<T> )
+inline std::shared_ptr<MixPhrase<T>> makeBlend( const PhraseRef<T> &a, const PhraseRef<T> &b, float mix = 0.5f, const typename MixPhrase<T>::LerpFn &lerp_fn = detail::traitLerpFn<T>() )
 {
   return std::make_shared<MixPhrase<T>>( a, b, mix, lerp_fn );
 }
 
 /// Create a RampTo that animates from \a a to \a b.
 template<typename T>
-inline std::shared_ptr<RampTo<T>> makeRamp( const T &a, const T &b, Time duration, const EaseFn &ease_fn = &easeNone, const typename RampTo<T>::LerpFn &lerp_fn = &lerpT<T> )
+inline std::shared_ptr<RampTo<T>> makeRamp( const T &a, const T &b, Time duration, const EaseFn &ease_fn = &easeNone, const typename RampTo<T>::LerpFn &lerp_fn = detail::traitLerpFn<T>() )
 {
   return std::make_shared<RampTo<T>>( duration, a, b, ease_fn, lerp_fn );
 }
@@ -99,6 +100,13 @@ else
   return std::make_shared<AccumulatePhrase<T>>( initial_value, a );
 }
 
+/// Create a CachedPhrase that bakes \a source into a table of \a samples_per_second samples.
+template<typename T>
+inline std::shared_ptr<CachedPhrase<T>> makeCached( const PhraseRef<T> &source, Time samples_per_second = 60.0, size_t max_bytes = 0 )
+{
+  return std::make_shared<CachedPhrase<T>>( source, samples_per_second, max_bytes );
+}
+
 ///
 /// Create a ProceduralPhrase that evaluates \a fn over \a duration.
 ///
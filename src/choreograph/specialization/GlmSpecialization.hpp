@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "choreograph/Sequence.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+///
+/// \file
+/// GLM adapter. GLM vectors need nothing special: they are interpolated and batched as packed floats.
+/// Quaternions are slerped. Included by Choreograph.h when CHOREOGRAPH_USE_GLM is defined, and by the Cinder adapter.
+///
+
+namespace choreograph
+{
+
+/// Specialization of InterpolationTraits for quaternions to use slerping.
+/// To prevent disappearing geometry, make sure to normalize your quat targets.
+/// The final value of your tween is what you put in, so make sure it's normalized.
+template<>
+struct InterpolationTraits<glm::quat> : detail::ComponentTraits<glm::quat>
+{
+  static const bool has_slerp = true;
+  static const bool linear_floats = false;
+
+  static glm::quat slerp( const glm::quat &start, const glm::quat &end, float time )
+  {
+    return glm::normalize( glm::slerp( start, end, time ) );
+  }
+
+  static glm::quat lerp( const glm::quat &start, const glm::quat &end, float time ) { return slerp( start, end, time ); }
+};
+
+} // namespace choreograph
@@ -4,17 +4,46 @@
 
 #include "choreograph/Choreograph.h"
 
-#include "cinder/Vector.h"
-#include "cinder/Timeline.h"
-#include "cinder/Timer.h"
+// Define CHOREOGRAPH_BENCHMARK_CINDER to compare against cinder::Timeline (and use Cinder's vectors).
+#if defined( CHOREOGRAPH_BENCHMARK_CINDER )
+  #include "cinder/Vector.h"
+  #include "cinder/Timeline.h"
+#endif
 
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <sstream>
 
 using namespace std;
-using cinder::Timeline;
-using cinder::vec2;
-using cinder::Timer;
 using namespace choreograph;
+#if defined( CHOREOGRAPH_BENCHMARK_CINDER )
+using cinder::vec2;
+using cinder::vec3;
+#else
+using math::vec2;
+using math::vec3;
+#endif
+
+/// Wall-clock stopwatch, started on construction when asked.
+class Timer
+{
+public:
+  explicit Timer( bool start_now = false ) { if( start_now ) { start(); } }
+
+  void    start() { _start = _stop = std::chrono::steady_clock::now(); _running = true; }
+  void    stop() { _stop = std::chrono::steady_clock::now(); _running = false; }
+  double  getSeconds() const { return std::chrono::duration<double>( (_running ? std::chrono::steady_clock::now() : _stop) - _start ).count(); }
+
+private:
+  std::chrono::steady_clock::time_point _start, _stop;
+  bool                                  _running = false;
+};
 
 void printTiming( const std::string &text, double milliseconds, const std::string &suffix = "ms" )
 {
@@ -95,6 +124,37 @@ TEST_CASE( "Sequence Manipulation Timing" )
   auto sub_huge = huge_sequence.slice( 5.55f, 15000.025f );
   slice_huge.stop();
   printTiming( "Slicing Huge Sequence", slice_huge.getSeconds() * 1000 );
+
+  printHeading( "Sequence Simplification" );
+
+  Timer simplify_huge( true );
+  auto simplified = simplify( huge_sequence, 1.0 );
+  simplify_huge.stop();
+  printTiming( "Simplifying Huge Sequence", simplify_huge.getSeconds() * 1000 );
+  printTiming( "Phrases before", huge_sequence.size(), "" );
+  printTiming( "Phrases after", simplified.simplified_phrases, "" );
+  printTiming( "Max error", simplified.max_error, "" );
+  // Every phrase in these Sequences is a RampTo held by a shared_ptr.
+  const double phrase_bytes = sizeof( RampTo<float> ) + 2 * sizeof( void* );
+  printTiming( "Phrase memory before", huge_sequence.size() * phrase_bytes / 1.0e6, "MB" );
+  printTiming( "Phrase memory after", simplified.simplified_phrases * phrase_bytes / 1.0e6, "MB" );
+
+  const int samples = 100;
+  float sum = 0.0f;
+  Timer evaluate_huge( true );
+  for( int i = 0; i < samples; ++i ) {
+    sum += huge_sequence.getValue( huge_sequence.getDuration() * i / samples );
+  }
+  evaluate_huge.stop();
+  printTiming( "Evaluating Huge Sequence (100 samples)", evaluate_huge.getSeconds() * 1000 );
+
+  Timer evaluate_simplified( true );
+  for( int i = 0; i < samples; ++i ) {
+    sum += simplified.sequence.getValue( simplified.sequence.getDuration() * i / samples );
+  }
+  evaluate_simplified.stop();
+  printTiming( "Evaluating Simplified Sequence (100 samples)", evaluate_simplified.getSeconds() * 1000 );
+  REQUIRE( sum == sum );
 }
 
 TEST_CASE( "Choreograph Timeline Basic Performance" )
@@ -158,6 +218,1208 @@ TEST_CASE( "Choreograph Timeline Basic Performance" )
 
 }
 
+TEST_CASE( "Compiled Show Performance" )
+{
+  const size_t track_count = 10e3;
+  const size_t cue_count = 2e3;
+  const Time   show_length = 100.0;
+  const Time   dt = 1.0 / 60.0;
+
+  printHeading( "Show of " + to_string( track_count ) + " Staggered Tracks" );
+
+  // Each track plays for two seconds, so only a few percent are active at once.
+  auto author = [&] ( ch::Timeline &timeline, vector<Output<float>> &targets, int &fired ) {
+    for( size_t i = 0; i < targets.size(); ++i ) {
+      timeline.apply( &targets[i] ).rampTo( 10.0f, 1.0f, EaseInOutQuad() ).rampTo( 0.0f, 1.0f ).setStartTime( show_length * i / targets.size() );
+    }
+    for( size_t i = 0; i < cue_count; ++i ) {
+      timeline.cue( [&fired] { fired += 1; }, show_length * i / cue_count );
+    }
+  };
+
+  vector<Output<float>> timeline_targets( track_count );
+  vector<Output<float>> show_targets( track_count );
+  int timeline_fired = 0;
+  int show_fired = 0;
+
+  ch::Timeline timeline;
+  author( timeline, timeline_targets, timeline_fired );
+
+  Timer compile( true );
+  ch::Timeline authored;
+  author( authored, show_targets, show_fired );
+  auto show = compileShow<float>( authored );
+  authored.clear();
+  compile.stop();
+  printTiming( "Compiling Show", compile.getSeconds() * 1000 );
+
+  Timer step_timeline( true );
+  for( Time t = 0; t < show_length; t += dt ) {
+    timeline.step( dt );
+  }
+  step_timeline.stop();
+
+  Timer step_show( true );
+  for( Time t = 0; t < show_length; t += dt ) {
+    show->step( dt );
+  }
+  step_show.stop();
+
+  Timer seek_show( true );
+  for( int i = 0; i < 100; ++i ) {
+    show->setTime( show_length * i / 100 );
+  }
+  seek_show.stop();
+
+  printTiming( "Timeline Playback (100s at 60Hz)", step_timeline.getSeconds() * 1000 );
+  printTiming( "Show Playback (100s at 60Hz)", step_show.getSeconds() * 1000 );
+  printTiming( "Playback Performance (Show / Timeline)", step_show.getSeconds() / step_timeline.getSeconds(), "" );
+  printTiming( "Show Seek Average", seek_show.getSeconds() * 10 );
+  REQUIRE( show_fired == timeline_fired );
+}
+
+TEST_CASE( "Cached Phrase Scrubbing" )
+{
+  const int octaves = 16;
+  const int passes = 50;
+  const int samples_per_pass = 2000;
+
+  printHeading( "Scrubbing a " + to_string( octaves ) + " Octave Accumulation " + to_string( passes ) + " Times" );
+
+  // A sum of sines, standing in for noise or a deep accumulation stack.
+  PhraseRef<float> layered = make_shared<Hold<float>>( 10.0, 0.0f );
+  for( int i = 0; i < octaves; ++i )
+  {
+    const float frequency = (float)(1 << (i % 8));
+    auto octave = makeProcedure<float>( 10.0, [frequency] ( Time t, Time /*duration*/ ) { return std::sin( (float)t * frequency * 6.28318f ) / frequency; } );
+    layered = makeAccumulator<float>( 0.0f, layered, octave );
+  }
+  auto cached = makeCached( layered, 120.0 );
+  auto looped_source = makePingPong( layered, 4 );
+  auto looped_cached = makePingPong<float>( cached, 4 );
+
+  auto scrub = [=] ( const PhraseRef<float> &phrase ) {
+    float sum = 0.0f;
+    for( int pass = 0; pass < passes; ++pass ) {
+      for( int i = 0; i < samples_per_pass; ++i ) {
+        sum += phrase->getValue( phrase->getDuration() * i / samples_per_pass );
+      }
+    }
+    return sum;
+  };
+
+  Timer source_timer( true );
+  float source_sum = scrub( looped_source );
+  source_timer.stop();
+
+  Timer cached_timer( true );
+  float cached_sum = scrub( looped_cached );
+  cached_timer.stop();
+
+  printTiming( "Source", source_timer.getSeconds() * 1000 );
+  printTiming( "CachedPhrase at 120Hz", cached_timer.getSeconds() * 1000 );
+  printTiming( "Speedup", source_timer.getSeconds() / cached_timer.getSeconds(), "x" );
+  printTiming( "Cache hit rate", cached->getStats().hitRate() * 100, "%" );
+  printTiming( "Cache size", cached->getStats().bytes / 1024.0, "KiB" );
+
+  const float mean_error = std::abs( source_sum - cached_sum ) / (passes * samples_per_pass);
+  REQUIRE( cached->getStats().hitRate() > 0.99 );
+  REQUIRE( mean_error < 0.05f );
+}
+
+TEST_CASE( "Phrase Interning Memory" )
+{
+  const int widgets = 10000;
+  printHeading( "Building Transitions for " + to_string( widgets ) + " UI Widgets" );
+
+  // Every widget fades in, grows on hover, shrinks back and fades out with the same few phrases.
+  auto build = [=] ( ch::Timeline &timeline, vector<Output<float>> &alphas, vector<Output<vec2>> &scales ) {
+    for( int i = 0; i < widgets; ++i )
+    {
+      alphas[i] = 0.0f;
+      scales[i] = vec2( 1.0f );
+      timeline.apply( &alphas[i] )
+        .then<RampTo>( 1.0f, 0.25f, EaseOutCubic() )
+        .hold( 2.0f )
+        .then<RampTo>( 0.0f, 0.25f, EaseInCubic() );
+      timeline.apply( &scales[i] )
+        .then<RampTo>( vec2( 1.1f ), 0.15f, EaseOutQuad() )
+        .then<RampTo>( vec2( 1.0f ), 0.15f, EaseInOutQuad() );
+    }
+  };
+
+  auto countDistinct = [] ( ch::Timeline &timeline ) {
+    std::set<const void*> phrases;
+    for( auto &item : timeline ) {
+      if( auto motion = dynamic_cast<Motion<float>*>( item.get() ) ) {
+        for( size_t i = 0; i < motion->getSequence().getPhraseCount(); ++i ) { phrases.insert( motion->getSequence().getPhraseAtIndex( i ).get() ); }
+      }
+      else if( auto motion = dynamic_cast<Motion<vec2>*>( item.get() ) ) {
+        for( size_t i = 0; i < motion->getSequence().getPhraseCount(); ++i ) { phrases.insert( motion->getSequence().getPhraseAtIndex( i ).get() ); }
+      }
+    }
+    return phrases.size();
+  };
+
+  vector<Output<float>> alphas( widgets ), interned_alphas( widgets );
+  vector<Output<vec2>> scales( widgets ), interned_scales( widgets );
+  ch::Timeline timeline, interned_timeline;
+  auto interner = make_shared<PhraseInterner>();
+  interned_timeline.setPhraseInterner( interner );
+
+  Timer plain_timer( true );
+  build( timeline, alphas, scales );
+  plain_timer.stop();
+
+  Timer interned_timer( true );
+  build( interned_timeline, interned_alphas, interned_scales );
+  interned_timer.stop();
+
+  const size_t plain_phrases = countDistinct( timeline );
+  const size_t interned_phrases = countDistinct( interned_timeline );
+  // Each phrase also owns an ease std::function; the typical Ease struct fits its small buffer.
+  const double phrase_kib = (sizeof( RampTo<vec2> ) + 2 * sizeof( void* )) / 1024.0;
+  const auto stats = interner->getStats();
+
+  printTiming( "Build without interner", plain_timer.getSeconds() * 1000 );
+  printTiming( "Build with interner", interned_timer.getSeconds() * 1000 );
+  printTiming( "Phrases without interner", plain_phrases, "" );
+  printTiming( "Phrases with interner", interned_phrases, "" );
+  printTiming( "Approx. phrase memory without interner", plain_phrases * phrase_kib, "KiB" );
+  printTiming( "Approx. phrase memory with interner", interned_phrases * phrase_kib, "KiB" );
+  printTiming( "Dedup rate", stats.dedupRate() * 100, "%" );
+
+  REQUIRE( plain_phrases == widgets * 5 );
+  REQUIRE( interned_phrases == 5 );
+  REQUIRE( stats.dedupRate() > 0.99 );
+}
+
+TEST_CASE( "Memory per Motion" )
+{
+  const int motions = 1000;
+  printHeading( "Bytes per Motion (" + to_string( motions ) + " Motions)" );
+
+  vector<Output<vec2>> targets( motions );
+  auto measure = [&] ( const std::string &name, const std::function<void (ch::Timeline &, Output<vec2> &)> &build ) {
+    ch::Timeline timeline;
+    for( auto &target : targets ) {
+      build( timeline, target );
+    }
+    const auto usage = timeline.memoryUsage();
+    printTiming( name, usage.total() / (double)motions, "B" );
+    return usage;
+  };
+
+  measure( "Single RampTo", [] ( ch::Timeline &timeline, Output<vec2> &target ) {
+    timeline.apply( &target ).then<RampTo>( vec2( 1.0f ), 1.0f );
+  } );
+  measure( "Four Phrases", [] ( ch::Timeline &timeline, Output<vec2> &target ) {
+    timeline.apply( &target ).then<RampTo>( vec2( 1.0f ), 0.5f, EaseOutQuad() ).hold( 0.5f ).then<RampTo>( vec2( 0.0f ), 0.5f ).hold( 0.5f );
+  } );
+  measure( "RampTo with Callbacks", [] ( ch::Timeline &timeline, Output<vec2> &target ) {
+    timeline.apply( &target ).then<RampTo>( vec2( 1.0f ), 1.0f ).startFn( [] {} ).finishFn( [] {} ).getControl();
+  } );
+  measure( "Looped RampTo", [] ( ch::Timeline &timeline, Output<vec2> &target ) {
+    timeline.apply( &target, makeRepeat<vec2>( makeRamp( vec2( 0.0f ), vec2( 1.0f ), 1.0f ), 4 ) );
+  } );
+  auto interner = make_shared<PhraseInterner>();
+  auto interned = measure( "Four Phrases, interned", [interner] ( ch::Timeline &timeline, Output<vec2> &target ) {
+    timeline.setPhraseInterner( interner );
+    timeline.apply( &target ).then<RampTo>( vec2( 1.0f ), 0.5f, EaseOutQuad() ).hold( 0.5f ).then<RampTo>( vec2( 0.0f ), 0.5f ).hold( 0.5f );
+  } );
+
+  printTiming( "Interned: items", interned.items / (double)motions, "B" );
+  printTiming( "Interned: callbacks", interned.callbacks / (double)motions, "B" );
+  printTiming( "Interned: index", interned.index / (double)motions, "B" );
+  printTiming( "Interned: phrases", interned.phrases / (double)motions, "B" );
+  REQUIRE( interned.phrase_count == 4 );
+}
+
+TEST_CASE( "Cue Track Performance" )
+{
+  const int cue_count = 10000;
+  const Time duration = 100.0;
+  const int frames = (int)(duration * 60);
+  printHeading( "Playing " + to_string( cue_count ) + " Cues over " + to_string( frames ) + " Frames" );
+
+  int cue_calls = 0, track_calls = 0;
+  ch::Timeline cue_timeline, track_timeline;
+  cue_timeline.setDefaultRemoveOnFinish( false );
+  auto track = detail::make_unique<CueTrack>( [&track_calls] ( uint32_t ) { track_calls += 1; } );
+  track->reserve( cue_count );
+  for( int i = 0; i < cue_count; ++i )
+  {
+    const Time t = duration * (i + 0.5) / cue_count;
+    cue_timeline.cue( [&cue_calls] { cue_calls += 1; }, t );
+    track->add( t, (uint32_t)i );
+  }
+  track_timeline.add( std::move( track ) ).removeOnFinish( false );
+
+  Timer cue_timer( true );
+  for( int i = 0; i < frames; ++i ) {
+    cue_timeline.step( 1.0 / 60 );
+  }
+  cue_timer.stop();
+
+  Timer track_timer( true );
+  for( int i = 0; i < frames; ++i ) {
+    track_timeline.step( 1.0 / 60 );
+  }
+  track_timer.stop();
+
+  printTiming( "Timeline::cue", cue_timer.getSeconds() * 1000 );
+  printTiming( "CueTrack", track_timer.getSeconds() * 1000 );
+  printTiming( "Speedup", cue_timer.getSeconds() / track_timer.getSeconds(), "x" );
+  printTiming( "Timeline::cue bytes per cue", cue_timeline.memoryUsage().total() / (double)cue_count, "B" );
+  printTiming( "CueTrack bytes per cue", track_timeline.memoryUsage().total() / (double)cue_count, "B" );
+
+  REQUIRE( cue_calls == cue_count );
+  REQUIRE( track_calls == cue_count );
+}
+
+TEST_CASE( "Timeline Executor Scaling" )
+{
+  const int scenes = 500;
+  const int motions_per_scene = 8;
+  const int frames = 200;
+  printHeading( "Stepping " + to_string( scenes ) + " Timelines of " + to_string( motions_per_scene ) + " Motions, " + to_string( frames ) + " Frames" );
+
+  vector<ch::Timeline> timelines( scenes );
+  vector<Output<vec2>> targets( scenes * motions_per_scene );
+  for( int i = 0; i < scenes; ++i )
+  {
+    timelines[i].setDefaultRemoveOnFinish( false );
+    for( int j = 0; j < motions_per_scene; ++j ) {
+      auto &target = targets[i * motions_per_scene + j];
+      target = vec2( 0.0f );
+      timelines[i].apply( &target ).then<RampTo>( vec2( 1.0f, (float)j ), 4.0f, EaseInOutQuad() ).then<RampTo>( vec2( 0.0f ), 4.0f, EaseInOutSine() );
+    }
+  }
+
+  Timer serial_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    for( auto &timeline : timelines ) {
+      timeline.step( 1.0 / 60 );
+    }
+  }
+  serial_timer.stop();
+  printTiming( "Serial", serial_timer.getSeconds() * 1000 );
+
+  const size_t max_threads = max<size_t>( thread::hardware_concurrency(), 2 );
+  for( size_t threads = 1; threads <= max_threads; threads *= 2 )
+  {
+    TimelineExecutor executor( threads );
+    for( auto &timeline : timelines ) {
+      timeline.setTime( 0 );
+      executor.add( &timeline );
+    }
+
+    Timer timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      executor.step( 1.0 / 60 );
+    }
+    timer.stop();
+    printTiming( "Executor, " + to_string( threads ) + " threads", timer.getSeconds() * 1000 );
+    printTiming( "Executor, " + to_string( threads ) + " threads speedup", serial_timer.getSeconds() / timer.getSeconds(), "x" );
+  }
+
+  REQUIRE( targets.back()().x == Approx( 1.0f ).epsilon( 0.2 ) );
+}
+
+TEST_CASE( "Sequence Hot Swap" )
+{
+  const int frames = 100000;
+  printHeading( "Stepping a Motion " + to_string( frames ) + " Frames While Publishing Sequences" );
+
+  Output<vec2> target( vec2( 0.0f ) );
+  auto sequence = Sequence<vec2>( vec2( 0.0f ) ).then<RampTo>( vec2( 1.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 0.0f ), 1.0f );
+  Motion<vec2> motion( &target, sequence );
+
+  Timer idle_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    motion.jumpTo( (f % 120) / 60.0 );
+  }
+  idle_timer.stop();
+
+  std::atomic<bool> done( false );
+  std::atomic<int> published( 0 );
+  std::thread publisher( [&] {
+    while( ! done ) {
+      motion.publish( Sequence<vec2>( vec2( 0.0f ) ).then<RampTo>( vec2( (float)published, 1.0f ), 2.0f ) );
+      ++published;
+      std::this_thread::yield();
+    }
+  } );
+
+  Timer swap_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    motion.jumpTo( (f % 120) / 60.0 );
+  }
+  swap_timer.stop();
+  done = true;
+  publisher.join();
+  motion.reclaim();
+
+  printTiming( "Step, nothing published", idle_timer.getSeconds() * 1000 );
+  printTiming( "Step, publishing concurrently", swap_timer.getSeconds() * 1000 );
+  printTiming( "Sequences published", published, "" );
+
+  REQUIRE( published > 0 );
+}
+
+TEST_CASE( "In-place Evaluation" )
+{
+  const int weights = 256;
+  const int frames = 20000;
+  printHeading( "Evaluating " + to_string( weights ) + " Blend Weights, " + to_string( frames ) + " Frames" );
+
+  auto sequence = Sequence<vector<float>>( vector<float>( weights, 0.0f ) )
+    .then<RampTo>( vector<float>( weights, 1.0f ), 1.0f, EaseInOutQuad() )
+    .then<RampTo>( vector<float>( weights, 0.0f ), 1.0f );
+  vector<float> out( weights );
+
+  Timer value_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    out = sequence.getValue( (f % 120) / 60.0 );
+  }
+  value_timer.stop();
+  const float value_result = out[weights / 2];
+
+  Timer into_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    sequence.getValueInto( (f % 120) / 60.0, out );
+  }
+  into_timer.stop();
+
+  printTiming( "getValue", value_timer.getSeconds() * 1000 );
+  printTiming( "getValueInto", into_timer.getSeconds() * 1000 );
+  printTiming( "Speedup", value_timer.getSeconds() / into_timer.getSeconds(), "x" );
+
+  REQUIRE( out[weights / 2] == value_result );
+}
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+TEST_CASE( "Shared Memory Frame Latency" )
+{
+  const int channels = 64;
+  const int frames = 20000;
+  printHeading( "Publishing " + to_string( channels ) + " vec2 Outputs to Shared Memory, " + to_string( frames ) + " Frames" );
+
+  vector<Output<vec2>> outputs( channels );
+  SharedFramePublisher publisher( "choreograph_benchmark", channels );
+  for( int i = 0; i < channels; ++i ) {
+    outputs[i] = vec2( (float)i );
+    publisher.addOutput( "output_" + to_string( i ), &outputs[i] );
+  }
+  SharedFrameSubscriber subscriber( "choreograph_benchmark" );
+
+  int reads = 0;
+  for( int f = 0; f < frames; ++f ) {
+    publisher.publish( f / 60.0 );
+    reads += subscriber.read() ? 1 : 0;
+  }
+
+  printTiming( "Publish mean", publisher.getPublishLatency().mean() / 1000.0, "us" );
+  printTiming( "Publish max", publisher.getPublishLatency().max / 1000.0, "us" );
+  printTiming( "Read mean", subscriber.getReadLatency().mean() / 1000.0, "us" );
+  printTiming( "Read max", subscriber.getReadLatency().max / 1000.0, "us" );
+  printTiming( "Frame age mean", subscriber.getFrameAge().mean() / 1000.0, "us" );
+
+  REQUIRE( reads == frames );
+  REQUIRE( subscriber.getValue<vec2>( channels - 1 ).x == (float)(channels - 1) );
+}
+#endif
+
+TEST_CASE( "Follow Performance" )
+{
+  const int followers = 1000;
+  const int frames = 600;
+  printHeading( to_string( followers ) + " Outputs Chasing a Moving Target, " + to_string( frames ) + " Frames" );
+
+  Output<vec2> leader( vec2( 0.0f ) );
+
+  // Restarting a short ramp toward the target every frame.
+  vector<Output<vec2>> ramped( followers );
+  ch::Timeline ramp_timeline;
+  Timer ramp_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    leader = vec2( (float)f, 0.0f );
+    for( auto &o : ramped ) {
+      ramp_timeline.apply( &o ).then<RampTo>( leader(), 0.25f );
+    }
+    ramp_timeline.step( 1.0 / 60 );
+  }
+  ramp_timer.stop();
+
+  vector<Output<vec2>> followed( followers );
+  ch::Timeline follow_timeline;
+  for( auto &o : followed ) {
+    o = vec2( 0.0f );
+    follow_timeline.addShared( make_shared<Follow<vec2>>( &o, &leader, FollowMode::Exponential, 8.0f ) );
+  }
+  Timer follow_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    leader = vec2( (float)f, 0.0f );
+    follow_timeline.step( 1.0 / 60 );
+  }
+  follow_timer.stop();
+
+  vector<Output<vec2>> grouped( followers );
+  auto group = make_shared<FollowGroup<vec2>>( FollowMode::Exponential, 8.0f );
+  for( auto &o : grouped ) {
+    o = vec2( 0.0f );
+    group->add( &o, &leader );
+  }
+  ch::Timeline group_timeline;
+  group_timeline.addShared( group );
+  Timer group_timer( true );
+  for( int f = 0; f < frames; ++f ) {
+    leader = vec2( (float)f, 0.0f );
+    group_timeline.step( 1.0 / 60 );
+  }
+  group_timer.stop();
+
+  printTiming( "Re-applied RampTo", ramp_timer.getSeconds() * 1000 );
+  printTiming( "Follow items", follow_timer.getSeconds() * 1000 );
+  printTiming( "FollowGroup", group_timer.getSeconds() * 1000 );
+  printTiming( "Follow speedup", ramp_timer.getSeconds() / follow_timer.getSeconds(), "x" );
+  printTiming( "FollowGroup speedup", ramp_timer.getSeconds() / group_timer.getSeconds(), "x" );
+
+  REQUIRE( followed.back()().x == grouped.back()().x );
+}
+
+TEST_CASE( "Batch Evaluation Performance" )
+{
+  const int motions = 20000;
+  const int frames = 200;
+  printHeading( "Stepping " + to_string( motions ) + " vec2 Motions, " + to_string( frames ) + " Frames, by Bucket Mix" );
+
+  struct Mix
+  {
+    string          name;
+    vector<EaseFn>  eases;
+    float           procedural_fraction;
+  };
+  const vector<Mix> mixes = {
+    { "linear ramps", { EaseNone() }, 0.0f },
+    { "five eases", { EaseNone(), EaseInQuad(), EaseOutCubic(), EaseInOutQuad(), EaseInOutSine() }, 0.0f },
+    { "five eases, 25% procedural", { EaseNone(), EaseInQuad(), EaseOutCubic(), EaseInOutQuad(), EaseInOutSine() }, 0.25f }
+  };
+
+  for( const auto &mix : mixes )
+  {
+    vector<Output<vec2>> plain_targets( motions ), batched_targets( motions );
+    ch::Timeline plain, batched;
+    batched.setBatchEvaluation( true );
+    for( auto timeline : { &plain, &batched } )
+    {
+      auto &targets = (timeline == &plain) ? plain_targets : batched_targets;
+      for( int i = 0; i < motions; ++i )
+      {
+        targets[i] = vec2( 0.0f );
+        const auto &ease = mix.eases[i % mix.eases.size()];
+        if( (i % 100) < mix.procedural_fraction * 100 ) {
+          timeline->apply( &targets[i] ).then( make_shared<ProceduralPhrase<vec2>>( 4.0f, [] (Time t, Time /*d*/) { return vec2( (float)t, 1.0f ); } ) );
+        }
+        else {
+          timeline->apply( &targets[i] ).then<RampTo>( vec2( (float)i, 1.0f ), 2.0f, ease ).then<Hold>( vec2( 1.0f ), 2.0f );
+        }
+      }
+    }
+
+    Timer plain_timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      plain.step( 1.0 / 60 );
+    }
+    plain_timer.stop();
+
+    Timer batched_timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      batched.step( 1.0 / 60 );
+    }
+    batched_timer.stop();
+
+    const auto stats = batched.getBatchStats();
+    printTiming( mix.name + ", virtual", plain_timer.getSeconds() * 1000 );
+    printTiming( mix.name + ", batched", batched_timer.getSeconds() * 1000 );
+    printTiming( mix.name + ", speedup", plain_timer.getSeconds() / batched_timer.getSeconds(), "x" );
+    printTiming( mix.name + ", buckets", stats.buckets, "" );
+    printTiming( mix.name + ", fallback items", stats.fallback, "" );
+
+    const bool same = batched_targets.back()().x == plain_targets.back()().x;
+    REQUIRE( same );
+  }
+}
+
+TEST_CASE( "Async Cue Frame Time" )
+{
+  const int motions = 1000;
+  const int heavy_cues = 10;
+  const int frames = 120;
+  printHeading( "Stepping " + to_string( motions ) + " Motions with " + to_string( heavy_cues ) + " Heavy Cues over " + to_string( frames ) + " Frames" );
+
+  // Stands in for decoding an asset: about a millisecond of arithmetic.
+  atomic<uint64_t> sink( 0 );
+  auto heavy = [&sink] {
+    uint64_t x = 1;
+    for( int i = 0; i < 2000000; ++i ) {
+      x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    sink += x;
+  };
+
+  CueWorker worker;
+  for( bool async : { false, true } )
+  {
+    ch::Timeline timeline;
+    vector<Output<vec2>> targets( motions );
+    for( auto &target : targets ) {
+      timeline.apply( &target ).then<RampTo>( vec2( 1.0f ), 2.0f, EaseInOutQuad() );
+    }
+    int resumed = 0;
+    CueCompletionRef completion;
+    for( int i = 0; i < heavy_cues; ++i )
+    {
+      auto options = timeline.cue( heavy, (i + 0.5) * frames / 60.0 / heavy_cues );
+      if( async ) {
+        options.async( worker.getExecutor() ).then( [&resumed] { resumed += 1; } );
+        completion = options.getCompletion();
+      }
+    }
+
+    double worst = 0, total = 0;
+    for( int f = 0; f < frames; ++f )
+    {
+      Timer frame( true );
+      timeline.step( 1.0 / 60 );
+      frame.stop();
+      worst = max( worst, frame.getSeconds() * 1000 );
+      total += frame.getSeconds() * 1000;
+    }
+
+    const string name = async ? "async" : "inline";
+    printTiming( name + ", mean step", total / frames );
+    printTiming( name + ", worst step", worst );
+    if( async )
+    {
+      // Frames here aren't paced, so cues pile up in the worker's queue.
+      completion->wait();
+      while( resumed < heavy_cues ) {
+        timeline.step( 0 );
+      }
+      printTiming( name + ", mean queue latency", completion->getQueueLatency().mean() / 1.0e6 );
+      REQUIRE( resumed == heavy_cues );
+    }
+  }
+}
+
+TEST_CASE( "Presentation Peek Cost" )
+{
+  const int motions = 10000;
+  const int frames = 120;
+  printHeading( "Presenting " + to_string( motions ) + " vec2 Motions 2 Frames Ahead, " + to_string( frames ) + " Frames" );
+
+  ch::Timeline timeline;
+  vector<Output<vec2>> targets( motions );
+  for( int i = 0; i < motions; ++i ) {
+    timeline.apply( &targets[i] ).then<RampTo>( vec2( (float)i, 1.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 0.0f ), 3.0f, EaseOutCubic() );
+  }
+
+  PresentationBuffer buffer;
+  double step_ms = 0, present_ms = 0;
+  for( int f = 0; f < frames; ++f )
+  {
+    Timer step( true );
+    timeline.step( 1.0 / 60 );
+    step.stop();
+
+    Timer present( true );
+    timeline.present( 2.0 / 60, buffer );
+    present.stop();
+
+    // The first present allocates storage for every target.
+    if( f > 0 ) {
+      step_ms += step.getSeconds() * 1000;
+      present_ms += present.getSeconds() * 1000;
+    }
+  }
+
+  printTiming( "step per frame", step_ms / (frames - 1) );
+  printTiming( "present per frame", present_ms / (frames - 1) );
+  printTiming( "present per Motion", present_ms * 1.0e6 / (frames - 1) / motions, "ns" );
+  printTiming( "present / step", present_ms / step_ms, "x" );
+  printTiming( "buffer bytes per Motion", buffer.getStorageSize() / (double)motions, "B" );
+
+  REQUIRE( buffer.size() == motions );
+}
+
+TEST_CASE( "Fixed Timestep Performance" )
+{
+  const int motions = 10000;
+  const int frames = 288;
+  printHeading( "Displaying " + to_string( motions ) + " vec2 Motions at 144Hz, " + to_string( frames ) + " Frames" );
+
+  for( Time fixed_dt : { 0.0, 1.0 / 60, 1.0 / 240 } )
+  {
+    ch::Timeline timeline;
+    timeline.setFixedTimestep( fixed_dt );
+    vector<Output<vec2>> targets( motions );
+    for( int i = 0; i < motions; ++i ) {
+      timeline.apply( &targets[i] ).then<RampTo>( vec2( (float)i, 1.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 0.0f ), 2.0f, EaseOutCubic() );
+    }
+
+    Timer timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      timeline.step( 1.0 / 144 );
+    }
+    timer.stop();
+
+    const string name = (fixed_dt > 0) ? "fixed " + to_string( (int)std::round( 1 / fixed_dt ) ) + "Hz" : "variable";
+    printTiming( name + ", per frame", timer.getSeconds() * 1000 / frames );
+    if( fixed_dt > 0 ) {
+      printTiming( name + ", substeps per frame", timeline.getFixedStepStats().total_substeps / (double)frames, "" );
+    }
+  }
+}
+
+TEST_CASE( "Looping Motion Cost" )
+{
+  const int motions = 10000;
+  const int frames = 120;
+  const Time one_week = 7 * 24 * 60 * 60;
+  printHeading( "Stepping " + to_string( motions ) + " looping vec2 Motions, one week in, " + to_string( frames ) + " Frames" );
+
+  for( bool native : { false, true } )
+  {
+    ch::Timeline timeline;
+    vector<Output<vec2>> targets( motions );
+    for( int i = 0; i < motions; ++i )
+    {
+      auto cycle = Sequence<vec2>( vec2( 0.0f ) ).then<RampTo>( vec2( (float)i, 1.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 0.0f ), 1.0f, EaseOutCubic() );
+      if( native ) {
+        timeline.apply( &targets[i], cycle ).loop();
+      }
+      else {
+        timeline.apply( &targets[i] ).then( makeRepeat<vec2>( cycle.asPhrase(), 1.0e9f ) );
+      }
+    }
+    timeline.step( one_week );
+
+    Timer timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      timeline.step( 1.0 / 60 );
+    }
+    timer.stop();
+
+    printTiming( string( native ? "Motion loop" : "LoopPhrase" ) + ", per frame", timer.getSeconds() * 1000 / frames );
+  }
+}
+
+TEST_CASE( "Bounds Queries and Culling" )
+{
+  const int phrases = 10000;
+  const int queries = 1000;
+  printHeading( "Bounding " + to_string( queries ) + " Spans of a " + to_string( phrases ) + " Phrase vec2 Sequence" );
+
+  Sequence<vec2> sequence( vec2( 0.0f ) );
+  for( int i = 0; i < phrases; ++i ) {
+    sequence.then<RampTo>( vec2( (float)(i % 101), (float)(i % 37) ), 0.5f, EaseInOutQuad() );
+  }
+
+  Timer sampled_timer( true );
+  float sink = 0;
+  for( int q = 0; q < queries; ++q )
+  {
+    // Sampling at 60Hz over a 10s span.
+    const Time from = (q * 7919) % (phrases / 2 - 10);
+    vec2 low = sequence.getValue( from ), high = low;
+    for( int i = 1; i <= 600; ++i ) {
+      const vec2 v = sequence.getValue( from + i / 60.0 );
+      low = vec2( std::min( low.x, v.x ), std::min( low.y, v.y ) );
+      high = vec2( std::max( high.x, v.x ), std::max( high.y, v.y ) );
+    }
+    sink += low.x + high.y;
+  }
+  sampled_timer.stop();
+
+  sequence.getBounds( 0, 1 );
+  Timer bounds_timer( true );
+  for( int q = 0; q < queries; ++q )
+  {
+    const Time from = (q * 7919) % (phrases / 2 - 10);
+    const auto bounds = sequence.getBounds( from, from + 10.0 );
+    sink += bounds.getMin().x + bounds.getMax().y;
+  }
+  bounds_timer.stop();
+
+  printTiming( "Sampled at 60Hz, per query", sampled_timer.getSeconds() * 1.0e6 / queries, "us" );
+  printTiming( "getBounds(), per query", bounds_timer.getSeconds() * 1.0e6 / queries, "us" );
+  REQUIRE( sink != 0 );
+
+  const int motions = 10000;
+  const int frames = 120;
+  printHeading( "Stepping " + to_string( motions ) + " vec2 Motions, 10% in view, " + to_string( frames ) + " Frames" );
+
+  for( bool cull : { false, true } )
+  {
+    ch::Timeline timeline;
+    vector<Output<vec2>> targets( motions );
+    for( int i = 0; i < motions; ++i ) {
+      const vec2 start( (float)(i % 100) * 100.0f, 0.0f );
+      timeline.apply( &targets[i] ).set( start ).then<RampTo>( start + vec2( 50.0f, 100.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( start, 2.0f, EaseOutCubic() );
+    }
+    if( cull ) {
+      timeline.setCullTest<vec2>( [] ( const Bounds<vec2> &bounds ) { return bounds.intersects( Bounds<vec2>( vec2( 0.0f ), vec2( 999.0f ) ) ); } );
+    }
+
+    Timer timer( true );
+    for( int f = 0; f < frames; ++f ) {
+      timeline.step( 1.0 / 60 );
+    }
+    timer.stop();
+
+    printTiming( string( cull ? "culled" : "unculled" ) + ", per frame", timer.getSeconds() * 1000 / frames );
+    if( cull ) {
+      printTiming( "culled Motions", (double)timeline.getCulledCount(), "" );
+    }
+  }
+}
+
+//=================================================
+// Sequence evaluation matrix.
+//
+// Environment variables:
+//   CHOREOGRAPH_BENCHMARK_JSON        write results to this path as JSON.
+//   CHOREOGRAPH_BENCHMARK_BASELINE    compare results against JSON written by a previous run.
+//   CHOREOGRAPH_BENCHMARK_TOLERANCE   slowdown reported as a regression; default 0.1 (10%).
+//   CHOREOGRAPH_BENCHMARK_MAX_LENGTH  longest Sequence to build; default 1000000.
+//=================================================
+
+namespace {
+
+struct MatrixResult
+{
+  string  type;
+  string  phrase;
+  size_t  length;
+  string  access;
+  double  ns_per_sample;
+
+  string  name() const { return type + "/" + phrase + "/" + to_string( length ) + "/" + access; }
+};
+
+const size_t         MatrixBatchSize = 64;
+const vector<string> MatrixAccess = { "sequential", "reversed", "random", "sorted-batch" };
+
+template<typename T> T matrixValue( float v );
+template<> float matrixValue<float>( float v ) { return v; }
+template<> vec2 matrixValue<vec2>( float v ) { return vec2( v, v * 2.0f ); }
+template<> vec3 matrixValue<vec3>( float v ) { return vec3( v, v * 2.0f, v * 3.0f ); }
+template<> math::quat matrixValue<math::quat>( float v ) { return math::angleAxis( v, math::vec3( 0, 0, 1 ) ); }
+
+template<typename T>
+float matrixChecksum( const T &value ) { return detail::Components<T>::get( value, 0 ); }
+
+/// Named factories for one-second Phrases from a to b, one per kind of Phrase in the matrix.
+template<typename T>
+vector<pair<string, function<PhraseRef<T> (const T&, const T&)>>> matrixPhrases()
+{
+  using Ramp = RampTo<T>;
+  vector<pair<string, function<PhraseRef<T> (const T&, const T&)>>> phrases;
+
+  phrases.emplace_back( "Hold", [] ( const T &/*a*/, const T &b ) { return make_shared<Hold<T>>( 1.0, b ); } );
+
+  const vector<pair<string, EaseFn>> eases = {
+    { "None", EaseNone() },
+    { "InQuad", EaseInQuad() }, { "OutQuad", EaseOutQuad() }, { "InOutQuad", EaseInOutQuad() }, { "OutInQuad", EaseOutInQuad() },
+    { "InCubic", EaseInCubic() }, { "OutCubic", EaseOutCubic() }, { "InOutCubic", EaseInOutCubic() }, { "OutInCubic", EaseOutInCubic() },
+    { "InQuart", EaseInQuart() }, { "OutQuart", EaseOutQuart() }, { "InOutQuart", EaseInOutQuart() }, { "OutInQuart", EaseOutInQuart() },
+    { "InQuint", EaseInQuint() }, { "OutQuint", EaseOutQuint() }, { "InOutQuint", EaseInOutQuint() }, { "OutInQuint", EaseOutInQuint() },
+    { "InSine", EaseInSine() }, { "OutSine", EaseOutSine() }, { "InOutSine", EaseInOutSine() }, { "OutInSine", EaseOutInSine() },
+    { "InExpo", EaseInExpo() }, { "OutExpo", EaseOutExpo() }, { "InOutExpo", EaseInOutExpo() }, { "OutInExpo", EaseOutInExpo() },
+    { "InCirc", EaseInCirc() }, { "OutCirc", EaseOutCirc() }, { "InOutCirc", EaseInOutCirc() }, { "OutInCirc", EaseOutInCirc() },
+    { "InBounce", EaseInBounce() }, { "OutBounce", EaseOutBounce() }, { "InOutBounce", EaseInOutBounce() }, { "OutInBounce", EaseOutInBounce() },
+    { "InBack", EaseInBack() }, { "OutBack", EaseOutBack() }, { "InOutBack", EaseInOutBack() }, { "OutInBack", EaseOutInBack() },
+    { "InElastic", EaseInElastic( 1.0f, 0.3f ) }, { "OutElastic", EaseOutElastic( 1.0f, 0.3f ) },
+    { "InOutElastic", EaseInOutElastic( 1.0f, 0.3f ) }, { "OutInElastic", EaseOutInElastic( 1.0f, 0.3f ) },
+    { "InAtan", EaseInAtan() }, { "OutAtan", EaseOutAtan() }, { "InOutAtan", EaseInOutAtan() }
+  };
+  for( const auto &ease : eases ) {
+    const auto fn = ease.second;
+    phrases.emplace_back( "RampTo " + ease.first, [fn] ( const T &a, const T &b ) { return make_shared<Ramp>( 1.0, a, b, fn ); } );
+  }
+
+  phrases.emplace_back( "RampToN", [] ( const T &a, const T &b ) {
+    return make_shared<RampToN<detail::Components<T>::size, T>>( 1.0, a, b, EaseInQuad(), EaseOutQuad(), EaseInOutQuad(), EaseNone() );
+  } );
+  phrases.emplace_back( "Loop", [] ( const T &a, const T &b ) {
+    return make_shared<LoopPhrase<T>>( make_shared<Ramp>( 0.5, a, b, EaseInOutQuad() ), 2.0f );
+  } );
+  phrases.emplace_back( "PingPong", [] ( const T &a, const T &b ) {
+    return make_shared<PingPongPhrase<T>>( make_shared<Ramp>( 0.5, a, b, EaseInOutQuad() ), 2.0f );
+  } );
+  phrases.emplace_back( "Reverse", [] ( const T &a, const T &b ) {
+    return make_shared<ReversePhrase<T>>( make_shared<Ramp>( 1.0, b, a, EaseInOutQuad() ) );
+  } );
+  phrases.emplace_back( "Clip", [] ( const T &a, const T &b ) {
+    return make_shared<ClipPhrase<T>>( make_shared<Ramp>( 2.0, a, b, EaseInOutQuad() ), 0.5, 1.5 );
+  } );
+  phrases.emplace_back( "Mix", [] ( const T &a, const T &b ) {
+    return make_shared<MixPhrase<T>>( make_shared<Ramp>( 1.0, a, b, EaseInOutQuad() ), make_shared<Ramp>( 1.0, a, b, EaseInQuad() ), 0.5f );
+  } );
+  phrases.emplace_back( "Accumulate", [] ( const T &a, const T &b ) {
+    return make_shared<AccumulatePhrase<T>>( a, make_shared<Ramp>( 1.0, a, b, EaseInOutQuad() ), make_shared<Ramp>( 1.0, a, b, EaseInQuad() ) );
+  } );
+  phrases.emplace_back( "SequencePhrase", [] ( const T &a, const T &b ) {
+    Sequence<T> inner( a );
+    inner.template then<Hold>( a, 0.5 ).template then<RampTo>( b, 0.5, EaseInOutQuad() );
+    return make_shared<SequencePhrase<T>>( inner );
+  } );
+
+  return phrases;
+}
+
+/// Returns the sample times for \a access over a Sequence of \a duration.
+vector<Time> matrixTimes( const string &access, Time duration, size_t samples )
+{
+  vector<Time> times( samples );
+  if( access == "sequential" || access == "reversed" )
+  {
+    for( size_t i = 0; i < samples; ++i ) {
+      times[i] = duration * i / samples;
+    }
+    if( access == "reversed" ) {
+      reverse( times.begin(), times.end() );
+    }
+  }
+  else
+  {
+    mt19937 rng( 2015 );
+    uniform_real_distribution<Time> dist( 0.0, duration );
+    for( auto &t : times ) {
+      t = dist( rng );
+    }
+    if( access == "sorted-batch" ) {
+      for( size_t i = 0; i < samples; i += MatrixBatchSize ) {
+        sort( times.begin() + i, times.begin() + min( i + MatrixBatchSize, samples ) );
+      }
+    }
+  }
+  return times;
+}
+
+/// Returns the fastest of \a repetitions passes over \a times, in ns/sample.
+template<typename T>
+double measureMatrixCell( const Sequence<T> &sequence, const vector<Time> &times, bool batched, int repetitions, float *checksum )
+{
+  double best = numeric_limits<double>::max();
+  vector<T> batch( MatrixBatchSize );
+
+  for( int r = 0; r < repetitions; ++r )
+  {
+    Timer timer( true );
+    if( batched )
+    {
+      for( size_t i = 0; i < times.size(); i += MatrixBatchSize ) {
+        const auto count = min( MatrixBatchSize, times.size() - i );
+        for( size_t j = 0; j < count; ++j ) {
+          sequence.getValueInto( times[i + j], batch[j] );
+        }
+        *checksum += matrixChecksum( batch[count - 1] );
+      }
+    }
+    else
+    {
+      for( auto t : times ) {
+        *checksum += matrixChecksum( sequence.getValue( t ) );
+      }
+    }
+    timer.stop();
+    best = min( best, timer.getSeconds() * 1.0e9 / times.size() );
+  }
+  return best;
+}
+
+template<typename T>
+void runMatrix( const string &type, size_t max_length, vector<MatrixResult> *results, float *checksum )
+{
+  printHeading( "Sequence<" + type + "> Evaluation (ns/sample: sequential, reversed, random, sorted-batch)" );
+
+  const T a = matrixValue<T>( 0.25f );
+  const T b = matrixValue<T>( 1.0f );
+
+  for( const auto &phrase : matrixPhrases<T>() )
+  {
+    for( size_t length = 1; length <= max_length; length *= 100 )
+    {
+      Sequence<T> sequence( a );
+      for( size_t i = 0; i < length; ++i ) {
+        sequence.then( (i % 2) ? phrase.second( b, a ) : phrase.second( a, b ) );
+      }
+
+      // Lookup walks the Sequence, so keep long Sequences to a similar total cost.
+      const size_t samples = max<size_t>( 8, min<size_t>( 1 << 14, (size_t( 1 ) << 22) / length ) );
+      const int repetitions = length >= 100000 ? 1 : 3;
+
+      string row;
+      for( const auto &access : MatrixAccess )
+      {
+        const auto times = matrixTimes( access, sequence.getDuration(), samples );
+        const auto ns = measureMatrixCell( sequence, times, access == "sorted-batch", repetitions, checksum );
+        results->push_back( MatrixResult{ type, phrase.first, length, access, ns } );
+
+        auto number = to_string( ns );
+        row += string( max<int>( 1, 12 - (int)number.find( '.' ) ), ' ' ) + number.substr( 0, number.find( '.' ) + 3 );
+      }
+
+      string message = "[" + phrase.first + " x" + to_string( length ) + "] ";
+      if( message.size() < 40 ) {
+        message = message + string( 40 - message.size(), '.' );
+      }
+      cout << message << row << endl;
+    }
+  }
+}
+
+void writeMatrixJson( const string &path, const vector<MatrixResult> &results )
+{
+  ofstream file( path );
+  file << "{\n  \"benchmark\": \"Sequence Evaluation Matrix\",\n  \"unit\": \"ns/sample\",\n  \"results\": [\n";
+  for( size_t i = 0; i < results.size(); ++i )
+  {
+    const auto &r = results[i];
+    // One result per line; readMatrixBaseline() relies on it.
+    file << "    { \"name\": \"" << r.name() << "\", \"type\": \"" << r.type << "\", \"phrase\": \"" << r.phrase
+         << "\", \"length\": " << r.length << ", \"access\": \"" << r.access << "\", \"ns_per_sample\": " << r.ns_per_sample
+         << (i + 1 < results.size() ? " },\n" : " }\n");
+  }
+  file << "  ]\n}\n";
+}
+
+/// Reads name -> ns/sample from JSON written by writeMatrixJson().
+map<string, double> readMatrixBaseline( const string &path )
+{
+  map<string, double> baseline;
+  ifstream file( path );
+  string line;
+  const string name_key = "\"name\": \"";
+  const string value_key = "\"ns_per_sample\": ";
+  while( getline( file, line ) )
+  {
+    const auto name = line.find( name_key );
+    const auto value = line.find( value_key );
+    if( name == string::npos || value == string::npos ) {
+      continue;
+    }
+    const auto begin = name + name_key.size();
+    baseline[line.substr( begin, line.find( '"', begin ) - begin )] = strtod( line.c_str() + value + value_key.size(), nullptr );
+  }
+  return baseline;
+}
+
+} // namespace
+
+TEST_CASE( "Sequence Evaluation Matrix" )
+{
+  const char *json_path = getenv( "CHOREOGRAPH_BENCHMARK_JSON" );
+  const char *baseline_path = getenv( "CHOREOGRAPH_BENCHMARK_BASELINE" );
+  const char *tolerance_text = getenv( "CHOREOGRAPH_BENCHMARK_TOLERANCE" );
+  const char *max_length_text = getenv( "CHOREOGRAPH_BENCHMARK_MAX_LENGTH" );
+
+  const double tolerance = tolerance_text ? strtod( tolerance_text, nullptr ) : 0.1;
+  const size_t max_length = max_length_text ? (size_t)strtod( max_length_text, nullptr ) : 1000000;
+
+  vector<MatrixResult> results;
+  float checksum = 0;
+
+  runMatrix<float>( "float", max_length, &results, &checksum );
+  runMatrix<vec2>( "vec2", max_length, &results, &checksum );
+  runMatrix<vec3>( "vec3", max_length, &results, &checksum );
+  runMatrix<math::quat>( "quat", max_length, &results, &checksum );
+
+  // Keeps the evaluations from being optimized away.
+  CHECK( checksum == checksum );
+
+  if( json_path ) {
+    writeMatrixJson( json_path, results );
+    cout << endl << "Wrote " << results.size() << " results to " << json_path << endl;
+  }
+
+  if( baseline_path )
+  {
+    const auto baseline = readMatrixBaseline( baseline_path );
+    printHeading( string( "Comparison with " ) + baseline_path + " (new / baseline)" );
+
+    size_t compared = 0, regressed = 0, improved = 0;
+    for( const auto &r : results )
+    {
+      const auto previous = baseline.find( r.name() );
+      if( previous == baseline.end() || previous->second <= 0 ) {
+        continue;
+      }
+      compared += 1;
+      const double ratio = r.ns_per_sample / previous->second;
+      if( ratio > 1.0 + tolerance ) {
+        regressed += 1;
+        printTiming( "Slower: " + r.name(), ratio, "x" );
+      }
+      else if( ratio < 1.0 - tolerance ) {
+        improved += 1;
+      }
+    }
+    cout << compared << " cells compared: " << regressed << " slower and " << improved << " faster than baseline by more than "
+         << tolerance * 100 << "%; " << results.size() - compared << " not in baseline." << endl;
+  }
+}
+
+TEST_CASE( "Keyframe Import Throughput" )
+{
+  const int rows = 200e3;
+  const int channels = 8;
+
+  printHeading( "Importing " + to_string( rows ) + " Rows of " + to_string( channels ) + " Channels" );
+
+  stringstream csv, json;
+  csv << "time";
+  for( int c = 0; c < channels; ++c ) {
+    csv << ",channel_" << c;
+  }
+  csv << "\n";
+  json << "[\n";
+  for( int i = 0; i < rows; ++i )
+  {
+    csv << i / 60.0;
+    json << (i ? ",\n" : "") << "{\"time\": " << i / 60.0;
+    for( int c = 0; c < channels; ++c ) {
+      const double value = sin( i * 0.01 * (c + 1) ) * 100.0;
+      csv << "," << value;
+      json << ", \"channel_" << c << "\": " << value;
+    }
+    csv << "\n";
+    json << "}";
+  }
+  json << "\n]\n";
+
+  auto measure = [] ( const string &name, stringstream &stream, const function<KeyframeImport (istream&)> &fn ) {
+    stream.clear();
+    stream.seekg( 0 );
+    Timer timer( true );
+    auto import = fn( stream );
+    timer.stop();
+    printTiming( name, timer.getSeconds() * 1000 );
+    printTiming( name + " Throughput", import.bytes / 1.0e6 / timer.getSeconds(), "MB/s" );
+    return import;
+  };
+
+  ImportOptions fitted;
+  fitted.tolerance = 0.01;
+
+  auto raw = measure( "CSV Import", csv, [] ( istream &s ) { return importKeyframesCsv( s ); } );
+  measure( "CSV Import with Fitting", csv, [&] ( istream &s ) { return importKeyframesCsv( s, fitted ); } );
+  measure( "JSON Import", json, [] ( istream &s ) { return importKeyframesJson( s ); } );
+  auto fit = measure( "JSON Import with Fitting", json, [&] ( istream &s ) { return importKeyframesJson( s, fitted ); } );
+  printTiming( "Keyframes per Channel (raw)", raw.channels.front().track->size(), "" );
+  printTiming( "Keyframes per Channel (fitted)", fit.channels.front().track->size(), "" );
+
+  // For comparison, building the same channel by hand from RampTo phrases.
+  Timer hand_built( true );
+  const auto &track = *raw.channels.front().track;
+  Sequence<float> sequence( track.getValues().front() );
+  for( size_t i = 1; i < track.size(); ++i ) {
+    sequence.then<RampTo>( track.getValues()[i], track.getTimes()[i] - track.getTimes()[i - 1] );
+  }
+  hand_built.stop();
+  printTiming( "Hand-built Sequence (one channel)", hand_built.getSeconds() * 1000 );
+  REQUIRE( raw.rows == rows );
+}
+
+template<typename FastFn, typename ExactFn>
+void compareEase( const std::string &name, FastFn fast, ExactFn exact )
+{
+  const int samples = 1e6;
+  float fast_sum = 0, exact_sum = 0, max_error = 0;
+
+  Timer exact_timer( true );
+  for( int i = 0; i < samples; ++i ) {
+    exact_sum += exact( i / (float)samples );
+  }
+  exact_timer.stop();
+
+  Timer fast_timer( true );
+  for( int i = 0; i < samples; ++i ) {
+    fast_sum += fast( i / (float)samples );
+  }
+  fast_timer.stop();
+
+  for( int i = 0; i < samples; i += 7 ) {
+    max_error = std::max( max_error, std::abs( fast( i / (float)samples ) - exact( i / (float)samples ) ) );
+  }
+
+  printTiming( name + " Exact", exact_timer.getSeconds() * 1000 );
+  printTiming( name + " Fast", fast_timer.getSeconds() * 1000 );
+  printTiming( name + " Speedup", exact_timer.getSeconds() / fast_timer.getSeconds(), "x" );
+  printTiming( name + " Max Error", max_error * 1.0e6, "e-6" );
+  // Keep the sums alive so the loops aren't optimized away.
+  REQUIRE( std::abs( fast_sum - exact_sum ) < samples * 1.0e-3f );
+}
+
+TEST_CASE( "Fast Ease Performance" )
+{
+  printHeading( "Fast Eases (1M samples each)" );
+  compareEase( "InOutSine", fast::EaseInOutSine(), EaseInOutSine() );
+  compareEase( "OutInSine", fast::EaseOutInSine(), EaseOutInSine() );
+  compareEase( "InExpo", fast::EaseInExpo(), EaseInExpo() );
+  compareEase( "InOutExpo", fast::EaseInOutExpo(), EaseInOutExpo() );
+  compareEase( "OutElastic", fast::EaseOutElastic( 1.5f, 0.3f ), EaseOutElastic( 1.5f, 0.3f ) );
+  compareEase( "InOutElastic", fast::EaseInOutElastic( 1.5f, 0.3f ), EaseInOutElastic( 1.5f, 0.3f ) );
+  compareEase( "InOutAtan", fast::EaseInOutAtan(), EaseInOutAtan() );
+
+  // Through RampTo, where eases are called via std::function.
+  Sequence<float> exact_sequence( 0.0f ), fast_sequence( 0.0f );
+  exact_sequence.then<RampTo>( 1.0f, 1.0f, EaseInOutElastic( 1.5f, 0.3f ) );
+  fast_sequence.then<RampTo>( 1.0f, 1.0f, fast::EaseInOutElastic( 1.5f, 0.3f ) );
+  compareEase( "RampTo InOutElastic",
+    [&] ( float t ) { return fast_sequence.getValue( t ); },
+    [&] ( float t ) { return exact_sequence.getValue( t ); } );
+}
+
+template<typename T>
+void compareInterpolation( const std::string &name, const T &a, const T &b )
+{
+  const int samples = 1e6;
+  RampTo<T> trait_ramp( 1.0, a, b );
+  RampTo<T> function_ramp( 1.0, a, b );
+  // A stored std::function lerp, as every RampTo used before InterpolationTraits.
+  function_ramp.setLerpFn( [] ( const T &a, const T &b, float t ) { return a + (b - a) * t; } );
+
+  T trait_sum = a, function_sum = a;
+  Timer function_timer( true );
+  for( int i = 0; i < samples; ++i ) {
+    function_sum = function_sum + function_ramp.getValue( i / (Time)samples );
+  }
+  function_timer.stop();
+
+  Timer trait_timer( true );
+  for( int i = 0; i < samples; ++i ) {
+    trait_sum = trait_sum + trait_ramp.getValue( i / (Time)samples );
+  }
+  trait_timer.stop();
+
+  printTiming( name + " RampTo with LerpFn", function_timer.getSeconds() * 1000 );
+  printTiming( name + " RampTo with InterpolationTraits", trait_timer.getSeconds() * 1000 );
+  printTiming( name + " Speedup", function_timer.getSeconds() / trait_timer.getSeconds(), "x" );
+  REQUIRE( trait_sum.x == Approx( function_sum.x ) );
+}
+
+TEST_CASE( "Interpolation Performance" )
+{
+  printHeading( "Interpolation (1M samples each)" );
+  compareInterpolation( "vec2", vec2( 0.0f ), vec2( 10.0f, 5.0f ) );
+  compareInterpolation( "vec3", vec3( 0.0f ), vec3( 10.0f, 5.0f, 1.0f ) );
+}
+
+#if defined( CHOREOGRAPH_BENCHMARK_CINDER )
+
 TEST_CASE( "Comparative Performance with cinder::Timeline" )
 {
   ch::Timeline    choreograph_timeline;
@@ -294,3 +1556,5 @@ TEST_CASE( "Comparative Performance with cinder::Timeline" )
     printTiming( "Step Performance (Choreograph / Cinder)", (ch_step_avg / ci_step_avg), "" );
   }
 }
+
+#endif // CHOREOGRAPH_BENCHMARK_CINDER
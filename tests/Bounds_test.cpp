@@ -0,0 +1,224 @@
+//
+//  Bounds_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+struct Point
+{
+  Point() = default;
+  Point( float x, float y ): x( x ), y( y ) {}
+  float x = 0, y = 0;
+};
+
+Point operator+ ( const Point &a, const Point &b ) { return Point( a.x + b.x, a.y + b.y ); }
+Point operator- ( const Point &a, const Point &b ) { return Point( a.x - b.x, a.y - b.y ); }
+Point operator* ( const Point &a, float s ) { return Point( a.x * s, a.y * s ); }
+
+/// Checks that \a bounds contain every sampled value of \a sequence in [from, to].
+bool containsSamples( const Bounds<float> &bounds, const Sequence<float> &sequence, Time from, Time to )
+{
+  for( int i = 0; i <= 200; ++i ) {
+    if( ! bounds.contains( sequence.getValue( from + (to - from) * i / 200.0 ) ) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE( "Bounds" )
+{
+  SECTION( "Ramps with monotone eases are bounded by their values at the ends of the span." )
+  {
+    auto ramp = makeRamp( 0.0f, 10.0f, 2.0f, EaseInOutQuad() );
+    auto bounds = ramp->getBounds( 0.5, 1.0 );
+    REQUIRE( bounds.isBounded() );
+    REQUIRE( bounds.getMin() == Approx( ramp->getValue( 0.5 ) ) );
+    REQUIRE( bounds.getMax() == Approx( 5.0f ) );
+
+    // Spans outside the Phrase are clamped to it.
+    REQUIRE( ramp->getBounds( -1.0, 4.0 ).getMax() == Approx( 10.0f ) );
+  }
+
+  SECTION( "Custom eases that overshoot are bounded conservatively." )
+  {
+    auto ramp = makeRamp( 0.0f, 10.0f, 1.0f, [] ( float t ) { return easeOutBack( t ); } );
+    auto bounds = ramp->getBounds();
+    REQUIRE( bounds.getMax() > 10.0f );
+    for( int i = 0; i <= 1000; ++i ) {
+      REQUIRE( bounds.contains( ramp->getValue( i / 1000.0 ) ) );
+    }
+  }
+
+  SECTION( "Vector components are bounded separately." )
+  {
+    auto sequence = Sequence<Point>( Point( 0, 0 ) )
+      .then<RampTo>( Point( 10, -10 ), 1.0f )
+      .then<RampTo2>( Point( 0, 0 ), 1.0f, EaseInQuad(), EaseOutQuad() );
+    auto bounds = sequence.getBounds( 0.5, 1.5 );
+    REQUIRE( bounds.getMin().x == Approx( 5.0f ) );
+    REQUIRE( bounds.getMax().x == Approx( 10.0f ) );
+    REQUIRE( bounds.getMin().y == Approx( -10.0f ) );
+    REQUIRE( bounds.getMax().y == Approx( -2.5f ) );
+  }
+
+  SECTION( "Long Sequences answer from a segment tree with the same bounds as short ones." )
+  {
+    Sequence<float> sequence( 0.0f );
+    for( int i = 0; i < 200; ++i ) {
+      sequence.then<RampTo>( (float)((i * 37) % 101), 0.5f, EaseInOutCubic() );
+    }
+    sequence.then<Hold>( 500.0f, 0.0f );
+
+    const vector<pair<Time, Time>> spans = { { 0.0, 0.1 }, { 3.3, 9.7 }, { 20.0, 20.0 }, { 12.5, 80.0 }, { -1.0, 200.0 } };
+    for( const auto &span : spans )
+    {
+      auto bounds = sequence.getBounds( span.first, span.second );
+      REQUIRE( containsSamples( bounds, sequence, span.first, span.second ) );
+
+      // Piecewise, a Sequence of the same Phrases gives the same answer without the tree.
+      Bounds<float> expected;
+      Time start = 0;
+      for( size_t i = 0; i < sequence.getPhraseCount(); ++i ) {
+        const auto &phrase = sequence.getPhraseAtIndex( i );
+        if( start + phrase->getDuration() >= span.first && start <= span.second ) {
+          expected.include( phrase->getBounds( span.first - start, span.second - start ) );
+        }
+        start += phrase->getDuration();
+      }
+      if( span.first < 0 ) {
+        expected.include( 0.0f );
+      }
+      if( span.second >= sequence.getDuration() ) {
+        expected.include( sequence.getEndValue() );
+      }
+      REQUIRE( bounds.getMin() == expected.getMin() );
+      REQUIRE( bounds.getMax() == expected.getMax() );
+    }
+    REQUIRE( sequence.getBounds().getMax() == 500.0f );
+  }
+
+  SECTION( "Cached bounds follow changes to Phrases." )
+  {
+    Sequence<float> sequence( 0.0f );
+    for( int i = 0; i < 40; ++i ) {
+      sequence.then<RampTo>( 1.0f, 1.0f );
+    }
+    auto ramp = static_pointer_cast<RampTo<float>>( sequence.getPhraseAtIndex( 20 ) );
+    REQUIRE( sequence.getBounds( 5, 30 ).getMax() == 1.0f );
+
+    const uint64_t epoch = detail::phraseEpoch().load();
+    detail::invalidateBatches();
+    REQUIRE( detail::phraseEpoch().load() == epoch );
+
+    ramp->setEndValue( 50.0f );
+    REQUIRE( detail::phraseEpoch().load() != epoch );
+    REQUIRE( sequence.getBounds( 5, 30 ).getMax() == 50.0f );
+
+    sequence.then<RampTo>( 100.0f, 1.0f );
+    REQUIRE( sequence.getBounds().getMax() == 100.0f );
+  }
+
+  SECTION( "Retimed and combined Phrases bound their sources." )
+  {
+    auto ramp = makeRamp( 0.0f, 10.0f, 1.0f );
+    REQUIRE( makeReverse<float>( ramp )->getBounds( 0.0, 0.25 ).getMin() == Approx( 7.5f ) );
+    REQUIRE( makeRepeat<float>( ramp, 4.0f )->getBounds( 2.1, 2.2 ).getMin() == Approx( 0.0f ) );
+    REQUIRE( make_shared<ClipPhrase<float>>( ramp, 0.5, 1.0 )->getBounds().getMin() == Approx( 5.0f ) );
+
+    auto sum = make_shared<AccumulatePhrase<float>>( 1.0f, ramp, makeRamp( 0.0f, -2.0f, 1.0f ) );
+    REQUIRE( sum->getBounds().getMin() == Approx( -1.0f ) );
+    REQUIRE( sum->getBounds().getMax() == Approx( 11.0f ) );
+  }
+
+  SECTION( "Keyframe tracks include keyframes inside the span." )
+  {
+    vector<Time> times;
+    vector<float> values;
+    for( int i = 0; i < 1000; ++i ) {
+      times.push_back( i * 0.1 );
+      values.push_back( (float)((i * 53) % 97) );
+    }
+    KeyframeTrack<float> track( times, values );
+
+    auto bounds = track.getBounds( 10.05, 60.0 );
+    float low = track.getValue( 10.05 ), high = low;
+    for( size_t i = 101; i <= 600; ++i ) {
+      low = min( low, values[i] );
+      high = max( high, values[i] );
+    }
+    REQUIRE( bounds.getMin() == low );
+    REQUIRE( bounds.getMax() == high );
+    REQUIRE( track.getBounds( 10.05, 10.08 ).getMax() < 100.0f );
+  }
+
+  SECTION( "Phrases that can't bound themselves are unbounded." )
+  {
+    auto sequence = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 1.0f )
+      .then( make_shared<ProceduralPhrase<float>>( 1.0f, [] ( Time t, Time /*duration*/ ) { return (float)t; } ) );
+    REQUIRE( sequence.getBounds( 0.0, 0.5 ).isBounded() );
+    REQUIRE( sequence.getBounds( 0.0, 1.5 ).isUnbounded() );
+  }
+}
+
+TEST_CASE( "Culling" )
+{
+  Timeline timeline;
+  vector<Output<Point>> points( 10 );
+  // Points move right from x = i * 100 by 50 units per second; the viewport covers x in [0, 300].
+  for( size_t i = 0; i < points.size(); ++i ) {
+    timeline.apply( &points[i] ).set( Point( i * 100.0f, 0 ) ).then<RampTo>( Point( i * 100.0f + 500.0f, 0 ), 10.0f );
+  }
+  timeline.setCullTest<Point>( [] ( const Bounds<Point> &bounds ) {
+    return bounds.intersects( Bounds<Point>( Point( 0, -1 ), Point( 300, 1 ) ) );
+  } );
+  timeline.setCullWindow( 1.0 );
+
+  timeline.step( 0.1 );
+  // Over the next second, only the first three points reach the viewport.
+  REQUIRE( timeline.getCulledCount() == 7 );
+  REQUIRE( points[2]().x == Approx( 205.0f ) );
+  REQUIRE( points[3]().x == 0.0f );
+
+  timeline.clearCullTests();
+  timeline.step( 0.0 );
+  REQUIRE( timeline.getCulledCount() == 0 );
+  REQUIRE( points[3]().x == Approx( 305.0f ) );
+
+  timeline.setCullTest<Point>( [] ( const Bounds<Point> &/*bounds*/ ) { return false; } );
+  timeline.step( 0.1 );
+  REQUIRE( timeline.getCulledCount() == 10 );
+  REQUIRE( points[3]().x == Approx( 305.0f ) );
+
+  // Culled Motions still write their final value when they finish.
+  for( int i = 0; i < 100; ++i ) {
+    timeline.step( 0.1 );
+  }
+  REQUIRE( timeline.empty() );
+  REQUIRE( points[9]().x == 1400.0f );
+
+  // Moved Timelines keep their cull tests and window.
+  Output<Point> far;
+  Timeline source;
+  source.apply( &far ).set( Point( 1000, 0 ) ).then<RampTo>( Point( 2000, 0 ), 10.0f );
+  source.setCullTest<Point>( [] ( const Bounds<Point> &/*bounds*/ ) { return false; } );
+  source.setCullWindow( 2.0 );
+  source.step( 0.1 );
+
+  Timeline moved( std::move( source ) );
+  REQUIRE( moved.getCullWindow() == 2.0 );
+  REQUIRE( moved.getCulledCount() == 1 );
+  moved.step( 0.1 );
+  REQUIRE( moved.getCulledCount() == 1 );
+  REQUIRE( far().x == 0.0f );
+}
@@ -0,0 +1,144 @@
+//
+//  Clock_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+TEST_CASE( "Clock Driver" )
+{
+  Timeline timeline;
+
+  SECTION( "A steady clock drives the timeline exactly." )
+  {
+    auto clock = make_shared<SimulatedClock>();
+    ClockDriver driver( timeline, clock );
+
+    for( int i = 0; i < 120; i += 1 )
+    {
+      driver.update();
+      clock->advance( 1.0 / 60.0 );
+    }
+    driver.update();
+
+    REQUIRE( timeline.time() == Approx( 2.0 ) );
+    REQUIRE( abs( driver.getStats().max_error ) < 1.0e-6 );
+    REQUIRE( driver.getStats().updates == 121 );
+  }
+
+  SECTION( "Block-quantized clocks with frame jitter produce even steps without drift." )
+  {
+    auto clock = make_shared<SampleClock>( 48000.0 );
+    ClockDriver driver( timeline, clock );
+
+    // Frames arrive every 1/60s ± 2ms; the clock advances in 256-sample blocks.
+    double   truth = 0;
+    uint64_t samples = 0;
+    uint32_t seed = 1;
+    Time     previous = 0;
+    Time     max_raw_deviation = 0, max_step_deviation = 0, error_sum = 0, max_slew = 0;
+    int      count = 0;
+
+    for( int i = 0; i < 600; i += 1 )
+    {
+      seed = seed * 1664525u + 1013904223u;
+      truth += 1.0 / 60.0 + (int( (seed >> 8) % 4001 ) - 2000) * 1.0e-6;
+      while( samples + 256 <= uint64_t( truth * 48000.0 ) ) {
+        samples += 256;
+      }
+      const Time raw = samples / 48000.0 - clock->now();
+      clock->setSampleCount( samples );
+
+      driver.update();
+      const Time step = timeline.time() - previous;
+      previous = timeline.time();
+
+      if( i > 120 )
+      {
+        max_raw_deviation = max( max_raw_deviation, abs( raw - 1.0 / 60.0 ) );
+        max_step_deviation = max( max_step_deviation, abs( step - 1.0 / 60.0 ) );
+        max_slew = max( max_slew, abs( driver.getStats().slew - 1 ) );
+        error_sum += driver.getStats().error;
+        count += 1;
+      }
+    }
+
+    REQUIRE( max_raw_deviation > 0.005 );
+    REQUIRE( max_step_deviation < 0.0025 );
+    REQUIRE( abs( error_sum / count ) < 0.001 );
+    REQUIRE( max_slew <= 0.05 + 1.0e-9 );
+  }
+
+  SECTION( "Drift is slewed away gradually." )
+  {
+    auto clock = make_shared<SimulatedClock>();
+    ClockDriver driver( timeline, clock );
+    driver.update();
+
+    // Knock the timeline 50ms ahead of its clock.
+    timeline.step( 0.05f );
+
+    Time max_slew = 0;
+    for( int i = 0; i < 180; i += 1 )
+    {
+      clock->advance( 1.0 / 60.0 );
+      driver.update();
+      max_slew = max( max_slew, abs( driver.getStats().slew - 1 ) );
+    }
+
+    REQUIRE( max_slew == Approx( 0.05 ) );
+    REQUIRE( abs( driver.getStats().error ) < 0.001 );
+  }
+
+  SECTION( "Jumps seek, skipping cues, or scrub, firing them." )
+  {
+    auto clock = make_shared<SimulatedClock>();
+    ClockDriver driver( timeline, clock );
+    int  cue_count = 0;
+    timeline.cue( [&cue_count] { cue_count += 1; }, 1.0f );
+
+    driver.update();
+    clock->set( 2.0 );
+
+    driver.update();
+    REQUIRE( cue_count == 0 );
+    REQUIRE( timeline.time() == Approx( 2.0 ) );
+
+    timeline.cue( [&cue_count] { cue_count += 1; }, 1.0f );
+    driver.setJumpPolicy( ClockJump::Scrub );
+    clock->set( 4.0 );
+    driver.update();
+    REQUIRE( cue_count == 1 );
+    REQUIRE( timeline.time() == Approx( 4.0 ) );
+
+    REQUIRE( driver.getStats().jumps == 2 );
+    REQUIRE( abs( driver.getStats().error ) < 1.0e-6 );
+  }
+
+  SECTION( "Jumps land on the clock time for items that start later." )
+  {
+    auto clock = make_shared<SimulatedClock>();
+    Output<float> target = 0.0f;
+    Motion<float> motion( &target, Sequence<float>( 0.0f ).then<RampTo>( 10.0f, 10.0f ) );
+    motion.setStartTime( 1.0 );
+    ClockDriver driver( motion, clock );
+
+    driver.update();
+    REQUIRE( motion.time() == Approx( -1.0 ) );
+
+    clock->set( 4.0 );
+    driver.update();
+    REQUIRE( driver.getStats().jumps == 1 );
+    REQUIRE( motion.time() == Approx( 3.0 ) );
+    REQUIRE( abs( driver.getStats().error ) < 1.0e-6 );
+
+    driver.setJumpPolicy( ClockJump::Scrub );
+    clock->set( 2.0 );
+    driver.update();
+    REQUIRE( motion.time() == Approx( 1.0 ) );
+    REQUIRE( target() == Approx( 1.0f ) );
+  }
+}
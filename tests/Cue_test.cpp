@@ -7,6 +7,8 @@
 
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
+#include <stdexcept>
+#include <thread>
 
 using namespace choreograph;
 using namespace std;
@@ -84,3 +86,161 @@ TEST_CASE( "Cues" )
     }
   }
 }
+
+TEST_CASE( "Cue Tracks" )
+{
+  ch::Timeline timeline;
+  vector<int> fired;
+  auto track = detail::make_unique<CueTrack>( [&fired] ( uint32_t id ) { fired.push_back( id ); } );
+  auto &cues = *track;
+  cues.add( 3.0, 3u );
+  cues.add( 1.0, 1u );
+  cues.add( 2.0, 2u );
+  cues.add( 2.0, 20u );
+  cues.add( 0.0, [&fired] { fired.push_back( 0 ); } );
+  timeline.add( std::move( track ) ).removeOnFinish( false );
+
+  SECTION( "Cues fire in time order, each once per crossing." )
+  {
+    REQUIRE( cues.getDuration() == 3.0 );
+    timeline.step( 0.5 );
+    REQUIRE( (fired == vector<int>{ 0 }) );
+    timeline.step( 2.0 );
+    REQUIRE( (fired == vector<int>{ 0, 1, 2, 20 }) );
+    timeline.step( 0.5 );
+    REQUIRE( (fired == vector<int>{ 0, 1, 2, 20, 3 }) );
+    timeline.step( 1.0 );
+    REQUIRE( fired.size() == 5 );
+  }
+
+  SECTION( "Scrubbing back fires crossed cues in reverse, and forward again." )
+  {
+    timeline.jumpTo( 3.0 );
+    fired.clear();
+    // A cue fires when the playhead reaches it, so leaving the cue at 3 doesn't fire it again.
+    timeline.jumpTo( 1.5 );
+    REQUIRE( (fired == vector<int>{ 20, 2 }) );
+    fired.clear();
+    timeline.jumpTo( 2.0 );
+    REQUIRE( (fired == vector<int>{ 2, 20 }) );
+  }
+
+  SECTION( "setTime repositions without firing, so parents can loop the track." )
+  {
+    timeline.jumpTo( 3.5 );
+    fired.clear();
+    timeline.setTime( 0.0 );
+    REQUIRE( fired.empty() );
+    timeline.jumpTo( 1.0 );
+    REQUIRE( (fired == vector<int>{ 0, 1 }) );
+  }
+
+  SECTION( "Cues added from a cue wait for the next step." )
+  {
+    cues.add( 1.0, [&cues, &fired] { cues.add( 1.5, 15u ); } );
+    timeline.jumpTo( 1.2 );
+    REQUIRE( cues.size() == 7 );
+    REQUIRE( (fired == vector<int>{ 0, 1 }) );
+    timeline.jumpTo( 1.6 );
+    REQUIRE( (fired == vector<int>{ 0, 1, 15 }) );
+  }
+
+  SECTION( "Function cues added from a function cue wait for the next step." )
+  {
+    // Enough cues that the function table has to grow while the first one runs.
+    const string tag( 64, 'x' );
+    cues.add( 1.0, [&cues, &fired, tag] {
+      for( int i = 0; i < 32; ++i ) {
+        cues.add( 1.5, [&fired] { fired.push_back( 20 ); } );
+      }
+      fired.push_back( (int)tag.size() );
+    } );
+    timeline.jumpTo( 1.2 );
+    REQUIRE( cues.size() == 38 );
+    REQUIRE( (fired == vector<int>{ 0, 1, 64 }) );
+    timeline.jumpTo( 1.6 );
+    REQUIRE( fired.size() == 35 );
+    REQUIRE( fired.back() == 20 );
+  }
+
+  SECTION( "Clearing from a function cue keeps it alive until it returns." )
+  {
+    const string tag( 64, 'x' );
+    cues.add( 1.0, [&cues, &fired, tag] {
+      cues.clear();
+      fired.push_back( (int)tag.size() );
+    } );
+    timeline.jumpTo( 1.2 );
+    REQUIRE( cues.size() == 0 );
+    REQUIRE( (fired == vector<int>{ 0, 1, 64 }) );
+  }
+}
+
+TEST_CASE( "Asynchronous Cues" )
+{
+  ch::Timeline timeline;
+  // Collects tasks so the test decides when they run.
+  vector<function<void ()>> tasks;
+  auto executor = [&tasks] ( const function<void ()> &task ) { tasks.push_back( task ); };
+  vector<string> log;
+
+  SECTION( "Firing hands the function to the executor without calling it." )
+  {
+    auto completion = timeline.cue( [&log] { log.push_back( "work" ); }, 0.5 ).async( executor ).getCompletion();
+    REQUIRE( completion );
+    timeline.step( 1.0 );
+    REQUIRE( log.empty() );
+    REQUIRE( tasks.size() == 1 );
+    REQUIRE( completion->getFireCount() == 1 );
+    REQUIRE_FALSE( completion->isDone() );
+
+    tasks.front()();
+    REQUIRE( (log == vector<string>{ "work" }) );
+    REQUIRE( completion->isDone() );
+    REQUIRE( completion->getQueueLatency().count == 1 );
+  }
+
+  SECTION( "Continuations run on the next step, in firing order." )
+  {
+    timeline.cue( [&log] { log.push_back( "a" ); }, 0.5 ).async( executor ).then( [&log] { log.push_back( "then a" ); } );
+    timeline.cue( [&log] { log.push_back( "b" ); }, 0.5 ).async( executor ).then( [&log] { log.push_back( "then b" ); } );
+    timeline.cue( [&log] { log.push_back( "sync" ); }, 0.5 );
+    timeline.step( 1.0 );
+    REQUIRE( (log == vector<string>{ "sync" }) );
+    REQUIRE( tasks.size() == 2 );
+
+    // b finishes first, but its continuation waits for a's.
+    tasks[1]();
+    timeline.step( 0.1 );
+    REQUIRE( (log == vector<string>{ "sync", "b" }) );
+    tasks[0]();
+    REQUIRE( (log == vector<string>{ "sync", "b", "a" }) );
+    timeline.step( 0.1 );
+    REQUIRE( (log == vector<string>{ "sync", "b", "a", "then a", "then b" }) );
+  }
+
+  SECTION( "Exceptions from the function are rethrown from the next step." )
+  {
+    timeline.cue( [] { throw std::runtime_error( "failed" ); }, 0.5 ).async( executor );
+    timeline.step( 1.0 );
+    tasks.front()();
+    REQUIRE_THROWS_AS( timeline.step( 0.1 ), std::runtime_error& );
+    REQUIRE_NOTHROW( timeline.step( 0.1 ) );
+  }
+
+  SECTION( "CueWorker runs functions off the stepping thread." )
+  {
+    CueWorker worker;
+    std::thread::id worker_thread, continuation_thread;
+    auto completion = timeline.cue( [&worker_thread] { worker_thread = std::this_thread::get_id(); }, 0.0 )
+      .async( worker.getExecutor() )
+      .then( [&continuation_thread] { continuation_thread = std::this_thread::get_id(); } )
+      .getCompletion();
+
+    timeline.step( 0.1 );
+    completion->wait();
+    timeline.step( 0.1 );
+    REQUIRE( worker_thread != std::this_thread::get_id() );
+    REQUIRE( continuation_thread == std::this_thread::get_id() );
+  }
+}
@@ -8,17 +8,13 @@
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
 
-#define TEST_WITH_GLM_VECTORS 0
-#if TEST_WITH_GLM_VECTORS
-
-#include "glm/glm.hpp"
 #include <array>
 
 using namespace choreograph;
 using namespace std;
-using vec2 = glm::vec2;
-using vec3 = glm::vec3;
-using vec4 = glm::vec4;
+using math::vec2;
+using math::vec3;
+using math::vec4;
 
 TEST_CASE( "Separate component interpolation", "[sequence]" )
 {
@@ -79,4 +75,55 @@ TEST_CASE( "Separate component interpolation", "[sequence]" )
   }
 } // Separate Component Easing
 
-#endif
+#include <cstring>
+#include <functional>
+
+TEST_CASE( "Fast Ease Accuracy" )
+{
+  using namespace choreograph;
+  using EaseFn = std::function<float (float)>;
+
+  struct Comparison
+  {
+    const char  *name;
+    EaseFn      fast;
+    EaseFn      exact;
+    float       max_error;
+  };
+
+  const std::vector<Comparison> comparisons = {
+    { "InSine", fast::EaseInSine(), EaseInSine(), 1.0e-6f },
+    { "OutSine", fast::EaseOutSine(), EaseOutSine(), 1.0e-6f },
+    { "InOutSine", fast::EaseInOutSine(), EaseInOutSine(), 1.0e-6f },
+    { "OutInSine", fast::EaseOutInSine(), EaseOutInSine(), 1.0e-6f },
+    { "InExpo", fast::EaseInExpo(), EaseInExpo(), 1.0e-6f },
+    { "OutExpo", fast::EaseOutExpo(), EaseOutExpo(), 1.0e-6f },
+    { "InOutExpo", fast::EaseInOutExpo(), EaseInOutExpo(), 1.0e-6f },
+    { "OutInExpo", fast::EaseOutInExpo(), EaseOutInExpo(), 1.0e-6f },
+    { "InElastic", fast::EaseInElastic( 1.5f, 0.3f ), EaseInElastic( 1.5f, 0.3f ), 2.0e-6f },
+    { "OutElastic", fast::EaseOutElastic( 1.5f, 0.3f ), EaseOutElastic( 1.5f, 0.3f ), 2.0e-6f },
+    { "InOutElastic", fast::EaseInOutElastic( 1.5f, 0.3f ), EaseInOutElastic( 1.5f, 0.3f ), 2.0e-6f },
+    { "OutInElastic", fast::EaseOutInElastic( 1.5f, 0.3f ), EaseOutInElastic( 1.5f, 0.3f ), 2.0e-6f },
+    { "InAtan", fast::EaseInAtan(), EaseInAtan(), 5.0e-6f },
+    { "OutAtan", fast::EaseOutAtan(), EaseOutAtan(), 5.0e-6f },
+    { "InOutAtan", fast::EaseInOutAtan(), EaseInOutAtan(), 5.0e-6f }
+  };
+
+  // Walk every 1024th float in [0, 1) (about a million values), plus 1 itself.
+  const float end = 1.0f;
+  uint32_t end_bits;
+  std::memcpy( &end_bits, &end, sizeof( end_bits ) );
+
+  for( const auto &c : comparisons )
+  {
+    float max_error = std::abs( c.fast( 1.0f ) - c.exact( 1.0f ) );
+    for( uint32_t bits = 0; bits < end_bits; bits += 1024 )
+    {
+      float t;
+      std::memcpy( &t, &bits, sizeof( t ) );
+      max_error = std::max( max_error, std::abs( c.fast( t ) - c.exact( t ) ) );
+    }
+    INFO( c.name << " max error: " << max_error );
+    CHECK( max_error <= c.max_error );
+  }
+}
@@ -0,0 +1,107 @@
+//
+//  Executor_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+#include <stdexcept>
+
+using namespace choreograph;
+using namespace std;
+
+TEST_CASE( "Timeline Executor" )
+{
+  const int scenes = 32;
+  vector<ch::Timeline> timelines( scenes );
+  vector<vector<Output<float>>> outputs( scenes );
+  for( int i = 0; i < scenes; ++i )
+  {
+    // Uneven sizes exercise the balancing.
+    outputs[i] = vector<Output<float>>( 1 + i % 5 );
+    for( auto &output : outputs[i] ) {
+      output = 0.0f;
+      timelines[i].apply( &output ).then<RampTo>( (float)i, 1.0f );
+    }
+  }
+
+  SECTION( "Stepping in parallel matches stepping serially." )
+  {
+    TimelineExecutor executor( 4 );
+    for( auto &timeline : timelines ) {
+      executor.add( &timeline );
+    }
+    REQUIRE( executor.size() == scenes );
+    REQUIRE( executor.getThreadCount() == 4 );
+
+    executor.step( 0.5 );
+    for( int i = 0; i < scenes; ++i ) {
+      for( auto &output : outputs[i] ) {
+        REQUIRE( output() == Approx( i * 0.5f ) );
+      }
+    }
+
+    executor.remove( &timelines[0] );
+    executor.step( 0.25 );
+    REQUIRE( outputs[0][0]() == Approx( 0.0f ) );
+    REQUIRE( outputs[1][0]() == Approx( 0.75f ) );
+  }
+
+  SECTION( "Deferred callbacks run on the calling thread in registration order." )
+  {
+    TimelineExecutor executor( 3 );
+    vector<int> order;
+    vector<thread::id> threads;
+    for( int i = 0; i < scenes; ++i )
+    {
+      timelines[i].cue( [i, &order, &threads] {
+        order.push_back( i );
+        threads.push_back( this_thread::get_id() );
+      }, 0.5 );
+      timelines[i].cue( [i, &order] { order.push_back( i + 100 ); }, 0.5 );
+      executor.add( &timelines[i] );
+    }
+
+    executor.step( 0.25 );
+    REQUIRE( order.empty() );
+    executor.step( 0.5 );
+
+    REQUIRE( order.size() == 2 * scenes );
+    for( int i = 0; i < scenes; ++i ) {
+      REQUIRE( order[2 * i] == i );
+      REQUIRE( order[2 * i + 1] == i + 100 );
+      REQUIRE( threads[i] == this_thread::get_id() );
+    }
+  }
+
+  SECTION( "Immediate callbacks run during the step." )
+  {
+    TimelineExecutor executor( 2 );
+    atomic<int> calls( 0 );
+    for( auto &timeline : timelines ) {
+      timeline.cue( [&calls] { calls += 1; }, 0.1 );
+      executor.add( &timeline, TimelineExecutor::CallbackPolicy::Immediate );
+    }
+    executor.step( 0.2 );
+    REQUIRE( calls == scenes );
+  }
+
+  SECTION( "Exceptions from workers are rethrown by step." )
+  {
+    TimelineExecutor executor( 2 );
+    for( auto &timeline : timelines ) {
+      executor.add( &timeline, TimelineExecutor::CallbackPolicy::Immediate );
+    }
+    bool thrown = false;
+    timelines[7].cue( [&thrown] {
+      // The failed step never finished, so the cue is crossed again on the next one.
+      if( ! thrown ) {
+        thrown = true;
+        throw runtime_error( "cue failed" );
+      }
+    }, 0.1 );
+    REQUIRE_THROWS_AS( executor.step( 0.2 ), std::runtime_error& );
+    executor.step( 0.2 );
+    REQUIRE( outputs[31][0]() == Approx( 31 * 0.4f ) );
+  }
+}
@@ -0,0 +1,155 @@
+//
+//  Follow_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+struct Vec2
+{
+  float x, y;
+};
+
+Vec2 operator+ ( const Vec2 &a, const Vec2 &b ) { return Vec2{ a.x + b.x, a.y + b.y }; }
+Vec2 operator- ( const Vec2 &a, const Vec2 &b ) { return Vec2{ a.x - b.x, a.y - b.y }; }
+Vec2 operator* ( const Vec2 &a, float s ) { return Vec2{ a.x * s, a.y * s }; }
+
+/// Hue that only interpolates through its InterpolationTraits.
+struct Hue
+{
+  float turns;
+};
+
+} // namespace
+
+namespace choreograph
+{
+
+template<>
+struct InterpolationTraits<Hue>
+{
+  static Hue lerp( const Hue &a, const Hue &b, float t ) { return Hue{ a.turns + (b.turns - a.turns) * t }; }
+};
+
+} // namespace choreograph
+
+TEST_CASE( "Follow" )
+{
+  ch::Timeline  timeline;
+  Output<float> leader( 10.0f );
+  Output<float> follower( 0.0f );
+
+  SECTION( "Exponential following closes a fixed fraction of the distance per second." )
+  {
+    timeline.addShared( make_shared<Follow<float>>( &follower, &leader, FollowMode::Exponential, 2.0f ) );
+    timeline.step( 0.5 );
+    REQUIRE( follower() == Approx( 10.0f * (1.0f - exp( -1.0f )) ) );
+
+    // Splitting the step into smaller ones gets to the same place.
+    Output<float> fine( 0.0f );
+    Follow<float> fine_follow( &fine, &leader, FollowMode::Exponential, 2.0f );
+    for( int i = 0; i < 10; ++i ) {
+      fine_follow.step( 0.05 );
+    }
+    REQUIRE( fine() == Approx( follower() ) );
+  }
+
+  SECTION( "Critically damped following settles without overshooting." )
+  {
+    Follow<float> follow( &follower, &leader, FollowMode::CriticallyDamped, 10.0f );
+    float previous = follower();
+    for( int i = 0; i < 120; ++i ) {
+      follow.step( 1.0 / 60 );
+      REQUIRE( follower() >= previous );
+      REQUIRE( follower() <= 10.0f );
+      previous = follower();
+    }
+    REQUIRE( follower() == Approx( 10.0f ).epsilon( 0.001 ) );
+    REQUIRE( follow.getVelocity() >= 0.0f );
+  }
+
+  SECTION( "Max speed following moves in a straight line at constant speed." )
+  {
+    Output<Vec2> target( Vec2{ 3, 4 } );
+    Output<Vec2> chaser( Vec2{ 0, 0 } );
+    Follow<Vec2> follow( &chaser, &target, FollowMode::MaxSpeed, 1.0f );
+
+    follow.step( 2.5 );
+    REQUIRE( chaser().x == Approx( 1.5f ) );
+    REQUIRE( chaser().y == Approx( 2.0f ) );
+
+    follow.step( 10.0 );
+    REQUIRE( chaser().x == 3.0f );
+    REQUIRE( chaser().y == 4.0f );
+  }
+
+  SECTION( "Follows never finish and stay on their Timeline." )
+  {
+    timeline.addShared( make_shared<Follow<float>>( &follower, &leader ) );
+    timeline.step( 1000.0 );
+    REQUIRE( timeline.size() == 1 );
+    REQUIRE( follower() == Approx( 10.0f ) );
+  }
+
+  SECTION( "Follow groups update chains head first." )
+  {
+    vector<Output<float>> chain( 4 );
+    for( auto &o : chain ) {
+      o = 0.0f;
+    }
+
+    // Added tail first; each follower chases the one before it.
+    auto group = make_shared<FollowGroup<float>>( FollowMode::Exponential, 1000.0f );
+    for( size_t i = chain.size() - 1; i > 0; --i ) {
+      group->add( &chain[i], &chain[i - 1] );
+    }
+    group->add( &chain[0], &leader );
+    REQUIRE( group->size() == 4 );
+    timeline.addShared( group );
+
+    // A fast rate lets each follower practically reach its source in one step,
+    // which only reaches the tail if the head updated first.
+    timeline.step( 0.1 );
+    REQUIRE( chain.back()() == Approx( 10.0f ) );
+
+    group->remove( &chain.back() );
+    REQUIRE( group->size() == 3 );
+  }
+
+  SECTION( "Modes the followed type can't support are rejected." )
+  {
+    Hue hue{ 0.0f };
+    const Hue target{ 0.5f };
+    Follow<Hue> follow( &hue, &target );
+    follow.step( 0.1 );
+    REQUIRE( hue.turns > 0.0f );
+
+    REQUIRE_THROWS_AS( follow.setMode( FollowMode::CriticallyDamped ), std::invalid_argument& );
+    REQUIRE_THROWS_AS( follow.setMode( FollowMode::MaxSpeed ), std::invalid_argument& );
+    REQUIRE( follow.getMode() == FollowMode::Exponential );
+    REQUIRE_THROWS_AS( Follow<Hue>( &hue, &target, FollowMode::MaxSpeed ), std::invalid_argument& );
+    REQUIRE_THROWS_AS( FollowGroup<Hue>( FollowMode::CriticallyDamped ), std::invalid_argument& );
+  }
+
+  SECTION( "Follow groups match individual Follows." )
+  {
+    const float rate = 3.0f;
+    Output<float> single( 0.0f );
+    Output<float> grouped( 0.0f );
+    Follow<float> follow( &single, &leader, FollowMode::CriticallyDamped, rate );
+    FollowGroup<float> group( FollowMode::CriticallyDamped, rate );
+    group.add( &grouped, &leader );
+
+    for( int i = 0; i < 30; ++i ) {
+      follow.step( 1.0 / 30 );
+      group.step( 1.0 / 30 );
+      REQUIRE( grouped() == single() );
+    }
+  }
+}
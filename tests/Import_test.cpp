@@ -0,0 +1,140 @@
+//
+//  Import_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+/// Writes \a rows samples of a linear and a sine channel as CSV.
+void writeCsv( ostream &stream, int rows )
+{
+  stream << "time,linear,wave\n";
+  for( int i = 0; i < rows; ++i ) {
+    stream << i * 0.01 << "," << i * 0.5 << "," << sin( i * 0.01 ) << "\n";
+  }
+}
+
+/// Writes the same data as writeCsv() as a JSON array of row objects.
+void writeJson( ostream &stream, int rows )
+{
+  stream << "[\n";
+  for( int i = 0; i < rows; ++i ) {
+    stream << (i ? ",\n" : "") << "  { \"linear\": " << i * 0.5 << ", \"time\": " << i * 0.01 << ", \"wave\": " << sin( i * 0.01 ) << " }";
+  }
+  stream << "\n]\n";
+}
+
+} // namespace
+
+TEST_CASE( "Keyframe Import" )
+{
+  SECTION( "CSV files import one track per column." )
+  {
+    const string path = "choreograph_import.csv";
+    {
+      ofstream file( path );
+      writeCsv( file, 1000 );
+    }
+
+    auto import = importKeyframes( path );
+    REQUIRE( import.rows == 1000 );
+    REQUIRE( import.channels.size() == 2 );
+    REQUIRE( import.channels[0].name == "linear" );
+
+    auto linear = import.getTrack( "linear" );
+    REQUIRE( linear->size() == 1000 );
+    REQUIRE( linear->getDuration() == Approx( 9.99 ) );
+    REQUIRE( linear->getValue( 5.0 ) == Approx( 250.0f ) );
+    REQUIRE( import.getTrack( "wave" )->getValue( 1.0 ) == Approx( sin( 1.0 ) ).epsilon( 1.0e-4 ) );
+    REQUIRE( import.getTrack( "missing" ) == nullptr );
+  }
+
+  SECTION( "JSON files import one track per key, in any key order." )
+  {
+    const string path = "choreograph_import.json";
+    {
+      ofstream file( path );
+      writeJson( file, 1000 );
+    }
+
+    auto import = importKeyframes( path );
+    REQUIRE( import.rows == 1000 );
+    REQUIRE( import.channels.size() == 2 );
+    REQUIRE( import.getTrack( "linear" )->getValue( 5.0 ) == Approx( 250.0f ) );
+    REQUIRE( import.getTrack( "wave" )->size() == 1000 );
+  }
+
+  SECTION( "Records may span buffer boundaries." )
+  {
+    stringstream csv, json;
+    writeCsv( csv, 200 );
+    writeJson( json, 200 );
+
+    ImportOptions options;
+    options.buffer_size = 80;
+    auto small_csv = importKeyframesCsv( csv, options );
+    auto small_json = importKeyframesJson( json, options );
+
+    stringstream reference;
+    writeCsv( reference, 200 );
+    auto expected = importKeyframesCsv( reference );
+
+    REQUIRE( small_csv.bytes == csv.str().size() );
+    REQUIRE( (small_csv.getTrack( "wave" )->getValues() == expected.getTrack( "wave" )->getValues()) );
+    REQUIRE( (small_json.getTrack( "wave" )->getValues() == expected.getTrack( "wave" )->getValues()) );
+    REQUIRE( (small_json.getTrack( "linear" )->getTimes() == expected.getTrack( "linear" )->getTimes()) );
+  }
+
+  SECTION( "Missing values are skipped per channel." )
+  {
+    stringstream csv( "\"x\", time, y\r\n1, 1.0, \r\n2, 2.0, 5\r\n, 3.0, 7\r\n" );
+    auto import = importKeyframesCsv( csv );
+    REQUIRE( import.getTrack( "x" )->size() == 2 );
+    REQUIRE( import.getTrack( "y" )->size() == 2 );
+    REQUIRE( import.channels[0].start_time == 1.0 );
+    REQUIRE( import.channels[1].start_time == 2.0 );
+
+    stringstream json( "[{\"time\": 0, \"a\": 1}, {\"time\": 1, \"a\": null, \"b\": 2}, {\"b\": 3, \"time\": 2, \"a\": 4}]" );
+    auto imported = importKeyframesJson( json );
+    REQUIRE( imported.getTrack( "a" )->size() == 2 );
+    REQUIRE( imported.getTrack( "a" )->getValue( 1.0 ) == 2.5f );
+    REQUIRE( imported.getTrack( "b" )->size() == 2 );
+  }
+
+  SECTION( "A tolerance fits tracks while streaming." )
+  {
+    stringstream csv;
+    writeCsv( csv, 1000 );
+    ImportOptions options;
+    options.tolerance = 0.001;
+    auto import = importKeyframesCsv( csv, options );
+    REQUIRE( import.getTrack( "linear" )->size() == 2 );
+    REQUIRE( import.getTrack( "wave" )->size() < 100 );
+    REQUIRE( import.getTrack( "wave" )->getValue( 5.0 ) == Approx( sin( 5.0 ) ).epsilon( 0.002 ) );
+  }
+
+  SECTION( "Malformed input throws." )
+  {
+    stringstream bad_number( "time,x\n0,1\n1,abc\n" );
+    REQUIRE_THROWS_AS( importKeyframesCsv( bad_number ), std::runtime_error& );
+
+    stringstream bad_json( "[{\"time\": 0, \"x\": [1]}]" );
+    REQUIRE_THROWS_AS( importKeyframesJson( bad_json ), std::runtime_error& );
+
+    ImportOptions options;
+    options.buffer_size = 8;
+    stringstream long_line( "time,a_long_channel_name\n" );
+    REQUIRE_THROWS_AS( importKeyframesCsv( long_line, options ), std::runtime_error& );
+
+    REQUIRE_THROWS_AS( importKeyframes( "choreograph_import.txt" ), std::runtime_error& );
+  }
+}
@@ -0,0 +1,89 @@
+//
+//  Interner_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+TEST_CASE( "Phrase Interning" )
+{
+  auto interner = make_shared<PhraseInterner>();
+
+  SECTION( "Identical phrases share one allocation." )
+  {
+    Sequence<float> a( 0.0f ), b( 0.0f );
+    a.setInterner( interner );
+    b.setInterner( interner );
+
+    a.then<RampTo>( 1.0f, 0.25f, EaseOutCubic() ).then<Hold>( 1.0f, 0.5f );
+    b.then<RampTo>( 1.0f, 0.25f, EaseOutCubic() ).then<RampTo>( 0.0f, 0.25f, &easeInQuad );
+
+    REQUIRE( a.getPhraseAtIndex( 0 ) == b.getPhraseAtIndex( 0 ) );
+    REQUIRE( a.getPhraseAtIndex( 1 ) != b.getPhraseAtIndex( 1 ) );
+    REQUIRE( b.getValue( 0.125f ) == Approx( easeOutCubic( 0.5f ) ) );
+
+    auto stats = interner->getStats();
+    REQUIRE( stats.requests == 4 );
+    REQUIRE( stats.shared == 1 );
+    REQUIRE( stats.entries == 3 );
+    REQUIRE( stats.dedupRate() == Approx( 0.25 ) );
+  }
+
+  SECTION( "Differing values, durations, eases and ease parameters are kept apart." )
+  {
+    Sequence<float> sequence( 0.0f );
+    sequence.setInterner( interner );
+    sequence.then<RampTo>( 1.0f, 1.0f, EaseInBack( 1.0f ) ).set( 0.0f );
+    sequence.then<RampTo>( 1.0f, 1.0f, EaseInBack( 2.0f ) ).set( 0.0f );
+    sequence.then<RampTo>( 1.0f, 1.0f, EaseInQuad() ).set( 0.0f );
+    sequence.then<RampTo>( 1.0f, 2.0f, EaseInQuad() ).set( 0.0f );
+    sequence.then<RampTo>( 2.0f, 2.0f, EaseInQuad() ).set( 0.0f );
+    sequence.then<RampTo>( 2.0f, 2.0f, EaseInQuad() );
+
+    REQUIRE( sequence.getPhraseAtIndex( 8 ) == sequence.getPhraseAtIndex( 10 ) );
+    // The first four set() calls add equal zero-duration Holds from 1 to 0.
+    REQUIRE( interner->getStats().shared == 1 + 3 );
+  }
+
+  SECTION( "Phrases with unknowable state are never shared." )
+  {
+    Sequence<float> sequence( 0.0f );
+    sequence.setInterner( interner );
+    EaseFn wrapped = EaseInQuad();
+    sequence.then<RampTo>( 1.0f, 1.0f, wrapped ).set( 0.0f ).then<RampTo>( 1.0f, 1.0f, wrapped );
+
+    REQUIRE( sequence.getPhraseAtIndex( 0 ) != sequence.getPhraseAtIndex( 2 ) );
+    REQUIRE( interner->getStats().unkeyable == 2 );
+  }
+
+  SECTION( "The interner doesn't keep phrases alive." )
+  {
+    weak_ptr<Phrase<float>> phrase;
+    {
+      Sequence<float> sequence( 0.0f );
+      sequence.setInterner( interner );
+      sequence.then<RampTo>( 1.0f, 1.0f );
+      phrase = sequence.getPhraseAtIndex( 0 );
+    }
+    REQUIRE( phrase.expired() );
+    REQUIRE( interner->getStats().entries == 0 );
+    interner->purge();
+  }
+
+  SECTION( "Timelines pass their interner to new Motions." )
+  {
+    Timeline timeline;
+    timeline.setPhraseInterner( interner );
+    Output<float> x( 0.0f ), y( 0.0f );
+    timeline.apply( &x ).then<RampTo>( 1.0f, 0.25f, EaseOutCubic() );
+    timeline.apply( &y ).then<RampTo>( 1.0f, 0.25f, EaseOutCubic() );
+
+    REQUIRE( x.inputPtr()->getSequence().getPhraseAtIndex( 0 ) == y.inputPtr()->getSequence().getPhraseAtIndex( 0 ) );
+    timeline.step( 0.25f );
+    REQUIRE( x == 1.0f );
+    REQUIRE( y == 1.0f );
+  }
+}
@@ -0,0 +1,96 @@
+//
+//  Keyframes_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+struct Point
+{
+  float x, y;
+};
+
+Point operator+ ( const Point &a, const Point &b ) { return Point{ a.x + b.x, a.y + b.y }; }
+Point operator- ( const Point &a, const Point &b ) { return Point{ a.x - b.x, a.y - b.y }; }
+Point operator* ( const Point &a, float s ) { return Point{ a.x * s, a.y * s }; }
+
+} // namespace
+
+TEST_CASE( "Keyframe Tracks" )
+{
+  auto track = make_shared<KeyframeTrack<float>>( vector<Time>{ 1.0, 2.0, 4.0 }, vector<float>{ 0.0f, 10.0f, 0.0f } );
+
+  SECTION( "Tracks interpolate linearly between keyframes, starting at time zero." )
+  {
+    REQUIRE( track->getDuration() == 3.0 );
+    REQUIRE( track->getValue( -1.0 ) == 0.0f );
+    REQUIRE( track->getValue( 0.5 ) == 5.0f );
+    REQUIRE( track->getValue( 1.0 ) == 10.0f );
+    REQUIRE( track->getValue( 2.0 ) == 5.0f );
+    REQUIRE( track->getValue( 10.0 ) == 0.0f );
+  }
+
+  SECTION( "Tracks compose within Sequences." )
+  {
+    Sequence<float> sequence( 0.0f );
+    sequence.then<RampTo>( 20.0f, 1.0f ).then( track );
+    REQUIRE( sequence.getDuration() == 4.0 );
+    REQUIRE( sequence.getValue( 2.0 ) == 10.0f );
+  }
+}
+
+TEST_CASE( "Keyframe Fitting" )
+{
+  SECTION( "Linear input collapses to its end points." )
+  {
+    KeyframeFitter<float> fitter( 0.001 );
+    for( int i = 0; i <= 1000; ++i ) {
+      fitter.addSample( i / 100.0, i * 0.5f );
+    }
+    auto track = fitter.finish();
+    REQUIRE( track->size() == 2 );
+    REQUIRE( track->getDuration() == Approx( 10.0 ) );
+    REQUIRE( track->getValue( 5.0 ) == Approx( 250.0f ) );
+    REQUIRE( fitter.getSampleCount() == 0 );
+  }
+
+  SECTION( "Curved input stays within tolerance with far fewer keyframes than samples." )
+  {
+    const double tolerance = 0.01;
+    const int    samples = 10000;
+    KeyframeFitter<Point> fitter( tolerance );
+    vector<Point> input;
+    for( int i = 0; i < samples; ++i ) {
+      const float t = i / 1000.0f;
+      input.push_back( Point{ std::cos( t ) * 5.0f, std::sin( t * 3.0f ) } );
+      fitter.addSample( t, input.back() );
+    }
+    auto track = fitter.finish();
+
+    REQUIRE( track->size() < samples / 20 );
+    double max_error = 0.0;
+    for( int i = 0; i < samples; ++i ) {
+      auto value = track->getValue( i / 1000.0f );
+      max_error = std::max<double>( max_error, std::abs( value.x - input[i].x ) );
+      max_error = std::max<double>( max_error, std::abs( value.y - input[i].y ) );
+    }
+    // Allow for float rounding of stored keyframes.
+    REQUIRE( max_error <= tolerance + 1.0e-5 );
+  }
+
+  SECTION( "Out-of-order samples are ignored." )
+  {
+    KeyframeFitter<float> fitter( 0.1 );
+    fitter.addSample( 1.0, 1.0f );
+    fitter.addSample( 0.5, 100.0f );
+    fitter.addSample( 2.0, 2.0f );
+    REQUIRE( fitter.getSampleCount() == 2 );
+    REQUIRE( fitter.finish()->getEndValue() == Approx( 2.0f ) );
+  }
+}
@@ -0,0 +1,86 @@
+//
+//  Math_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+using namespace choreograph::math;
+
+namespace {
+
+bool near( float a, float b ) { return std::abs( a - b ) < 1.0e-5f; }
+
+} // namespace
+
+TEST_CASE( "Built-in Math" )
+{
+  SECTION( "Vector arithmetic works componentwise." )
+  {
+    vec3 a( 1, 2, 3 );
+    vec3 b( 4, 5, 6 );
+
+    REQUIRE( (a + b) == vec3( 5, 7, 9 ) );
+    REQUIRE( (b - a) == vec3( 3 ) );
+    REQUIRE( (a * 2.0f) == vec3( 2, 4, 6 ) );
+    REQUIRE( (2.0f * a) == (a * 2.0f) );
+    REQUIRE( (-a) == vec3( -1, -2, -3 ) );
+    REQUIRE( dot( a, b ) == 32.0f );
+    REQUIRE( cross( vec3( 1, 0, 0 ), vec3( 0, 1, 0 ) ) == vec3( 0, 0, 1 ) );
+    REQUIRE( near( length( normalize( b ) ), 1.0f ) );
+    REQUIRE( mix( vec2( 0 ), vec2( 10, 20 ), 0.5f ) == vec2( 5, 10 ) );
+
+    vec4 c( 1 );
+    c += vec4( 1, 2, 3, 4 );
+    c *= 2.0f;
+    REQUIRE( c == vec4( 4, 6, 8, 10 ) );
+  }
+
+  SECTION( "Vectors are packed floats, so they interpolate in batches." )
+  {
+    REQUIRE( sizeof( vec2 ) == 2 * sizeof( float ) );
+    REQUIRE( sizeof( vec3 ) == 3 * sizeof( float ) );
+    REQUIRE( sizeof( vec4 ) == 16 );
+    REQUIRE( alignof( vec4 ) == 16 );
+    REQUIRE( detail::has_linear_floats<vec3>::value );
+    REQUIRE( ! detail::has_linear_floats<quat>::value );
+
+    Sequence<vec2> sequence( vec2( 0 ) );
+    sequence.then<RampTo>( vec2( 10, 20 ), 1.0f );
+    REQUIRE( sequence.getValue( 0.25f ) == vec2( 2.5f, 5.0f ) );
+  }
+
+  SECTION( "Quaternions rotate vectors and slerp along the shortest arc." )
+  {
+    const float quarter_turn = 1.5707963f;
+    auto q = angleAxis( quarter_turn, vec3( 0, 0, 1 ) );
+    auto v = q * vec3( 1, 0, 0 );
+
+    REQUIRE( near( v.x, 0.0f ) );
+    REQUIRE( near( v.y, 1.0f ) );
+
+    auto half = InterpolationTraits<quat>::slerp( quat(), q, 0.5f );
+    auto expected = angleAxis( quarter_turn * 0.5f, vec3( 0, 0, 1 ) );
+    REQUIRE( near( dot( half, expected ), 1.0f ) );
+    REQUIRE( near( length( vec4( half.x, half.y, half.z, half.w ) ), 1.0f ) );
+
+    // -q is the same rotation; slerp takes the short way around either way.
+    auto flipped = InterpolationTraits<quat>::slerp( quat(), -q, 0.5f );
+    REQUIRE( near( std::abs( dot( flipped, expected ) ), 1.0f ) );
+  }
+
+  SECTION( "Quaternion Sequences slerp." )
+  {
+    auto q = angleAxis( 3.0f, vec3( 0, 1, 0 ) );
+    const quat identity;
+    Sequence<quat> sequence( identity );
+    sequence.then<RampTo>( q, 1.0f );
+
+    auto mid = sequence.getValue( 0.5f );
+    REQUIRE( near( dot( mid, mid ), 1.0f ) );
+    REQUIRE( near( dot( mid, angleAxis( 1.5f, vec3( 0, 1, 0 ) ) ), 1.0f ) );
+    REQUIRE( sequence.getValue( 1.0f ) == q );
+  }
+}
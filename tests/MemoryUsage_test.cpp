@@ -0,0 +1,69 @@
+//
+//  MemoryUsage_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+TEST_CASE( "Memory Usage" )
+{
+  SECTION( "Sequences count each of their phrases once." )
+  {
+    auto ramp = makeRamp( 0.0f, 1.0f, 1.0f );
+    Sequence<float> sequence( 0.0f );
+    sequence.then( ramp ).then( ramp ).then<Hold>( 1.0f, 1.0f );
+
+    auto usage = sequence.memoryUsage();
+    REQUIRE( usage.phrase_count == 2 );
+    REQUIRE( usage.phrases == sizeof( RampTo<float> ) + sizeof( Hold<float> ) );
+    REQUIRE( usage.phrases_by_type[typeid( RampTo<float> ).name()] == sizeof( RampTo<float> ) );
+    REQUIRE( usage.index >= sizeof( Sequence<float> ) + 3 * sizeof( PhraseRef<float> ) );
+    REQUIRE( usage.total() == usage.index + usage.phrases );
+
+    // We still hold the ramp, so it would outlive the sequence.
+    REQUIRE( usage.shared_phrases == sizeof( RampTo<float> ) );
+    REQUIRE( usage.exclusive_phrases == sizeof( Hold<float> ) );
+
+    ramp.reset();
+    usage = sequence.memoryUsage();
+    REQUIRE( usage.shared_phrases == 0 );
+    REQUIRE( usage.exclusive_phrases == usage.phrases );
+  }
+
+  SECTION( "Meta-phrases include the phrases they are built from." )
+  {
+    auto keyframes = make_shared<KeyframeTrack<float>>( vector<Time>{ 0, 1, 2 }, vector<float>{ 0, 1, 0 } );
+    auto looped = makeRepeat<float>( keyframes, 3 );
+    auto blended = makeBlend<float>( looped, keyframes );
+    keyframes.reset();
+    looped.reset();
+
+    auto usage = Sequence<float>( PhraseRef<float>( blended ) ).memoryUsage();
+    REQUIRE( usage.phrase_count == 3 );
+    REQUIRE( usage.phrases_by_type[typeid( KeyframeTrack<float> ).name()] >= sizeof( KeyframeTrack<float> ) + 3 * (sizeof( Time ) + sizeof( float )) );
+    // Only the blend is still held outside the sequence; the keyframes are referenced twice, both from within.
+    REQUIRE( usage.shared_phrases == sizeof( MixPhrase<float> ) );
+  }
+
+  SECTION( "Timelines count items, callbacks, controls and phrases shared between motions." )
+  {
+    ch::Timeline timeline;
+    timeline.setPhraseInterner( make_shared<PhraseInterner>() );
+    Output<float> a( 0.0f ), b( 0.0f );
+    timeline.apply( &a ).then<RampTo>( 1.0f, 1.0f, EaseInQuad() ).finishFn( [] {} );
+    timeline.apply( &b ).then<RampTo>( 1.0f, 1.0f, EaseInQuad() ).getControl();
+    timeline.cue( [] {}, 0.5f );
+
+    auto usage = timeline.memoryUsage();
+    REQUIRE( usage.item_count == 4 );
+    REQUIRE( (usage.items + usage.callbacks) >= sizeof( ch::Timeline ) + 2 * sizeof( Motion<float> ) + sizeof( Cue ) );
+    REQUIRE( usage.callbacks >= 6 * sizeof( std::function<void ()> ) );
+    REQUIRE( usage.controls == sizeof( Control ) );
+    REQUIRE( usage.phrase_count == 1 );
+    REQUIRE( usage.exclusive_phrases == sizeof( RampTo<float> ) );
+    REQUIRE( usage.total() == usage.items + usage.callbacks + usage.controls + usage.index + usage.phrases );
+  }
+}
@@ -8,6 +8,10 @@
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
 
+#include <atomic>
+#include <cmath>
+#include <thread>
+
 using namespace choreograph;
 using namespace std;
 
@@ -138,3 +142,173 @@ TEST_CASE( "Outputs" )
     REQUIRE( copy.value() == 10.0f );
   }
 } // Outputs
+
+TEST_CASE( "Publishing Sequences" )
+{
+  Output<float> target = 0.0f;
+  auto ramp_up = Sequence<float>( 0.0f ).then<RampTo>( 10.0f, 2.0f );
+  auto ramp_down = Sequence<float>( 100.0f ).then<RampTo>( 0.0f, 4.0f );
+
+  Motion<float> motion( &target, ramp_up );
+  motion.step( 1.0 );
+  REQUIRE( target() == 5.0f );
+
+  SECTION( "Published Sequences are installed at the next step, keeping time." )
+  {
+    motion.publish( ramp_down );
+    REQUIRE( target() == 5.0f );
+    REQUIRE( motion.getDuration() == 2.0f );
+
+    motion.step( 1.0 );
+    REQUIRE( motion.time() == 2.0f );
+    REQUIRE( motion.getDuration() == 4.0f );
+    REQUIRE( target() == 50.0f );
+  }
+
+  SECTION( "Remap functions place the playhead in the new Sequence." )
+  {
+    motion.publish( ramp_down, &Motion<float>::keepProgress );
+    motion.step( 0.0 );
+    REQUIRE( motion.time() == 2.0f );
+    REQUIRE( target() == 50.0f );
+
+    motion.publish( ramp_up, [] (Time /*time*/, const Sequence<float> &/*from*/, const Sequence<float> &/*to*/) { return 0.0; } );
+    motion.step( 0.5 );
+    REQUIRE( motion.time() == 0.0f );
+    REQUIRE( target() == 0.0f );
+  }
+
+  SECTION( "Only the latest unconsumed publication is installed." )
+  {
+    motion.publish( ramp_down );
+    motion.publish( Sequence<float>( 7.0f ).then<Hold>( 7.0f, 3.0f ) );
+    motion.step( 0.0 );
+    REQUIRE( target() == 7.0f );
+    REQUIRE( motion.getDuration() == 3.0f );
+  }
+
+  SECTION( "Replaced Sequences stay alive until reclaimed off the stepping thread." )
+  {
+    auto phrase = make_shared<RampTo<float>>( 2.0f, 0.0f, 1.0f );
+    motion.publish( Sequence<float>( phrase ) );
+    motion.step( 0.0 );
+    REQUIRE( phrase.use_count() == 2 );
+
+    motion.publish( ramp_up );
+    motion.step( 0.0 );
+    // The replaced Sequence is retired, not freed, by the step.
+    REQUIRE( phrase.use_count() == 2 );
+
+    motion.reclaim();
+    REQUIRE( phrase.use_count() == 1 );
+
+    // Remap functions retire with their record, so their captures are freed by reclaim() too.
+    auto state = make_shared<int>( 0 );
+    motion.publish( ramp_down, [state] (Time time, const Sequence<float> &/*from*/, const Sequence<float> &/*to*/) { return time; } );
+    motion.step( 0.0 );
+    REQUIRE( state.use_count() == 2 );
+    motion.reclaim();
+    REQUIRE( state.use_count() == 1 );
+  }
+
+  SECTION( "Sequences can be published from another thread while stepping." )
+  {
+    std::atomic<bool> done( false );
+    std::thread publisher( [&] {
+      for( int i = 0; i < 1000; ++i ) {
+        motion.publish( Sequence<float>( (float)i ).then<RampTo>( (float)i, 2.0f ) );
+      }
+      done = true;
+    } );
+
+    while( ! done ) {
+      motion.step( 0.0 );
+      // Every installed Sequence holds an integral value; anything else would be a torn install.
+      REQUIRE( target() == std::floor( target() ) );
+    }
+    publisher.join();
+    motion.step( 0.0 );
+    REQUIRE( target() == 999.0f );
+  }
+}
+
+TEST_CASE( "Looping Motions" )
+{
+  Output<float> target = 0.0f;
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 1.0f, 1.0f )
+    .then<RampTo>( 10.0f, 1.0f )
+    .then<RampTo>( 100.0f, 1.0f );
+
+  Motion<float> motion( &target, sequence );
+  int loops = 0;
+  int finishes = 0;
+  motion.setLoopFn( [&loops] { loops += 1; } );
+  motion.setFinishFn( [&finishes] { finishes += 1; } );
+
+  SECTION( "Repeating Motions wrap their playhead and never finish." )
+  {
+    motion.setLoop( LoopMode::Repeat );
+    for( int i = 0; i < 12000; i += 1 ) {
+      motion.step( 0.25 );
+      REQUIRE( motion.time() < 3.0 );
+    }
+    REQUIRE( motion.getLoopCount() == 1000 );
+    REQUIRE( loops == 1000 );
+    REQUIRE( finishes == 0 );
+    REQUIRE( ! motion.isFinished() );
+
+    motion.step( 0.5 );
+    REQUIRE( motion.time() == Approx( 0.5 ) );
+    REQUIRE( target() == Approx( 0.5f ) );
+
+    // Long steps wrap only the overshoot.
+    motion.step( 7.0 );
+    REQUIRE( motion.time() == Approx( 1.5 ) );
+    REQUIRE( motion.getLoopCount() == 1002 );
+    REQUIRE( loops == 1001 );
+  }
+
+  SECTION( "Ping-pong Motions reverse at each end." )
+  {
+    motion.setLoop( LoopMode::PingPong );
+    motion.step( 3.5 );
+    REQUIRE( motion.time() == Approx( 2.5 ) );
+    REQUIRE( motion.backward() );
+    REQUIRE( target() == Approx( 55.0f ) );
+
+    motion.step( 3.0 );
+    REQUIRE( motion.time() == Approx( 0.5 ) );
+    REQUIRE( motion.forward() );
+    REQUIRE( motion.getLoopCount() == 2 );
+    REQUIRE( finishes == 0 );
+  }
+
+  SECTION( "Motions loop from an inflection point, calling inflection callbacks every cycle." )
+  {
+    int inflections = 0;
+    motion.addInflectionCallback( 2, [&inflections] { inflections += 1; } );
+    motion.setLoop( LoopMode::Repeat, 1 );
+
+    motion.step( 2.5 );
+    REQUIRE( inflections == 1 );
+    motion.step( 1.0 );
+    REQUIRE( motion.time() == Approx( 1.5 ) );
+    REQUIRE( target() == Approx( 5.5f ) );
+
+    for( int i = 0; i < 8; i += 1 ) {
+      motion.step( 0.5 );
+    }
+    REQUIRE( motion.time() == Approx( 1.5 ) );
+    REQUIRE( inflections == 3 );
+    REQUIRE( loops == 3 );
+  }
+
+  SECTION( "Peeking follows the loop." )
+  {
+    motion.setLoop( LoopMode::Repeat );
+    motion.jumpTo( 2.5 );
+    REQUIRE( motion.peek( 1.0 ) == Approx( 0.5f ) );
+    REQUIRE( motion.time() == Approx( 2.5 ) );
+  }
+}
@@ -11,6 +11,94 @@
 using namespace choreograph;
 using namespace std;
 
+namespace
+{
+
+struct Vec3
+{
+  float x, y, z;
+};
+
+Vec3 operator+ ( const Vec3 &a, const Vec3 &b ) { return Vec3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+Vec3 operator- ( const Vec3 &a, const Vec3 &b ) { return Vec3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+Vec3 operator* ( const Vec3 &a, float s ) { return Vec3{ a.x * s, a.y * s, a.z * s }; }
+
+struct Vec4
+{
+  float x, y, z, w;
+};
+
+/// Angle in degrees that interpolates along the shortest arc.
+struct Angle
+{
+  float degrees;
+};
+
+/// Large value that counts how often it is copied.
+struct Pose
+{
+  Pose() = default;
+  Pose( float v ) { joints.fill( v ); }
+  Pose( const Pose &other ): joints( other.joints ) { copies += 1; }
+  Pose& operator= ( const Pose &other ) { joints = other.joints; copies += 1; return *this; }
+
+  std::array<float, 64> joints;
+  static int            copies;
+};
+
+int Pose::copies = 0;
+
+/// Level with arithmetic operators whose lerpT is specialized to step halfway.
+struct Level
+{
+  float value;
+};
+
+Level operator+ ( const Level &a, const Level &b ) { return Level{ a.value + b.value }; }
+Level operator- ( const Level &a, const Level &b ) { return Level{ a.value - b.value }; }
+Level operator* ( const Level &a, float t ) { return Level{ a.value * t }; }
+
+} // namespace
+
+namespace choreograph
+{
+
+template<>
+struct InterpolationTraits<Angle>
+{
+  static Angle lerp( const Angle &a, const Angle &b, float t )
+  {
+    const float delta = std::remainder( b.degrees - a.degrees, 360.0f );
+    return Angle{ a.degrees + delta * t };
+  }
+};
+
+template<>
+struct InterpolationTraits<Pose>
+{
+  static Pose lerp( const Pose &a, const Pose &b, float t )
+  {
+    Pose out;
+    lerpInto( a, b, t, out );
+    return out;
+  }
+
+  static void lerpInto( const Pose &a, const Pose &b, float t, Pose &out )
+  {
+    for( size_t i = 0; i < out.joints.size(); ++i ) {
+      out.joints[i] = a.joints[i] + (b.joints[i] - a.joints[i]) * t;
+    }
+  }
+};
+
+template<>
+Level lerpT( const Level &a, const Level &b, float t )
+{
+  return t < 0.5f ? a : b;
+}
+
+} // namespace choreograph
+
 TEST_CASE( "Phrases" )
 {
   auto ramp = makeRamp( 1.0f, 10.0f, 1.0f );
@@ -118,5 +206,205 @@ TEST_CASE( "Phrases" )
     REQUIRE( ramp_ab->getValue( 1.0f ).name == "hello" );
     REQUIRE( ramp_bc->getValue( 1.0f ).name == "target" );
     REQUIRE( mix_ramps->getValue( 0.5f ).y == ((550.0f * 0.5f) + (55.0f * 0.5f)) );
+
+    // Obj has no InterpolationTraits<Obj>::lerp to fall back on.
+    REQUIRE_THROWS_AS( ramp_ab->setLerpFn( nullptr ), std::invalid_argument& );
+  }
+}
+
+TEST_CASE( "Interpolation Traits" )
+{
+  SECTION( "Packed float vectors are detected and interpolated componentwise." )
+  {
+    static_assert( detail::PackedFloats<Vec3>::value == 3, "Vec3 is three packed floats." );
+    static_assert( detail::PackedFloats<Vec4>::value == 4, "Vec4 is four packed floats." );
+    static_assert( detail::PackedFloats<float>::value == 0, "Scalars aren't packed vectors." );
+    static_assert( InterpolationTraits<Vec4>::components == 4, "Vec4 has four components." );
+
+    auto v = InterpolationTraits<Vec3>::lerp( Vec3{ 0, 10, -2 }, Vec3{ 10, 20, 2 }, 0.25f );
+    REQUIRE( v.x == 2.5f );
+    REQUIRE( v.y == 12.5f );
+    REQUIRE( v.z == -1.0f );
+
+    // Vec4 has no arithmetic operators, so it can only be interpolated through the trait.
+    auto w = lerpT( Vec4{ 0, 0, 0, 0 }, Vec4{ 4, 8, 12, 16 }, 0.5f );
+    REQUIRE( w.w == 8.0f );
+    REQUIRE( InterpolationTraits<Vec4>::component( w, 1 ) == 4.0f );
+  }
+
+  SECTION( "Phrases use specialized traits without a lerp function." )
+  {
+    RampTo<Angle> ramp( 1.0f, Angle{ 350.0f }, Angle{ 10.0f } );
+    REQUIRE( ramp.getValue( 0.5f ).degrees == Approx( 360.0f ) );
+
+    Sequence<Angle> sequence( Angle{ 90.0f } );
+    sequence.then<RampTo>( Angle{ -90.0f + 1.0f }, 1.0f );
+    REQUIRE( sequence.getValue( 0.5f ).degrees == Approx( 0.5f ) );
+  }
+
+  SECTION( "Specializations of lerpT apply to every Phrase that interpolates." )
+  {
+    RampTo<Level> ramp( 1.0f, Level{ 0.0f }, Level{ 10.0f } );
+    REQUIRE( ramp.getValue( 0.25f ).value == 0.0f );
+    REQUIRE( ramp.getValue( 0.75f ).value == 10.0f );
+
+    Level out{ -1.0f };
+    ramp.getValueInto( 0.75f, out );
+    REQUIRE( out.value == 10.0f );
+
+    auto hold = make_shared<Hold<Level>>( 1.0f, Level{ 5.0f } );
+    auto mix = makeBlend<Level>( hold, make_shared<RampTo<Level>>( ramp ), 0.25f );
+    REQUIRE( mix->getValue( 1.0f ).value == 5.0f );
+
+    KeyframeTrack<Level> track( { 0.0, 1.0 }, { Level{ 0.0f }, Level{ 10.0f } } );
+    REQUIRE( track.getValue( 0.25 ).value == 0.0f );
+    REQUIRE( track.getValue( 0.75 ).value == 10.0f );
+  }
+
+  SECTION( "Explicit lerp functions take precedence over the trait." )
+  {
+    auto ramp = makeRamp( 0.0f, 10.0f, 1.0f, EaseNone(), [] ( const float &a, const float &b, float t ) { return t < 0.5f ? a : b; } );
+    REQUIRE( ramp->getValue( 0.25f ) == 0.0f );
+    ramp->setLerpFn( nullptr );
+    REQUIRE( ramp->getValue( 0.25f ) == 2.5f );
+  }
+
+  SECTION( "RampToN interpolates components separately through the trait." )
+  {
+    RampToN<3, Vec3> ramp( 1.0f, Vec3{ 0, 0, 0 }, Vec3{ 1, 1, 1 }, EaseNone(), EaseInQuad(), EaseOutQuad() );
+    auto v = ramp.getValue( 0.5f );
+    REQUIRE( v.x == 0.5f );
+    REQUIRE( v.y == 0.25f );
+    REQUIRE( v.z == 0.75f );
+  }
+}
+
+TEST_CASE( "In-place Evaluation" )
+{
+  SECTION( "Containers interpolate element-wise, reusing the output's storage." )
+  {
+    RampTo<vector<float>> ramp( 1.0f, { 0.0f, 10.0f, 20.0f }, { 10.0f, 20.0f, 0.0f } );
+    REQUIRE( ramp.getValue( 0.5f ) == (vector<float>{ 5.0f, 15.0f, 10.0f }) );
+
+    vector<float> out( 3 );
+    const float *storage = out.data();
+    ramp.getValueInto( 0.25f, out );
+    REQUIRE( out == (vector<float>{ 2.5f, 12.5f, 15.0f }) );
+    REQUIRE( out.data() == storage );
+
+    RampTo<array<float, 2>> pair( 1.0f, {{ 0.0f, 1.0f }}, {{ 1.0f, 0.0f }} );
+    array<float, 2> a;
+    pair.getValueInto( 0.5f, a );
+    REQUIRE( a[0] == 0.5f );
+    REQUIRE( a[1] == 0.5f );
+  }
+
+  SECTION( "getValueInto matches getValue through Sequences and retiming Phrases." )
+  {
+    auto sequence = Sequence<Vec3>( Vec3{ 0, 0, 0 } )
+      .then<RampTo>( Vec3{ 1, 2, 3 }, 1.0f )
+      .then<Hold>( Vec3{ 4, 4, 4 }, 1.0f )
+      .then( makeRepeat<Vec3>( makeRamp( Vec3{ 0, 0, 0 }, Vec3{ 8, 8, 8 }, 1.0f ), 2.0f ) );
+
+    for( Time t = -0.5; t < 5.0; t += 0.125 ) {
+      Vec3 out{ -1, -1, -1 };
+      sequence.getValueInto( t, out );
+      const auto expected = sequence.getValue( t );
+      REQUIRE( out.x == expected.x );
+      REQUIRE( out.z == expected.z );
+    }
+  }
+
+  SECTION( "Motions write large values straight into their Output." )
+  {
+    Output<Pose> output( Pose( 0.0f ) );
+    auto sequence = Sequence<Pose>( Pose( 0.0f ) ).then<RampTo>( Pose( 4.0f ), 1.0f );
+    Motion<Pose> motion( &output, sequence );
+
+    Pose::copies = 0;
+    for( int i = 0; i < 3; ++i ) {
+      motion.step( 0.25 );
+    }
+    REQUIRE( Pose::copies == 0 );
+    REQUIRE( output().joints[10] == 3.0f );
+  }
+}
+
+TEST_CASE( "Cached Phrases" )
+{
+  int evaluations = 0;
+  auto source = makeProcedure<float>( 2.0, [&evaluations] ( Time t, Time duration ) {
+    evaluations += 1;
+    return (float)(t * duration * 10.0);
+  } );
+
+  SECTION( "Cached values match the source and are baked one block at a time." )
+  {
+    CachedPhrase<float> cached( source, 10.0, 0, 4 );
+    REQUIRE( cached.getDuration() == 2.0 );
+    REQUIRE( evaluations == 0 );
+
+    REQUIRE( cached.getValue( 0.25 ) == Approx( 2.5f ) );
+    REQUIRE( evaluations == 5 );
+    REQUIRE( cached.getStats().blocks_baked == 1 );
+
+    REQUIRE( cached.getValue( 0.05 ) == Approx( 0.5f ) );
+    REQUIRE( cached.getValue( 2.0 ) == Approx( 20.0f ) );
+    REQUIRE( cached.getValue( 3.0 ) == Approx( 20.0f ) );
+    REQUIRE( cached.getStats().lookups == 4 );
+    REQUIRE( cached.getStats().hits == 2 );
+    REQUIRE( cached.getStats().hitRate() == Approx( 0.5 ) );
+    REQUIRE( cached.getStats().bytes == 2 * 5 * sizeof( float ) );
+  }
+
+  SECTION( "Looping over a cached phrase samples the source once." )
+  {
+    auto looped = makeRepeat<float>( makeCached<float>( source, 10.0 ), 100 );
+    for( Time t = 0; t < looped->getDuration(); t += 0.01 ) {
+      looped->getValue( t );
+    }
+    REQUIRE( evaluations == 21 );
+  }
+
+  SECTION( "The memory cap evicts the least recently used blocks." )
+  {
+    CachedPhrase<float> cached( source, 10.0, 10 * sizeof( float ), 4 );
+    cached.getValue( 0.1 );
+    cached.getValue( 0.5 );
+    cached.getValue( 0.1 );
+    cached.getValue( 0.9 );
+    REQUIRE( cached.getStats().evictions == 1 );
+    REQUIRE( cached.getStats().bytes <= cached.getMaxBytes() );
+
+    // The block for 0.5 was dropped, the block for 0.1 was kept.
+    evaluations = 0;
+    cached.getValue( 0.1 );
+    REQUIRE( evaluations == 0 );
+    cached.getValue( 0.5 );
+    REQUIRE( evaluations == 5 );
+  }
+
+  SECTION( "Invalidation rebakes from the current source." )
+  {
+    float scale = 1.0f;
+    auto scaled = makeProcedure<float>( 1.0, [&scale] ( Time t, Time ) { return (float)t * scale; } );
+    CachedPhrase<float> cached( scaled, 8.0, 0, 2 );
+    cached.precache();
+    REQUIRE( cached.getStats().bytes == 4 * 3 * sizeof( float ) );
+    // Precaching again bakes nothing and isn't a lookup, so it doesn't count as a hit.
+    cached.precache();
+    REQUIRE( cached.getStats().hits == 0 );
+    cached.getValue( 0.1 );
+    REQUIRE( cached.getStats().hitRate() == 1.0 );
+
+    scale = 2.0f;
+    REQUIRE( cached.getValue( 0.75 ) == Approx( 0.75f ) );
+    cached.invalidate( 0.7, 0.8 );
+    REQUIRE( cached.getValue( 0.75 ) == Approx( 1.5f ) );
+    REQUIRE( cached.getValue( 0.25 ) == Approx( 0.25f ) );
+
+    cached.invalidate();
+    REQUIRE( cached.getStats().bytes == 0 );
+    REQUIRE( cached.getValue( 0.25 ) == Approx( 0.5f ) );
   }
 }
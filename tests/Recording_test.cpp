@@ -0,0 +1,134 @@
+//
+//  Recording_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+#include <cstdio>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+/// Runs a small animation, recording it to \a path.
+void recordSession( const string &path, float target )
+{
+  Timeline      timeline;
+  Output<float> x = 0.0f;
+  Output<float> y = 5.0f;
+  Output<int>   held = 0;
+
+  Recorder recorder( path );
+  recorder.addChannel( "x", &x );
+  recorder.addChannel( "y", &y );
+  recorder.addChannel( "held", &held );
+
+  timeline.apply( &x ).then<RampTo>( target, 1.0f, EaseInOutQuad() );
+  timeline.apply( &y ).hold( 0.5f ).then<RampTo>( 10.0f, 0.5f );
+  timeline.cue( recorder.wrapCue( "halfway", [&held] { held = 1; } ), 0.5f );
+
+  for( int i = 0; i <= 60; ++i ) {
+    timeline.step( 1.0 / 60.0 );
+    recorder.capture( timeline.time() );
+  }
+}
+
+} // namespace
+
+TEST_CASE( "Recording and Replay" )
+{
+  const string path_a = "choreograph_recording_a.chrc";
+  const string path_b = "choreograph_recording_b.chrc";
+  recordSession( path_a, 100.0f );
+
+  auto recording = Recording::load( path_a );
+
+  SECTION( "Frames only store the channels that changed." )
+  {
+    REQUIRE( recording.getChannels().size() == 4 );
+    REQUIRE( recording.getFrames().size() == 61 );
+    // y holds for half a second, so most early frames only contain x.
+    auto &second = recording.getFrames()[1];
+    REQUIRE( (second.end - second.begin) == 1 );
+  }
+
+  SECTION( "Players drive Outputs bit-exactly and fire recorded events." )
+  {
+    Output<float> x = 0.0f;
+    Output<float> y = 0.0f;
+    int           events = 0;
+
+    RecordingPlayer player( recording );
+    REQUIRE( player.bind( "x", &x ) );
+    REQUIRE( player.bind( "y", &y ) );
+    REQUIRE( player.bindEvent( "halfway", [&events] { events += 1; } ) );
+    REQUIRE_FALSE( player.bind( "missing", &x ) );
+
+    Output<double> wrong_size;
+    REQUIRE_FALSE( player.bind( "x", &wrong_size ) );
+
+    Timeline      timeline;
+    Output<float> expected_x = 0.0f;
+    timeline.apply( &expected_x ).then<RampTo>( 100.0f, 1.0f, EaseInOutQuad() );
+    for( int i = 0; i <= 60; ++i ) {
+      timeline.step( 1.0 / 60.0 );
+      player.jumpTo( timeline.time() );
+      REQUIRE( x() == expected_x() );
+    }
+    REQUIRE( y() == 10.0f );
+    REQUIRE( events == 1 );
+
+    // Scrubbing backward restores earlier values without firing events.
+    player.jumpTo( 0.25 );
+    REQUIRE( y() == 5.0f );
+    REQUIRE( events == 1 );
+    // Crossing the event again going forward fires it again.
+    player.jumpTo( 1.0 );
+    REQUIRE( events == 2 );
+  }
+
+  SECTION( "Scrubbing backward matches playing forward to the same time." )
+  {
+    Output<float> x = 0.0f;
+    Output<float> y = 0.0f;
+    RecordingPlayer player( recording );
+    player.bind( "x", &x );
+    player.bind( "y", &y );
+    player.jumpTo( 1.0 );
+
+    const auto &frames = recording.getFrames();
+    for( size_t i = frames.size(); i-- > 0; )
+    {
+      Output<float> expected_x = 0.0f;
+      Output<float> expected_y = 0.0f;
+      RecordingPlayer reference( recording );
+      reference.bind( "x", &expected_x );
+      reference.bind( "y", &expected_y );
+      reference.jumpTo( frames[i].time );
+
+      player.jumpTo( frames[i].time );
+      REQUIRE( x() == expected_x() );
+      REQUIRE( y() == expected_y() );
+    }
+  }
+
+  SECTION( "Comparing recordings finds the first difference." )
+  {
+    recordSession( path_b, 100.0f );
+    auto same = compareRecordings( recording, Recording::load( path_b ) );
+    REQUIRE( same.identical );
+    REQUIRE( same.frames_compared == 61 );
+
+    recordSession( path_b, 50.0f );
+    auto different = compareRecordings( recording, Recording::load( path_b ) );
+    REQUIRE_FALSE( different.identical );
+    REQUIRE( different.mismatched_frames > 0 );
+    REQUIRE( different.first_difference.find( "\"x\"" ) != string::npos );
+  }
+
+  remove( path_a.c_str() );
+  remove( path_b.c_str() );
+}
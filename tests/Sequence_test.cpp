@@ -270,3 +270,92 @@ TEST_CASE( "Slicing Time" )
     }
   }
 }
+
+TEST_CASE( "Sequence Simplification" )
+{
+  SECTION( "Collinear ramps merge into a single ramp." )
+  {
+    Sequence<float> sequence( 0.0f );
+    for( int i = 1; i <= 100; ++i ) {
+      sequence.then<RampTo>( i * 2.0f, 1.0f );
+    }
+
+    auto result = simplify( sequence, 0.001 );
+    REQUIRE( result.original_phrases == 100 );
+    REQUIRE( result.simplified_phrases == 1 );
+    REQUIRE( result.max_error < 1.0e-4 );
+    REQUIRE( result.sequence.getDuration() == sequence.getDuration() );
+    REQUIRE( result.sequence.getValue( 50.0 ) == Approx( 100.0f ) );
+  }
+
+  SECTION( "Densely sampled curves shrink and stay within tolerance." )
+  {
+    Sequence<float> sequence( 0.0f );
+    for( int i = 1; i <= 1000; ++i ) {
+      sequence.then<RampTo>( std::sin( i * 0.01f ) * 10.0f, 0.01f );
+    }
+
+    const double tolerance = 0.01;
+    auto result = simplify( sequence, tolerance );
+    REQUIRE( result.simplified_phrases < result.original_phrases / 5 );
+    REQUIRE( result.max_error <= tolerance );
+    for( int i = 0; i <= 1000; ++i ) {
+      REQUIRE( std::abs( result.sequence.getValue( i * 0.01 ) - sequence.getValue( i * 0.01 ) ) <= tolerance + 1.0e-5 );
+    }
+  }
+
+  SECTION( "Eased ramps stay within tolerance and never grow the sequence." )
+  {
+    Sequence<float> sequence( 0.0f );
+    for( int i = 0; i < 20; ++i ) {
+      sequence.then<RampTo>( std::cos( i * 0.5f ) * 10.0f, 0.5f, EaseInOutQuad() );
+    }
+
+    const double tolerance = 0.05;
+    const size_t samples = 16;
+    auto result = simplify( sequence, tolerance, samples );
+    REQUIRE( result.simplified_phrases <= result.original_phrases );
+    REQUIRE( result.max_error <= tolerance );
+    for( size_t i = 0; i <= 20 * samples; ++i ) {
+      const Time t = i * 0.5 / samples;
+      REQUIRE( std::abs( result.sequence.getValue( t ) - sequence.getValue( t ) ) <= tolerance + 1.0e-5 );
+    }
+  }
+
+  SECTION( "Curves between samples count toward the error." )
+  {
+    // With one sample per phrase, both phrases only show their ends, which are collinear.
+    Sequence<float> sequence( 0.0f );
+    sequence.then<RampTo>( 1.0f, 1.0f, EaseInQuad() ).then<RampTo>( 2.0f, 1.0f );
+
+    const double tolerance = 0.01;
+    auto result = simplify( sequence, tolerance, 1 );
+    REQUIRE( result.simplified_phrases == 2 );
+    REQUIRE( result.max_error <= tolerance );
+
+    // Lines replacing eased phrases are bounded everywhere, not just at the samples.
+    Sequence<float> eased( 0.0f );
+    for( int i = 1; i <= 8; ++i ) {
+      eased.then<RampTo>( i * 1.0f, 1.0f, EaseInOutSine() );
+    }
+    auto loose = simplify( eased, 0.25, 1 );
+    REQUIRE( loose.simplified_phrases < loose.original_phrases );
+    double error = 0;
+    for( int i = 0; i <= 8 * 64; ++i ) {
+      error = std::max<double>( error, std::abs( loose.sequence.getValue( i / 64.0 ) - eased.getValue( i / 64.0 ) ) );
+    }
+    REQUIRE( error <= loose.max_error + 1.0e-5 );
+    REQUIRE( loose.max_error <= 0.25 );
+  }
+
+  SECTION( "Discontinuities are preserved." )
+  {
+    Sequence<float> sequence( 0.0f );
+    sequence.then<RampTo>( 1.0f, 1.0f ).set( 5.0f ).then<RampTo>( 6.0f, 1.0f );
+
+    auto result = simplify( sequence, 0.01 );
+    REQUIRE( result.sequence.getValue( 0.5 ) == Approx( 0.5f ) );
+    REQUIRE( result.sequence.getValue( 1.5 ) == Approx( 5.5f ) );
+    REQUIRE( result.sequence.getEndValue() == 6.0f );
+  }
+}
@@ -0,0 +1,140 @@
+//
+//  SharedMemory_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+#include <stdexcept>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+struct Pose
+{
+  float x, y, z;
+};
+
+string uniqueName( const string &base )
+{
+  return "/choreograph_test_" + base + "_" + to_string( getpid() );
+}
+
+} // namespace
+
+TEST_CASE( "Shared Memory Frames" )
+{
+  const auto name = uniqueName( "frames" );
+
+  ch::Timeline  timeline;
+  Output<float> scalar( 0.0f );
+  Output<Pose>  pose( Pose{ 0, 0, 0 } );
+  timeline.apply( &scalar ).then<RampTo>( 10.0f, 1.0f );
+
+  SharedFramePublisher publisher( name );
+  REQUIRE( publisher.addOutput( "scalar", &scalar ) == 0 );
+  REQUIRE( publisher.addOutput( "pose", &pose ) == 1 );
+
+  SECTION( "Subscribers read the published clock and values." )
+  {
+    SharedFrameSubscriber subscriber( name );
+    REQUIRE( ! subscriber.read() );
+
+    timeline.step( 0.5 );
+    pose = Pose{ 1, 2, 3 };
+    publisher.publish( timeline );
+
+    REQUIRE( subscriber.read() );
+    REQUIRE( subscriber.getFrame() == 1 );
+    REQUIRE( subscriber.getTime() == 0.5 );
+    REQUIRE( subscriber.getChannelCount() == 2 );
+    REQUIRE( subscriber.findChannel( "pose" ) == 1 );
+    REQUIRE( subscriber.findChannel( "missing" ) == -1 );
+    REQUIRE( subscriber.getValue<float>( 0 ) == 5.0f );
+    REQUIRE( subscriber.getValue<Pose>( 1 ).z == 3.0f );
+    // Types that don't match the published size are rejected rather than read past the channel.
+    REQUIRE_THROWS_AS( subscriber.getValue<Pose>( 0 ), std::runtime_error& );
+    REQUIRE_THROWS_AS( subscriber.getValue<float>( 1 ), std::runtime_error& );
+
+    // Nothing new until the next publish.
+    REQUIRE( ! subscriber.read() );
+    REQUIRE( subscriber.getReadLatency().count == 1 );
+    REQUIRE( subscriber.getFrameAge().last >= 0 );
+    REQUIRE( publisher.getPublishLatency().count == 1 );
+  }
+
+  SECTION( "Channel changes reach subscribers." )
+  {
+    SharedFrameSubscriber subscriber( name );
+    publisher.clear();
+    Output<float> other( 7.0f );
+    publisher.addOutput( "other", &other );
+    publisher.publish( 1.0 );
+
+    REQUIRE( subscriber.read() );
+    REQUIRE( subscriber.getChannelCount() == 1 );
+    REQUIRE( subscriber.getChannelName( 0 ) == "other" );
+    REQUIRE( subscriber.getValue<float>( 0 ) == 7.0f );
+  }
+
+  SECTION( "Missing segments and full segments throw." )
+  {
+    REQUIRE_THROWS_AS( SharedFrameSubscriber( uniqueName( "missing" ) ), std::runtime_error& );
+
+    SharedFramePublisher small( uniqueName( "small" ), 1, 4 );
+    small.addOutput( "scalar", &scalar );
+    REQUIRE_THROWS_AS( small.addOutput( "pose", &pose ), std::runtime_error& );
+  }
+
+  SECTION( "Another process reads consistent frames while we publish." )
+  {
+    const int frames = 20000;
+    const pid_t child = fork();
+    REQUIRE( child >= 0 );
+
+    if( child == 0 )
+    {
+      // Every published Pose holds its frame number in all components; a torn read would mix frames.
+      int status = 0;
+      try {
+        SharedFrameSubscriber subscriber( name );
+        while( subscriber.getFrame() < (uint64_t)frames ) {
+          if( subscriber.read() ) {
+            const auto p = subscriber.getValue<Pose>( 1 );
+            const float expected = (float)subscriber.getFrame();
+            if( p.x != expected || p.y != expected || p.z != expected || subscriber.getTime() != expected ) {
+              status = 1;
+              break;
+            }
+          }
+        }
+      }
+      catch( ... ) {
+        status = 2;
+      }
+      _exit( status );
+    }
+
+    for( int f = 1; f <= frames; ++f ) {
+      const float v = (float)f;
+      pose = Pose{ v, v, v };
+      publisher.publish( f );
+    }
+
+    int status = -1;
+    waitpid( child, &status, 0 );
+    REQUIRE( WIFEXITED( status ) );
+    REQUIRE( WEXITSTATUS( status ) == 0 );
+    REQUIRE( publisher.getFrameCount() == frames );
+  }
+}
+
+#endif
@@ -0,0 +1,179 @@
+//
+//  Show_test.cpp
+//
+
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+/// Builds the same small show onto a timeline for the given targets.
+void author( Timeline &timeline, Output<float> *a, Output<float> *b, Output<double> *c, vector<int> *log )
+{
+  timeline.setDefaultRemoveOnFinish( false );
+  timeline.apply( a ).rampTo( 10.0f, 1.0f ).rampTo( 0.0f, 1.0f );
+  timeline.apply( b ).rampTo( 4.0f, 2.0f ).setStartTime( 1.0 );
+  timeline.apply( c ).rampTo( 1.0, 1.0 ).playbackSpeed( 2.0 );
+  timeline.cue( [log] { log->push_back( 2 ); }, 2.0 );
+  timeline.cue( [log] { log->push_back( 1 ); }, 0.5 );
+}
+
+} // namespace
+
+TEST_CASE( "Compiled Shows" )
+{
+  Output<float>   a = 0.0f, b = 0.0f;
+  Output<double>  c = 0.0;
+  vector<int>     log;
+
+  Timeline timeline;
+  author( timeline, &a, &b, &c, &log );
+  auto show = compileShow<float, double>( timeline, 120.0 );
+  timeline.clear();
+
+  SECTION( "Compiling bakes tracks and a sorted event table." )
+  {
+    REQUIRE( show->getTrackCount() == 3 );
+    REQUIRE( show->getEvents().size() == 2 );
+    REQUIRE( show->getEvents().front().time == Approx( 0.5 ) );
+    REQUIRE( show->getDuration() == Approx( 3.0 ) );
+  }
+
+  SECTION( "Shows play back like the timeline they were compiled from." )
+  {
+    Output<float>   ra = 0.0f, rb = 0.0f;
+    Output<double>  rc = 0.0;
+    vector<int>     reference_log;
+    Timeline reference;
+    author( reference, &ra, &rb, &rc, &reference_log );
+
+    for( int i = 0; i < 200; ++i )
+    {
+      show->step( 1.0 / 60.0 );
+      reference.step( 1.0 / 60.0 );
+      REQUIRE( a() == Approx( ra() ).epsilon( 1.0e-4 ) );
+      REQUIRE( b() == Approx( rb() ).epsilon( 1.0e-4 ) );
+      REQUIRE( c() == Approx( rc() ).epsilon( 1.0e-4 ) );
+    }
+    REQUIRE( log == reference_log );
+    REQUIRE( (log == vector<int>{ 1, 2 }) );
+  }
+
+  SECTION( "Only tracks within their time span are active." )
+  {
+    show->jumpTo( 0.25 );
+    REQUIRE( show->getActiveTrackCount() == 2 );
+    show->jumpTo( 1.5 );
+    REQUIRE( show->getActiveTrackCount() == 2 );
+    show->jumpTo( 3.5 );
+    REQUIRE( show->getActiveTrackCount() == 0 );
+    REQUIRE( a() == 0.0f );
+    REQUIRE( b() == 4.0f );
+    REQUIRE( c() == 1.0 );
+  }
+
+  SECTION( "Playing in reverse matches seeking." )
+  {
+    Output<float>   ra = 0.0f, rb = 0.0f;
+    Output<double>  rc = 0.0;
+    vector<int>     reference_log;
+    Timeline reference_timeline;
+    author( reference_timeline, &ra, &rb, &rc, &reference_log );
+    auto reference = compileShow<float, double>( reference_timeline, 120.0 );
+    reference_timeline.clear();
+
+    show->jumpTo( 3.5 );
+    for( int i = 0; i < 240; ++i )
+    {
+      show->step( -1.0 / 60.0 );
+      reference->setTime( show->time() );
+      REQUIRE( show->getActiveTrackCount() == reference->getActiveTrackCount() );
+      REQUIRE( a() == Approx( ra() ) );
+      REQUIRE( b() == Approx( rb() ) );
+      REQUIRE( c() == Approx( rc() ) );
+    }
+    // Back and forth across a track's end.
+    show->jumpTo( 1.2 );
+    show->jumpTo( 0.4 );
+    reference->setTime( 0.4 );
+    REQUIRE( show->getActiveTrackCount() == 2 );
+    REQUIRE( a() == Approx( ra() ) );
+    REQUIRE( c() == Approx( rc() ) );
+  }
+
+  SECTION( "Seeking repositions without firing events." )
+  {
+    show->setTime( 1.5 );
+    REQUIRE( a() == Approx( 5.0f ) );
+    REQUIRE( b() == Approx( 1.0f ) );
+    REQUIRE( log.empty() );
+
+    show->step( 1.0 );
+    REQUIRE( (log == vector<int>{ 2 }) );
+
+    show->setTime( 0.0 );
+    REQUIRE( a() == 0.0f );
+    REQUIRE( b() == 0.0f );
+    show->step( 0.75 );
+    REQUIRE( a() == Approx( 7.5f ) );
+    REQUIRE( (log == vector<int>{ 2, 1 }) );
+  }
+
+  SECTION( "Jumping backward fires crossed events in reverse." )
+  {
+    show->jumpTo( 2.5 );
+    log.clear();
+    show->jumpTo( 0.0 );
+    REQUIRE( (log == vector<int>{ 2, 1 }) );
+    REQUIRE( a() == 0.0f );
+  }
+
+  SECTION( "Targets can be rebound." )
+  {
+    Output<float> other = 0.0f;
+    REQUIRE( show->rebind( &a, &other ) == 1 );
+    show->jumpTo( 0.5 );
+    REQUIRE( other() == Approx( 5.0f ) );
+    REQUIRE( a() == 0.0f );
+  }
+
+  SECTION( "Cue tracks compile into the event table." )
+  {
+    Timeline cues;
+    vector<uint32_t> ids;
+    auto track = detail::make_unique<CueTrack>( [&ids] ( uint32_t id ) { ids.push_back( id ); } );
+    track->add( 1.0, 7u );
+    track->add( 0.5, [&log] { log.push_back( 3 ); } );
+    cues.add( std::move( track ) ).setStartTime( 1.0 );
+
+    auto compiled = compileShow<float>( cues );
+    REQUIRE( compiled->getEvents().size() == 2 );
+    REQUIRE( compiled->getDuration() == Approx( 2.0 ) );
+
+    log.clear();
+    compiled->step( 1.75 );
+    REQUIRE( (log == vector<int>{ 3 }) );
+    REQUIRE( ids.empty() );
+    compiled->step( 0.5 );
+    REQUIRE( (ids == vector<uint32_t>{ 7 }) );
+  }
+
+  SECTION( "Asynchronous cues can't be compiled." )
+  {
+    Timeline cues;
+    cues.cue( [] {}, 0.5 ).async( [] ( const function<void ()> &task ) { task(); } );
+    REQUIRE_THROWS_AS( compileShow<float>( cues ), std::invalid_argument& );
+  }
+
+  SECTION( "Unlisted types can't be compiled." )
+  {
+    Timeline mixed;
+    Output<float> f = 0.0f;
+    mixed.apply( &f ).rampTo( 1.0f, 1.0f );
+    REQUIRE_THROWS_AS( compileShow<double>( mixed ), std::invalid_argument& );
+  }
+}
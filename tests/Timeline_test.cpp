@@ -247,3 +247,254 @@ TEST_CASE( "Callbacks" )
     REQUIRE_FALSE( self_destructing_timeline );
   }
 }
+
+namespace
+{
+
+struct BatchVec3
+{
+  float x, y, z;
+};
+
+} // namespace
+
+TEST_CASE( "Batch Evaluation" )
+{
+  SECTION( "Ease functions and functors are recognized." )
+  {
+    REQUIRE( easeKindOf( &easeNone ) == EaseKind::None );
+    REQUIRE( easeKindOf( EaseInOutQuad() ) == EaseKind::InOutQuad );
+    REQUIRE( easeKindOf( &easeOutSine ) == EaseKind::OutSine );
+    REQUIRE( easeKindOf( EaseOutBack() ) == EaseKind::Custom );
+    REQUIRE( easeKindOf( [] (float t) { return t; } ) == EaseKind::Custom );
+  }
+
+  SECTION( "Only plain float vectors are batched." )
+  {
+    static_assert( detail::BatchFloats<float>::value == 1, "Floats are batched." );
+    static_assert( detail::BatchFloats<BatchVec3>::value == 3, "Packed float vectors are batched." );
+    static_assert( detail::BatchFloats<double>::value == 0, "Doubles are not batched." );
+    static_assert( detail::BatchFloats<vector<float>>::value == 0, "Containers are not batched." );
+  }
+
+  SECTION( "Batched Timelines produce the same values as unbatched ones." )
+  {
+    const int count = 40;
+    ch::Timeline plain, batched;
+    batched.setBatchEvaluation( true );
+    vector<Output<float>> plain_floats( count ), batched_floats( count );
+    vector<Output<BatchVec3>> plain_vecs( count ), batched_vecs( count );
+
+    const vector<EaseFn> eases = { EaseNone(), EaseInQuad(), &easeInOutCubic, EaseOutSine(), EaseInOutBack() };
+    auto build = [&] ( ch::Timeline &timeline, vector<Output<float>> &floats, vector<Output<BatchVec3>> &vecs ) {
+      for( int i = 0; i < count; ++i )
+      {
+        const auto &ease = eases[i % eases.size()];
+        floats[i] = 0.0f;
+        // Some Motions have callbacks, which keeps them out of the batch.
+        timeline.apply( &floats[i] )
+          .then<RampTo>( (float)i, 1.0f + i * 0.01f, ease )
+          .then<Hold>( 2.0f * i, 0.5f )
+          .updateFn( i % 7 == 0 ? Motion<float>::Callback( [] {} ) : Motion<float>::Callback() );
+
+        vecs[i] = BatchVec3{ 0, 0, 0 };
+        timeline.apply( &vecs[i] )
+          .then<RampTo>( BatchVec3{ (float)i, 1.0f, -1.0f }, 0.75f, ease )
+          .then( make_shared<ProceduralPhrase<BatchVec3>>( 1.0f, [] (Time t, Time /*duration*/) { return BatchVec3{ (float)t, 0, 0 }; } ) );
+      }
+    };
+    build( plain, plain_floats, plain_vecs );
+    build( batched, batched_floats, batched_vecs );
+
+    for( int frame = 0; frame < 150; ++frame )
+    {
+      plain.step( 1.0 / 60 );
+      batched.step( 1.0 / 60 );
+      for( int i = 0; i < count; ++i ) {
+        REQUIRE( batched_floats[i]() == plain_floats[i]() );
+        REQUIRE( batched_vecs[i]().x == plain_vecs[i]().x );
+        REQUIRE( batched_vecs[i]().z == plain_vecs[i]().z );
+      }
+    }
+  }
+
+  SECTION( "Batch statistics count batched and individually updated items." )
+  {
+    ch::Timeline timeline;
+    timeline.setBatchEvaluation( true );
+    Output<float> a( 0.0f ), b( 0.0f ), c( 0.0f ), d( 0.0f );
+    timeline.apply( &a ).then<RampTo>( 1.0f, 1.0f );
+    timeline.apply( &b ).then<RampTo>( 1.0f, 1.0f, EaseInQuad() );
+    timeline.apply( &c ).then<RampTo>( 1.0f, 1.0f, EaseOutBack() );
+    timeline.apply( &d ).then<RampTo>( 1.0f, 1.0f ).finishFn( [] {} );
+
+    timeline.step( 0.5 );
+    auto stats = timeline.getBatchStats();
+    REQUIRE( stats.batched == 2 );
+    REQUIRE( stats.fallback == 2 );
+    REQUIRE( stats.buckets == 2 );
+    REQUIRE( a() == 0.5f );
+    REQUIRE( b() == 0.25f );
+
+    timeline.setBatchEvaluation( false );
+    REQUIRE( timeline.getBatchStats().batched == 0 );
+  }
+
+  SECTION( "Motions leave the batch when they gain callbacks, change, or go away." )
+  {
+    ch::Timeline timeline;
+    timeline.setBatchEvaluation( true );
+    Output<float> a( 0.0f ), b( 0.0f );
+    auto &motion = timeline.apply( &a ).then<RampTo>( 4.0f, 4.0f ).getMotion();
+    timeline.apply( &b ).then<RampTo>( 4.0f, 4.0f );
+
+    timeline.step( 1.0 );
+    REQUIRE( timeline.getBatchStats().batched == 2 );
+
+    int updates = 0;
+    motion.setUpdateFn( [&updates] { updates += 1; } );
+    timeline.step( 1.0 );
+    REQUIRE( updates == 1 );
+    REQUIRE( timeline.getBatchStats().batched == 1 );
+    REQUIRE( a() == 2.0f );
+
+    // Editing a ramp in place is seen by the batch.
+    auto ramp = dynamic_pointer_cast<RampTo<float>>( b.inputPtr()->getSequence().getPhraseAtIndex( 0 ) );
+    ramp->setEndValue( 8.0f );
+    timeline.step( 1.0 );
+    REQUIRE( b() == 6.0f );
+
+    b.disconnect();
+    timeline.step( 0.5 );
+    REQUIRE( timeline.getBatchStats().batched == 0 );
+    REQUIRE( b() == 6.0f );
+  }
+}
+
+TEST_CASE( "Presentation" )
+{
+  ch::Timeline timeline;
+  Output<float> a( 0.0f ), b( 0.0f ), still( 5.0f );
+  int updates = 0;
+  timeline.apply( &a ).then<RampTo>( 10.0f, 1.0f ).updateFn( [&updates] { updates += 1; } );
+  auto &motion = timeline.apply( &b ).then<RampTo>( 10.0f, 2.0f ).getMotion();
+  timeline.step( 0.25 );
+  updates = 0;
+
+  SECTION( "Peeking predicts values without changing time, Outputs or callbacks." )
+  {
+    REQUIRE( motion.peek( 0.5 ) == Approx( 3.75f ) );
+    REQUIRE( motion.time() == 0.25 );
+    REQUIRE( b() == Approx( 1.25f ) );
+
+    PresentationBuffer buffer;
+    timeline.present( 0.5, buffer );
+    REQUIRE( buffer.get( a ) == Approx( 7.5f ) );
+    REQUIRE( buffer.get( b ) == Approx( 3.75f ) );
+    REQUIRE( buffer.get( still ) == 5.0f );
+    REQUIRE( a() == Approx( 2.5f ) );
+    REQUIRE( updates == 0 );
+    REQUIRE( timeline.time() == 0.25 );
+
+    // The prediction matches stepping.
+    timeline.step( 0.5 );
+    REQUIRE( a() == buffer.get( a ) );
+    REQUIRE( b() == buffer.get( b ) );
+  }
+
+  SECTION( "Each present replaces the last, reusing storage." )
+  {
+    PresentationBuffer buffer;
+    timeline.present( 0.25, buffer );
+    const float *storage = buffer.find( &b );
+    REQUIRE( storage != nullptr );
+
+    b.disconnect();
+    timeline.step( 0.0 );
+    timeline.present( 0.25, buffer );
+    REQUIRE( buffer.find( &b ) == nullptr );
+    REQUIRE( buffer.get( b ) == b() );
+
+    timeline.apply( &b ).then<RampTo>( 1.0f, 1.0f );
+    timeline.present( 0.5, buffer );
+    REQUIRE( buffer.find( &b ) == storage );
+    REQUIRE( buffer.size() == 2 );
+  }
+
+  SECTION( "Nested Timelines and playback speed are taken into account." )
+  {
+    auto nested = detail::make_unique<ch::Timeline>();
+    Output<float> c( 0.0f );
+    nested->apply( &c ).then<RampTo>( 4.0f, 4.0f );
+    timeline.add( std::move( nested ) ).playbackSpeed( 2.0 );
+
+    PresentationBuffer buffer;
+    timeline.present( 0.5, buffer );
+    REQUIRE( buffer.get( c ) == Approx( 1.0f ) );
+    timeline.step( 0.5 );
+    REQUIRE( c() == Approx( 1.0f ) );
+  }
+}
+
+TEST_CASE( "Fixed Timestep" )
+{
+  ch::Timeline timeline;
+  Output<float> target( 0.0f );
+  vector<float> ticks;
+  timeline.setFixedTimestep( 0.25, 4 );
+  timeline.apply( &target ).then<RampTo>( 8.0f, 2.0f ).updateFn( [&ticks, &target] { ticks.push_back( target() ); } );
+
+  SECTION( "Updates run whole substeps and present interpolated values." )
+  {
+    timeline.step( 0.625 );
+    REQUIRE( timeline.getFixedStepStats().substeps == 2 );
+    REQUIRE( timeline.getFixedStepStats().alpha == 0.5f );
+    REQUIRE( (ticks == vector<float>{ 1.0f, 2.0f }) );
+    REQUIRE( target() == 1.5f );
+
+    timeline.step( 0.0625 );
+    REQUIRE( timeline.getFixedStepStats().substeps == 0 );
+    REQUIRE( ticks.size() == 2 );
+    REQUIRE( target() == 1.75f );
+
+    timeline.step( 0.0625 );
+    REQUIRE( timeline.getFixedStepStats().substeps == 1 );
+    REQUIRE( target() == 2.0f );
+  }
+
+  SECTION( "Callbacks see the same states whatever the display rate." )
+  {
+    ch::Timeline fast;
+    Output<float> fast_target( 0.0f );
+    vector<float> fast_ticks;
+    fast.setFixedTimestep( 0.25, 4 );
+    fast.apply( &fast_target ).then<RampTo>( 8.0f, 2.0f ).updateFn( [&fast_ticks, &fast_target] { fast_ticks.push_back( fast_target() ); } );
+
+    for( int i = 0; i < 16; ++i ) {
+      timeline.step( 1.0 / 8 );
+    }
+    for( int i = 0; i < 40; ++i ) {
+      fast.step( 1.0 / 20 );
+    }
+    REQUIRE( ticks.size() == 8 );
+    REQUIRE( fast_ticks == ticks );
+  }
+
+  SECTION( "Substeps are capped, dropping or carrying the backlog." )
+  {
+    timeline.step( 1.5 );
+    auto stats = timeline.getFixedStepStats();
+    REQUIRE( stats.substeps == 4 );
+    REQUIRE( stats.capped_updates == 1 );
+    REQUIRE( stats.dropped_time == 0.5 );
+    REQUIRE( ticks.size() == 4 );
+
+    timeline.setFixedTimestep( 0.25, 2, FixedStepCatchUp::Carry );
+    timeline.step( 1.0 );
+    REQUIRE( timeline.getFixedStepStats().substeps == 2 );
+    timeline.step( 0.0 );
+    REQUIRE( timeline.getFixedStepStats().substeps == 2 );
+    REQUIRE( timeline.getFixedStepStats().dropped_time == 0 );
+    REQUIRE( ticks.size() == 8 );
+  }
+}